@@ -93,6 +93,7 @@ enum options_client
   OPT_REPORT_PROGRESS,
   OPT_SKIP_ANNOTATE_ROWS_EVENTS,
   OPT_SSL_CRL, OPT_SSL_CRLPATH,
+  OPT_COMPRESSION_LEVEL,
   OPT_MAX_CLIENT_OPTION /* should be always the last */
 };
 
@@ -157,6 +157,7 @@ static my_bool in_com_source, aborted= 0;
 static ulong opt_max_allowed_packet, opt_net_buffer_length;
 static uint verbose=0,opt_silent=0,opt_mysql_port=0, opt_local_infile=0;
 static uint my_end_arg;
+static uint opt_compression_level= 0;
 static char * opt_mysql_unix_port=0;
 static int connect_flag=CLIENT_INTERACTIVE;
 static my_bool opt_binary_mode= FALSE;
@@ -1504,6 +1505,11 @@ static struct my_option my_long_options[] =
   {"compress", 'C', "Use compression in server/client protocol.",
    &opt_compress, &opt_compress, 0, GET_BOOL, NO_ARG, 0, 0, 0,
    0, 0, 0},
+  {"compression-level", OPT_COMPRESSION_LEVEL,
+   "zlib level (1-9) used for compressing sent packets with --compress. "
+   "0 uses the zlib default.",
+   &opt_compression_level, &opt_compression_level, 0, GET_UINT,
+   REQUIRED_ARG, 0, 0, 9, 0, 0, 0},
 #ifdef DBUG_OFF
   {"debug", '#', "This is a non-debug version. Catch this and exit.",
    0,0, 0, GET_DISABLED, OPT_ARG, 0, 0, 0, 0, 0, 0},
@@ -4616,6 +4622,9 @@ sql_real_connect(char *host,char *database,char *user,char *password,
   }
   if (opt_compress)
     mysql_options(&mysql,MYSQL_OPT_COMPRESS,NullS);
+  if (opt_compression_level)
+    mysql_options(&mysql, MYSQL_OPT_COMPRESSION_LEVEL,
+                  (char*) &opt_compression_level);
   if (using_opt_local_infile)
     mysql_options(&mysql,MYSQL_OPT_LOCAL_INFILE, (char*) &opt_local_infile);
   if (safe_updates)
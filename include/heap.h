@@ -109,6 +109,13 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+typedef struct st_hp_columndef		/* VARCHAR of a packed table */
+{
+  uint offset;				/* Of the length in the record */
+  uint length;				/* Max length of the data */
+  uint length_bytes;			/* 1 or 2 */
+} HP_COLUMNDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME | HA_NULL_PART_KEY */
@@ -133,22 +140,29 @@ typedef struct st_hp_keydef		/* Key definition with open */
 typedef struct st_heap_share
 {
   HP_BLOCK block;
+  HP_BLOCK chunk_block;			/* Packed part of the records */
   HP_KEYDEF  *keydef;
+  HP_COLUMNDEF *columndef;		/* Sorted by offset */
   ulonglong data_length,index_length,max_table_size;
   ulonglong auto_increment;
   ulong min_records,max_records;	/* Params to open */
   ulong records;			/* records */
   ulong blength;			/* records rounded up to 2^n */
   ulong deleted;			/* Deleted records in database */
+  ulong chunks;				/* Chunks taken from chunk_block */
   uint key_stat_version;                /* version to indicate insert/delete */
   uint key_version;                     /* Updated on key change */
   uint file_version;                    /* Update on clear */
   uint reclength;			/* Length of one record */
+  uint fixed_length;			/* Stored as is, before the chunks */
+  uint visible;				/* Offset of the not deleted flag */
+  uint columns;				/* VARCHARs stored by their length */
   uint changed;
   uint keys,max_key_length;
   uint currently_disabled_keys;    /* saved value from "keys" when disabled */
   uint open_count;
   uchar *del_link;			/* Link to next block with del. rec */
+  uchar *chunk_del_link;		/* Link to next free chunk */
   char * name;			/* Name of "memory-file" */
   time_t create_time;
   THR_LOCK lock;
@@ -173,6 +187,7 @@ typedef struct st_heap_info
   uint opt_flag,update;
   uchar *lastkey;			/* Last used key with rkey */
   uchar *recbuf;                         /* Record buffer for rb-tree keys */
+  uchar *unpack_buf;                    /* Record of a packed table */
   enum ha_rkey_function last_find_flag;
   TREE_ELEMENT *parents[MAX_TREE_HEIGHT+1];
   TREE_ELEMENT **last_pos;
@@ -188,6 +203,12 @@ typedef struct st_heap_info
 typedef struct st_heap_create_info
 {
   HP_KEYDEF *keydef;
+  /*
+    If set, the VARCHARs are stored by their actual length, in chunks
+    after the fixed part of the record. Used for internal temporary tables.
+  */
+  HP_COLUMNDEF *columndef;
+  uint columns;
   uint auto_key;                        /* keynr [1 - maxkey] for auto key */
   uint auto_key_type;
   uint keys;
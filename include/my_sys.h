@@ -140,6 +140,8 @@ typedef struct my_aio_result {
 #define MY_WAIT_FOR_USER_TO_FIX_PANIC	60	/* in seconds */
 #define MY_WAIT_GIVE_USER_A_MESSAGE	10	/* Every 10 times of prev */
 #define MIN_COMPRESS_LENGTH		50	/* Don't compress small bl. */
+/* Size of buffer needed by my_compress_to() */
+#define my_compress_bound(len)	((len) * 120 / 100 + 12)
 #define DFLT_INIT_HITS  3
 
 	/* root_alloc flags */
@@ -786,6 +788,12 @@ extern my_bool radixsort_is_appliccable(uint n_items, size_t size_of_element);
 extern void my_string_ptr_sort(uchar *base,uint items,size_t size);
 extern void radixsort_for_str_ptr(uchar* base[], uint number_of_elements,
 				  size_t size_of_element,uchar *buffer[]);
+extern my_bool radixsort_msd_is_appliccable(uint n_items,
+                                            size_t size_of_element);
+extern my_bool radixsort_msd_for_str_ptr(uchar* base[],
+                                         uint number_of_elements,
+                                         size_t size_of_element,
+                                         myf MyFlags);
 extern qsort_t my_qsort(void *base_ptr, size_t total_elems, size_t size,
                         qsort_cmp cmp);
 extern qsort_t my_qsort2(void *base_ptr, size_t total_elems, size_t size,
@@ -907,6 +915,11 @@ extern void *my_az_allocator(void *dummy, unsigned int items, unsigned int size)
 extern void my_az_free(void *dummy, void *address);
 extern int my_compress_buffer(uchar *dest, size_t *destLen,
                               const uchar *source, size_t sourceLen);
+extern int my_compress_buffer2(uchar *dest, size_t *destLen,
+                               const uchar *source, size_t sourceLen,
+                               int level, int window_bits, int mem_level);
+extern my_bool my_compress_to(uchar *dest, const uchar *packet, size_t *len,
+                              size_t *complen, uint level);
 extern int packfrm(const uchar *, size_t, uchar **, size_t *);
 extern int unpackfrm(uchar **, size_t *, const uchar *);
 
@@ -183,7 +183,8 @@ enum mysql_option
   /* MariaDB options */
   MYSQL_PROGRESS_CALLBACK=5999,
   MYSQL_OPT_NONBLOCK,
-  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY
+  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY,
+  MYSQL_OPT_COMPRESSION_LEVEL
 };
 
 /**
@@ -775,7 +776,18 @@ enum enum_stmt_attr_type
     Amount of rows to retrieve from server per one fetch if using cursors.
     Accepts unsigned long attribute in the range 1 - ulong_max
   */
-  STMT_ATTR_PREFETCH_ROWS
+  STMT_ATTR_PREFETCH_ROWS,
+  /*
+    Number of parameter sets sent by one mysql_stmt_execute(), unsigned int.
+    Above 1, every MYSQL_BIND given to mysql_stmt_bind_param() binds an
+    array of that many values: buffer points to an array of values of
+    buffer_type (MYSQL_TIME for temporal types, pointers to the data for
+    string, blob and decimal types), length and is_null, if set, to
+    arrays of lengths and NULL flags. The statement must not return a
+    result set, mysql_stmt_affected_rows() gives the total for all sets.
+    Needs a server with MARIADB_CLIENT_STMT_BULK_OPERATIONS.
+  */
+  STMT_ATTR_ARRAY_SIZE
 };
 
 MYSQL_STMT * STDCALL mysql_stmt_init(MYSQL *mysql);
@@ -787,6 +799,8 @@ int STDCALL mysql_stmt_prepare_cont(int *ret, MYSQL_STMT *stmt, int status);
 int STDCALL mysql_stmt_execute(MYSQL_STMT *stmt);
 int STDCALL mysql_stmt_execute_start(int *ret, MYSQL_STMT *stmt);
 int STDCALL mysql_stmt_execute_cont(int *ret, MYSQL_STMT *stmt, int status);
+int STDCALL mysql_stmt_send_execute(MYSQL_STMT *stmt);
+int STDCALL mysql_stmt_read_execute_result(MYSQL_STMT *stmt);
 int STDCALL mysql_stmt_fetch(MYSQL_STMT *stmt);
 int STDCALL mysql_stmt_fetch_start(int *ret, MYSQL_STMT *stmt);
 int STDCALL mysql_stmt_fetch_cont(int *ret, MYSQL_STMT *stmt, int status);
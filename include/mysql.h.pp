@@ -28,7 +28,7 @@ typedef struct st_net {
   char net_skip_rest_factor;
   my_bool thread_specific_malloc;
   my_bool compress;
-  my_bool unused3;
+  unsigned char compress_level;
   void *thd;
   unsigned int last_errno;
   unsigned char error;
@@ -269,7 +269,8 @@ enum mysql_option
   MYSQL_OPT_CAN_HANDLE_EXPIRED_PASSWORDS,
   MYSQL_PROGRESS_CALLBACK=5999,
   MYSQL_OPT_NONBLOCK,
-  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY
+  MYSQL_OPT_USE_THREAD_SPECIFIC_MEMORY,
+  MYSQL_OPT_COMPRESSION_LEVEL
 };
 struct st_mysql_options_extention;
 struct st_mysql_options {
@@ -651,7 +652,8 @@ enum enum_stmt_attr_type
 {
   STMT_ATTR_UPDATE_MAX_LENGTH,
   STMT_ATTR_CURSOR_TYPE,
-  STMT_ATTR_PREFETCH_ROWS
+  STMT_ATTR_PREFETCH_ROWS,
+  STMT_ATTR_ARRAY_SIZE
 };
 MYSQL_STMT * mysql_stmt_init(MYSQL *mysql);
 int mysql_stmt_prepare(MYSQL_STMT *stmt, const char *query,
@@ -662,6 +664,8 @@ int mysql_stmt_prepare_cont(int *ret, MYSQL_STMT *stmt, int status);
 int mysql_stmt_execute(MYSQL_STMT *stmt);
 int mysql_stmt_execute_start(int *ret, MYSQL_STMT *stmt);
 int mysql_stmt_execute_cont(int *ret, MYSQL_STMT *stmt, int status);
+int mysql_stmt_send_execute(MYSQL_STMT *stmt);
+int mysql_stmt_read_execute_result(MYSQL_STMT *stmt);
 int mysql_stmt_fetch(MYSQL_STMT *stmt);
 int mysql_stmt_fetch_start(int *ret, MYSQL_STMT *stmt);
 int mysql_stmt_fetch_cont(int *ret, MYSQL_STMT *stmt, int status);
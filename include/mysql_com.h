@@ -229,6 +229,18 @@ enum enum_server_command
 */
 #define CLIENT_REMEMBER_OPTIONS (1UL << 31)
 
+/*
+  MariaDB extended capabilities, the upper 32 bits of 64 bit capabilities.
+  A server that has them clears CLIENT_MYSQL in the handshake packet and
+  sends the upper half in the last 4 bytes of the filler that follows the
+  status flags. Clients that don't know about them see a zero filler.
+*/
+#define CLIENT_MYSQL CLIENT_LONG_PASSWORD
+/* COM_STMT_EXECUTE accepts an iteration count above 1 (array binding) */
+#define MARIADB_CLIENT_STMT_BULK_OPERATIONS (1ULL << 34)
+
+#define MARIADB_CLIENT_EXTENDED_FLAGS MARIADB_CLIENT_STMT_BULK_OPERATIONS
+
 #ifdef HAVE_COMPRESS
 #define CAN_CLIENT_COMPRESS CLIENT_COMPRESS
 #else
@@ -378,7 +390,7 @@ typedef struct st_net {
   char net_skip_rest_factor;
   my_bool thread_specific_malloc;
   my_bool compress;
-  my_bool unused3; /* Please remove with the next incompatible ABI change. */
+  unsigned char compress_level;  /* zlib level (1-9), 0 for the default */
   /*
     Pointer to query object in query cache, do not equal NULL (0) for
     queries in cache that have not stored its results yet
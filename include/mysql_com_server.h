@@ -38,4 +38,14 @@ struct st_net_server
 
 typedef struct st_net_server NET_SERVER;
 
+/* One of the buffers of a packet written by my_net_write_parts() */
+typedef struct st_net_part
+{
+  const unsigned char *data;
+  size_t length;
+} NET_PART;
+
+my_bool my_net_write_parts(struct st_net *net, const NET_PART *parts,
+                           unsigned int count);
+
 #endif
@@ -44,8 +44,23 @@ struct st_mysql_options_extention {
   struct mysql_async_context *async_context;
   HASH connection_attributes;
   size_t connection_attributes_length;
+  uint compression_level;                       /* 0 for the zlib default */
+  /* Statements sent and results read by mysql_stmt_send_execute() */
+  ulonglong pipeline_sent, pipeline_read;
+  /* MariaDB extended capabilities of the server, see CLIENT_MYSQL */
+  ulonglong server_ext_capabilities;
 };
 
+/* Number of results of mysql_stmt_send_execute() not read yet */
+#define mysql_server_has_ext_capability(M, F) \
+  ((M)->options.extension && \
+   ((M)->options.extension->server_ext_capabilities & (F)))
+
+#define mysql_pipelined_executes(M) \
+  ((M)->options.extension ? \
+   (M)->options.extension->pipeline_sent - \
+   (M)->options.extension->pipeline_read : 0)
+
 typedef struct st_mysql_methods
 {
   my_bool (*read_query_result)(MYSQL *mysql);
@@ -62,9 +62,6 @@ ulong  thd_get_net_wait_timeout(THD *thd);
 my_socket thd_get_fd(THD *thd);
 int thd_store_globals(THD* thd);
 
-THD *first_global_thread();
-THD *next_global_thread(THD *thd);
-
 /* Print to the MySQL error log */
 void sql_print_error(const char *format, ...);
 
@@ -101,8 +101,15 @@ static my_bool org_my_init_done= 0;
 typedef struct st_mysql_stmt_extension
 {
   MEM_ROOT fields_mem_root;
+  /* Position in the pipeline of mysql_stmt_send_execute(), 0 if none */
+  ulonglong pipeline_pos;
+  /* Parameter sets per execute, see STMT_ATTR_ARRAY_SIZE; 0 means 1 */
+  uint array_size;
 } MYSQL_STMT_EXT;
 
+static my_bool int_is_null_true= 1;		/* Used for MYSQL_TYPE_NULL */
+static my_bool int_is_null_false= 0;
+
 
 /*
   Initialize the MySQL client library
@@ -2035,20 +2042,22 @@ static void store_param_str(NET *net, MYSQL_BIND *param)
     we don't have reserved bits for OK/error packet.
 */
 
-static void store_param_null(NET *net, MYSQL_BIND *param)
+static void store_param_null(NET *net, MYSQL_BIND *param, ulong null_pos)
 {
   uint pos= param->param_number;
-  net->buff[pos/8]|=  (uchar) (1 << (pos & 7));
+  net->buff[null_pos + pos/8]|=  (uchar) (1 << (pos & 7));
 }
 
 
 /*
   Store one parameter in network packet: data is read from
   client buffer and saved in network packet by means of one
-  of store_param_xxxx functions.
+  of store_param_xxxx functions. null_pos is the offset in
+  net->buff of the NULL bitmap of the parameter set.
 */
 
-static my_bool store_param(MYSQL_STMT *stmt, MYSQL_BIND *param)
+static my_bool store_param(MYSQL_STMT *stmt, MYSQL_BIND *param,
+                           ulong null_pos)
 {
   NET *net= &stmt->mysql->net;
   DBUG_ENTER("store_param");
@@ -2058,7 +2067,7 @@ static my_bool store_param(MYSQL_STMT *stmt, MYSQL_BIND *param)
                       *param->length, *param->is_null));
 
   if (*param->is_null)
-    store_param_null(net, param);
+    store_param_null(net, param, null_pos);
   else
   {
     /*
@@ -2077,27 +2086,55 @@ static my_bool store_param(MYSQL_STMT *stmt, MYSQL_BIND *param)
 
 
 /*
-  Auxilary function to send COM_STMT_EXECUTE packet to server and read reply.
-  Used from cli_stmt_execute, which is in turn used by mysql_stmt_execute.
+  Make 'bind' describe element 'row' of the arrays bound by 'param',
+  see STMT_ATTR_ARRAY_SIZE.
+*/
+
+static void bind_array_element(MYSQL_BIND *bind, MYSQL_BIND *param, uint row)
+{
+  *bind= *param;
+  if (param->is_null != &int_is_null_false &&
+      param->is_null != &int_is_null_true)
+    bind->is_null= param->is_null + row;
+  if (param->length != &param->buffer_length)
+    bind->length= param->length + row;
+
+  switch (param->buffer_type) {
+  case MYSQL_TYPE_NULL:
+    break;
+  case MYSQL_TYPE_TIME:
+  case MYSQL_TYPE_DATE:
+  case MYSQL_TYPE_DATETIME:
+  case MYSQL_TYPE_TIMESTAMP:
+    bind->buffer= (MYSQL_TIME*) param->buffer + row;
+    break;
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+    bind->buffer= (char*) param->buffer + row * param->buffer_length;
+    break;
+  default:                                      /* strings, blobs, decimals */
+    bind->buffer= ((void**) param->buffer)[row];
+    break;
+  }
+}
+
+
+/*
+  Auxilary function to read the reply to COM_STMT_EXECUTE.
+  'res' is the result of sending the packet.
 */
 
-static my_bool execute(MYSQL_STMT *stmt, char *packet, ulong length)
+static my_bool read_execute_result(MYSQL_STMT *stmt, my_bool res)
 {
   MYSQL *mysql= stmt->mysql;
   NET	*net= &mysql->net;
-  uchar buff[4 /* size of stmt id */ +
-             5 /* execution flags */];
-  my_bool res;
-  DBUG_ENTER("execute");
-  DBUG_DUMP("packet", (uchar *) packet, length);
-
-  int4store(buff, stmt->stmt_id);		/* Send stmt id to server */
-  buff[4]= (char) stmt->flags;
-  int4store(buff+5, 1);                         /* iteration count */
+  DBUG_ENTER("read_execute_result");
 
-  res= MY_TEST(cli_advanced_command(mysql, COM_STMT_EXECUTE, buff, sizeof(buff),
-                                    (uchar*) packet, length, 1, stmt) ||
-            (*mysql->methods->read_query_result)(mysql));
+  res= res || (*mysql->methods->read_query_result)(mysql);
   stmt->affected_rows= mysql->affected_rows;
   stmt->server_status= mysql->server_status;
   stmt->insert_id= mysql->insert_id;
@@ -2117,18 +2154,83 @@ static my_bool execute(MYSQL_STMT *stmt, char *packet, ulong length)
 }
 
 
-int cli_stmt_execute(MYSQL_STMT *stmt)
+/*
+  Auxilary function to send COM_STMT_EXECUTE packet to server and read reply.
+  Used from cli_stmt_execute, which is in turn used by mysql_stmt_execute.
+  The packet holds 'iterations' parameter sets (array binding).
+
+  If 'pipelined' is set, the reply is not read: it is read later by
+  mysql_stmt_read_execute_result(), and any replies to earlier commands
+  that are already waiting in the socket are left there.
+*/
+
+static my_bool execute(MYSQL_STMT *stmt, char *packet, ulong length,
+                       uint iterations, my_bool pipelined)
 {
-  DBUG_ENTER("cli_stmt_execute");
+  MYSQL *mysql= stmt->mysql;
+  NET	*net= &mysql->net;
+  uchar buff[4 /* size of stmt id */ +
+             5 /* execution flags */];
+  my_bool res;
+  DBUG_ENTER("execute");
+  DBUG_DUMP("packet", (uchar *) packet, length);
+
+  int4store(buff, stmt->stmt_id);		/* Send stmt id to server */
+  buff[4]= (char) stmt->flags;
+  int4store(buff+5, iterations);                /* iteration count */
+
+  if (pipelined)
+  {
+    net_clear_error(net);
+    net_clear(net, 0);
+    if (net_write_command(net, (uchar) COM_STMT_EXECUTE, buff, sizeof(buff),
+                          (uchar*) packet, length))
+    {
+      set_stmt_error(stmt, net->last_errno == ER_NET_PACKET_TOO_LARGE ?
+                     CR_NET_PACKET_TOO_LARGE : CR_SERVER_GONE_ERROR,
+                     unknown_sqlstate, NULL);
+      DBUG_RETURN(1);
+    }
+    DBUG_RETURN(0);
+  }
+  res= MY_TEST(cli_advanced_command(mysql, COM_STMT_EXECUTE, buff, sizeof(buff),
+                                    (uchar*) packet, length, 1, stmt));
+  DBUG_RETURN(read_execute_result(stmt, res));
+}
+
+
+/*
+  Check that the server can execute the statement for all the parameter
+  sets of an array binding (STMT_ATTR_ARRAY_SIZE), if there are several.
+*/
+
+static my_bool check_array_binding(MYSQL_STMT *stmt)
+{
+  if (stmt->extension->array_size > 1 &&
+      !mysql_server_has_ext_capability(stmt->mysql,
+                                       MARIADB_CLIENT_STMT_BULK_OPERATIONS))
+  {
+    set_stmt_error(stmt, CR_NOT_IMPLEMENTED, unknown_sqlstate, NULL);
+    return 1;
+  }
+  return 0;
+}
+
+
+static int stmt_execute(MYSQL_STMT *stmt, my_bool pipelined)
+{
+  uint rows= stmt->extension->array_size ? stmt->extension->array_size : 1;
+  DBUG_ENTER("stmt_execute");
 
   if (stmt->param_count)
   {
     MYSQL *mysql= stmt->mysql;
     NET        *net= &mysql->net;
     MYSQL_BIND *param, *param_end;
+    MYSQL_BIND element;
     char       *param_data;
-    ulong length;
-    uint null_count;
+    ulong length, null_pos;
+    uint null_count, row;
     my_bool    result;
 
     if (!stmt->bind_param_done)
@@ -2137,55 +2239,81 @@ int cli_stmt_execute(MYSQL_STMT *stmt)
       DBUG_RETURN(1);
     }
     if (mysql->status != MYSQL_STATUS_READY ||
-        mysql->server_status & SERVER_MORE_RESULTS_EXISTS)
+        mysql->server_status & SERVER_MORE_RESULTS_EXISTS ||
+        (!pipelined && mysql_pipelined_executes(mysql)))
     {
       set_stmt_error(stmt, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate, NULL);
       DBUG_RETURN(1);
     }
 
     if (net->vio)
-      net_clear(net, 1);          /* Sets net->write_pos */
+      net_clear(net, !pipelined);  /* Sets net->write_pos */
     else
     {
       set_stmt_errmsg(stmt, net);
       DBUG_RETURN(1);             
     }
 
-    /* Reserve place for null-marker bytes */
     null_count= (stmt->param_count+7) /8;
-    if (my_realloc_str(net, null_count + 1))
-    {
-      set_stmt_errmsg(stmt, net);
-      DBUG_RETURN(1);
-    }
-    bzero((char*) net->write_pos, null_count);
-    net->write_pos+= null_count;
     param_end= stmt->params + stmt->param_count;
 
-    /* In case if buffers (type) altered, indicate to server */
-    *(net->write_pos)++= (uchar) stmt->send_types_to_server;
-    if (stmt->send_types_to_server)
+    /*
+      With array binding each parameter set is stored as if it was the
+      only one, but types are sent with the first set only.
+    */
+    for (row= 0; row < rows; row++)
     {
-      if (my_realloc_str(net, 2 * stmt->param_count))
+      my_bool send_types= row == 0 && stmt->send_types_to_server;
+
+      /* Reserve place for null-marker bytes */
+      if (my_realloc_str(net, null_count + 1))
       {
         set_stmt_errmsg(stmt, net);
         DBUG_RETURN(1);
       }
-      /*
-	Store types of parameters in first in first package
-	that is sent to the server.
-      */
-      for (param= stmt->params;	param < param_end ; param++)
-        store_param_type(&net->write_pos, param);
-    }
+      null_pos= (ulong) (net->write_pos - net->buff);
+      bzero((char*) net->write_pos, null_count);
+      net->write_pos+= null_count;
 
-    for (param= stmt->params; param < param_end; param++)
-    {
-      /* check if mysql_stmt_send_long_data() was used */
-      if (param->long_data_used)
-	param->long_data_used= 0;	/* Clear for next execute call */
-      else if (store_param(stmt, param))
-	DBUG_RETURN(1);
+      /* In case if buffers (type) altered, indicate to server */
+      *(net->write_pos)++= (uchar) send_types;
+      if (send_types)
+      {
+        if (my_realloc_str(net, 2 * stmt->param_count))
+        {
+          set_stmt_errmsg(stmt, net);
+          DBUG_RETURN(1);
+        }
+        /*
+          Store types of parameters in first in first package
+          that is sent to the server.
+        */
+        for (param= stmt->params;	param < param_end ; param++)
+          store_param_type(&net->write_pos, param);
+      }
+
+      for (param= stmt->params; param < param_end; param++)
+      {
+        /* check if mysql_stmt_send_long_data() was used */
+        if (param->long_data_used)
+        {
+          if (rows > 1)
+          {
+            /* Long data can't be sent for an array of values */
+            set_stmt_error(stmt, CR_NOT_IMPLEMENTED, unknown_sqlstate, NULL);
+            DBUG_RETURN(1);
+          }
+          param->long_data_used= 0;	/* Clear for next execute call */
+        }
+        else if (rows > 1)
+        {
+          bind_array_element(&element, param, row);
+          if (store_param(stmt, &element, null_pos))
+            DBUG_RETURN(1);
+        }
+        else if (store_param(stmt, param, null_pos))
+          DBUG_RETURN(1);
+      }
     }
     length= (ulong) (net->write_pos - net->buff);
     /* TODO: Look into avoding the following memdup */
@@ -2194,12 +2322,18 @@ int cli_stmt_execute(MYSQL_STMT *stmt)
       set_stmt_error(stmt, CR_OUT_OF_MEMORY, unknown_sqlstate, NULL);
       DBUG_RETURN(1);
     }
-    result= execute(stmt, param_data, length);
+    result= execute(stmt, param_data, length, rows, pipelined);
     stmt->send_types_to_server=0;
     my_free(param_data);
     DBUG_RETURN(result);
   }
-  DBUG_RETURN((int) execute(stmt,0,0));
+  DBUG_RETURN((int) execute(stmt, 0, 0, rows, pipelined));
+}
+
+
+int cli_stmt_execute(MYSQL_STMT *stmt)
+{
+  return stmt_execute(stmt, FALSE);
 }
 
 /*
@@ -2409,6 +2543,9 @@ my_bool STDCALL mysql_stmt_attr_set(MYSQL_STMT *stmt,
     stmt->prefetch_rows= prefetch_rows;
     break;
   }
+  case STMT_ATTR_ARRAY_SIZE:
+    stmt->extension->array_size= value ? *(const uint*) value : 0;
+    break;
   default:
     goto err_not_implemented;
   }
@@ -2433,6 +2570,10 @@ my_bool STDCALL mysql_stmt_attr_get(MYSQL_STMT *stmt,
   case STMT_ATTR_PREFETCH_ROWS:
     *(ulong*) value= stmt->prefetch_rows;
     break;
+  case STMT_ATTR_ARRAY_SIZE:
+    *(uint*) value= stmt->extension->array_size ?
+                    stmt->extension->array_size : 1;
+    break;
   default:
     return TRUE;
   }
@@ -2569,7 +2710,8 @@ int STDCALL mysql_stmt_execute(MYSQL_STMT *stmt)
     DBUG_RETURN(1);
   }
 
-  if (reset_stmt_handle(stmt, RESET_STORE_RESULT | RESET_CLEAR_ERROR))
+  if (reset_stmt_handle(stmt, RESET_STORE_RESULT | RESET_CLEAR_ERROR) ||
+      check_array_binding(stmt))
     DBUG_RETURN(1);
   /*
     No need to check for stmt->state: if the statement wasn't
@@ -2587,6 +2729,149 @@ int STDCALL mysql_stmt_execute(MYSQL_STMT *stmt)
 }
 
 
+/*
+  Send placeholders data to server and execute prepared statement,
+  without waiting for the result.
+
+  SYNOPSIS
+    mysql_stmt_send_execute()
+    stmt  statement handle, prepared and with parameters bound as
+          for mysql_stmt_execute()
+
+  DESCRIPTION
+    This is the first half of mysql_stmt_execute(). Several statements
+    can be sent this way before reading any of the results, so that
+    independent statements cost one round trip in total instead of one
+    each. The server executes them in the order they were sent.
+
+    The result of each statement must then be read, in the same order,
+    with mysql_stmt_read_execute_result(), which does the second half of
+    mysql_stmt_execute(). A result set must be fetched completely (or
+    stored with mysql_stmt_store_result()) before the next result is read.
+    No other command can be sent on the connection while there are
+    results left to read. mysql_stmt_close() and mysql_stmt_reset() read
+    and discard the result of the statement if it is the next one.
+
+    The parameters are copied when the statement is sent, so the bound
+    buffers can be changed and the same statement handle can not be
+    sent again until its result is read. Cursors and the compressed
+    protocol are not supported.
+
+    As the server doesn't read the next command before the result of
+    the previous one is sent, the results of a batch should fit in the
+    socket buffers; otherwise both sides wait for each other.
+
+  RETURN
+    0   success
+    1   error, message can be retrieved with mysql_stmt_error().
+*/
+
+int STDCALL mysql_stmt_send_execute(MYSQL_STMT *stmt)
+{
+  MYSQL *mysql= stmt->mysql;
+  DBUG_ENTER("mysql_stmt_send_execute");
+
+  if (!mysql)
+  {
+    /* Error is already set in mysql_detatch_stmt_list */
+    DBUG_RETURN(1);
+  }
+#ifdef EMBEDDED_LIBRARY
+  set_stmt_error(stmt, CR_NOT_IMPLEMENTED, unknown_sqlstate, NULL);
+  DBUG_RETURN(1);
+#else
+  if (mysql->net.compress || stmt->flags != CURSOR_TYPE_NO_CURSOR)
+  {
+    set_stmt_error(stmt, CR_NOT_IMPLEMENTED, unknown_sqlstate, NULL);
+    DBUG_RETURN(1);
+  }
+  /*
+    Unlike mysql_stmt_execute() we can't leave this to the server: the
+    error would only be seen when the result is read.
+  */
+  if ((int) stmt->state < (int) MYSQL_STMT_PREPARE_DONE ||
+      stmt->extension->pipeline_pos ||
+      mysql->status != MYSQL_STATUS_READY ||
+      mysql->server_status & SERVER_MORE_RESULTS_EXISTS || !mysql->net.vio)
+  {
+    set_stmt_error(stmt, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate, NULL);
+    DBUG_RETURN(1);
+  }
+  if (!mysql->options.extension &&
+      !(mysql->options.extension= (struct st_mysql_options_extention *)
+        my_malloc(sizeof(struct st_mysql_options_extention),
+                  MYF(MY_WME | MY_ZEROFILL))))
+  {
+    set_stmt_error(stmt, CR_OUT_OF_MEMORY, unknown_sqlstate, NULL);
+    DBUG_RETURN(1);
+  }
+
+  if (reset_stmt_handle(stmt, RESET_STORE_RESULT | RESET_CLEAR_ERROR) ||
+      check_array_binding(stmt) || stmt_execute(stmt, TRUE))
+    DBUG_RETURN(1);
+  stmt->extension->pipeline_pos= ++mysql->options.extension->pipeline_sent;
+  DBUG_RETURN(0);
+#endif
+}
+
+
+/*
+  Read the result of a statement sent with mysql_stmt_send_execute()
+
+  SYNOPSIS
+    mysql_stmt_read_execute_result()
+    stmt  statement handle
+
+  DESCRIPTION
+    Results must be read in the order the statements were sent. After
+    this the statement is in the same state as after mysql_stmt_execute().
+
+  RETURN
+    0   success
+    1   error, message can be retrieved with mysql_stmt_error().
+*/
+
+int STDCALL mysql_stmt_read_execute_result(MYSQL_STMT *stmt)
+{
+  MYSQL *mysql= stmt->mysql;
+  DBUG_ENTER("mysql_stmt_read_execute_result");
+
+  if (!mysql)
+  {
+    /* Error is already set in mysql_detatch_stmt_list */
+    DBUG_RETURN(1);
+  }
+  if (!stmt->extension->pipeline_pos ||
+      stmt->extension->pipeline_pos !=
+      mysql->options.extension->pipeline_read + 1 ||
+      mysql->status != MYSQL_STATUS_READY ||
+      mysql->server_status & SERVER_MORE_RESULTS_EXISTS)
+  {
+    set_stmt_error(stmt, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate, NULL);
+    DBUG_RETURN(1);
+  }
+  mysql->options.extension->pipeline_read++;
+  stmt->extension->pipeline_pos= 0;
+  stmt_clear_error(stmt);
+
+  /* Set up the connection as cli_advanced_command() does after sending */
+  net_clear_error(&mysql->net);
+  mysql->info= 0;
+  mysql->affected_rows= ~(my_ulonglong) 0;
+  mysql->net.pkt_nr= 1;                         /* Reply to packet 0 */
+
+  if (read_execute_result(stmt, 0))
+    DBUG_RETURN(1);
+  stmt->state= MYSQL_STMT_EXECUTE_DONE;
+  if (mysql->field_count)
+  {
+    reinit_result_set_metadata(stmt);
+    prepare_to_fetch_result(stmt);
+  }
+  DBUG_RETURN(MY_TEST(stmt->last_errno));
+}
+
+
 /*
   Return total parameters count in the statement
 */
@@ -2639,10 +2924,6 @@ my_ulonglong STDCALL mysql_stmt_insert_id(MYSQL_STMT *stmt)
 }
 
 
-static my_bool int_is_null_true= 1;		/* Used for MYSQL_TYPE_NULL */
-static my_bool int_is_null_false= 0;
-
-
 /*
   Set up input data buffers for a statement.
 
@@ -4673,6 +4954,22 @@ my_bool STDCALL mysql_stmt_free_result(MYSQL_STMT *stmt)
  statement error handling and close
 *********************************************************************/
 
+/*
+  Read and throw away the result of a mysql_stmt_send_execute() of the
+  statement that was not read yet, so that the connection can be used
+  again. Fails, leaving the statement as it is, if the results of
+  statements sent before it were not read yet.
+*/
+
+static my_bool discard_pipelined_result(MYSQL_STMT *stmt)
+{
+  if (!stmt->extension->pipeline_pos)
+    return 0;
+  /* An error of the statement itself still consumes the result */
+  return mysql_stmt_read_execute_result(stmt) &&
+         stmt->extension->pipeline_pos;
+}
+
 /*
   Close the statement handle by freeing all alloced resources
 
@@ -4691,6 +4988,9 @@ my_bool STDCALL mysql_stmt_close(MYSQL_STMT *stmt)
   int rc= 0;
   DBUG_ENTER("mysql_stmt_close");
 
+  if (mysql && discard_pipelined_result(stmt))
+    DBUG_RETURN(1);
+
   free_root(&stmt->result.alloc, MYF(0));
   free_root(&stmt->mem_root, MYF(0));
   free_root(&stmt->extension->fields_mem_root, MYF(0));
@@ -4739,6 +5039,8 @@ my_bool STDCALL mysql_stmt_reset(MYSQL_STMT *stmt)
     set_stmt_error(stmt, CR_SERVER_LOST, unknown_sqlstate, NULL);
     DBUG_RETURN(1);
   }
+  if (discard_pipelined_result(stmt))
+    DBUG_RETURN(1);
   /* Reset the client and server sides of the prepared statement */
   DBUG_RETURN(reset_stmt_handle(stmt,
                                 RESET_SERVER_SIDE | RESET_LONG_DATA |
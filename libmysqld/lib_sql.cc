@@ -329,12 +329,13 @@ static my_bool emb_read_query_result(MYSQL *mysql)
 static int emb_stmt_execute(MYSQL_STMT *stmt)
 {
   DBUG_ENTER("emb_stmt_execute");
-  uchar header[5];
+  uchar header[9];
   THD *thd;
   my_bool res;
 
   int4store(header, stmt->stmt_id);
   header[4]= (uchar) stmt->flags;
+  int4store(header + 5, 1);                     /* iteration count */
   thd= (THD*)stmt->mysql->thd;
   thd->client_param_count= stmt->param_count;
   thd->client_params= stmt->params;
@@ -423,11 +424,11 @@ int emb_unbuffered_fetch(MYSQL *mysql, char **row)
 static void emb_free_embedded_thd(MYSQL *mysql)
 {
   THD *thd= (THD*)mysql->thd;
+  server_threads.erase(thd);
   mysql_mutex_lock(&LOCK_thread_count);
   thd->clear_data_list();
   thread_count--;
   thd->store_globals();
-  thd->unlink();
   delete thd;
   mysql_mutex_unlock(&LOCK_thread_count);
   my_pthread_setspecific_ptr(THR_THD,  0);
@@ -701,8 +702,8 @@ void *create_embedded_thd(int client_flag)
 
   mysql_mutex_lock(&LOCK_thread_count);
   thread_count++;
-  threads.append(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   thd->mysys_var= 0;
   thd->reset_globals();
   return thd;
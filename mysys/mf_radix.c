@@ -58,3 +58,184 @@ void radixsort_for_str_ptr(uchar **base, uint number_of_elements, size_t size_of
   next:;
   }
 }
+
+
+/*
+  MSD radixsort for pointers to fixed length strings of any length.
+
+  Eight bytes of every string are cached next to its pointer, so that
+  the sort does not have to follow the pointers while it distributes the
+  strings byte by byte into 256 buckets (in place, "American flag sort").
+  When all cached bytes in a bucket are equal, the next eight bytes are
+  cached. Small buckets, buckets that a byte splits into very few parts
+  and buckets still not sorted after RADIX_MAX_DEPTH bytes are sorted by
+  comparing the cached bytes and then the rest of the strings.
+  Needs an extra buffer of number_of_elements (prefix, pointer) pairs.
+*/
+
+#define RADIX_PREFIX_LENGTH 8
+#define RADIX_MIN_BUCKET    64        /* Smaller buckets are compared */
+#define RADIX_MAX_DEPTH     32        /* Bytes to sort by distribution */
+#define RADIX_MIN_FANOUT    4         /* Compare if fewer buckets are used */
+
+typedef struct st_radix_key
+{
+  ulonglong prefix;                   /* Cached bytes, big-endian */
+  uchar *ptr;
+} RADIX_KEY;
+
+typedef struct st_radix_cmp_arg
+{
+  size_t offset;                      /* Offset of cached bytes */
+  size_t size;
+} RADIX_CMP_ARG;
+
+
+my_bool radixsort_msd_is_appliccable(uint n_items,
+                                     size_t size_of_element
+                                     __attribute__((unused)))
+{
+  return n_items >= 1000;
+}
+
+
+static inline ulonglong radix_prefix(const uchar *str, size_t size)
+{
+  ulonglong prefix= 0;
+  uint i;
+  for (i= 0; i < RADIX_PREFIX_LENGTH; i++)
+    prefix= (prefix << 8) | (i < size ? str[i] : 0);
+  return prefix;
+}
+
+
+static int radix_key_cmp(const void *cmp_arg, const void *a, const void *b)
+{
+  const RADIX_KEY *ka= (const RADIX_KEY*) a, *kb= (const RADIX_KEY*) b;
+  const RADIX_CMP_ARG *arg= (const RADIX_CMP_ARG*) cmp_arg;
+  size_t rest= arg->offset + RADIX_PREFIX_LENGTH;
+  if (ka->prefix != kb->prefix)
+    return ka->prefix < kb->prefix ? -1 : 1;
+  if (arg->size <= rest)
+    return 0;
+  return memcmp(ka->ptr + rest, kb->ptr + rest, arg->size - rest);
+}
+
+
+/*
+  Sort keys whose first 'offset' + 'byte' bytes are equal.
+  'work' has room for the bucket counts of the remaining levels.
+  Returns 1 without sorting if 'top' is set and the keys should rather
+  be compared by the caller.
+*/
+
+static my_bool radix_msd_sort(RADIX_KEY *keys, uint n, size_t offset,
+                              uint byte, size_t size, uint *work,
+                              my_bool top)
+{
+  uint *count= work, *next= work + 256;
+  uint b, pos, shift, buckets;
+  RADIX_KEY *key, *end= keys + n;
+
+  for (;;)
+  {
+    if (offset + byte >= size)
+      return 0;                         /* All strings are equal */
+    if (byte == RADIX_PREFIX_LENGTH && n >= RADIX_MIN_BUCKET &&
+        offset + byte < RADIX_MAX_DEPTH)
+    {
+      offset+= RADIX_PREFIX_LENGTH;
+      byte= 0;
+      for (key= keys; key < end; key++)
+        key->prefix= radix_prefix(key->ptr + offset, size - offset);
+    }
+    if (n < RADIX_MIN_BUCKET || byte == RADIX_PREFIX_LENGTH)
+    {
+      RADIX_CMP_ARG arg;
+      arg.offset= offset;
+      arg.size= size;
+      my_qsort2(keys, n, sizeof(RADIX_KEY), radix_key_cmp, &arg);
+      return 0;
+    }
+    shift= (RADIX_PREFIX_LENGTH - 1 - byte) * 8;
+    bzero((uchar*) count, sizeof(uint) * 256);
+    for (key= keys; key < end; key++)
+      count[(uint) (key->prefix >> shift) & 255]++;
+    if (count[(uint) (keys->prefix >> shift) & 255] != n)
+      break;
+    byte++;                             /* All strings in the same bucket */
+  }
+
+  for (b= 0, pos= 0, buckets= 0; b < 256; b++)
+  {
+    next[b]= pos;
+    pos+= count[b];
+    buckets+= count[b] != 0;
+  }
+  if (buckets < RADIX_MIN_FANOUT)
+  {
+    /* Distribution hardly splits the keys, comparing is cheaper */
+    RADIX_CMP_ARG arg;
+    if (top)
+      return 1;
+    arg.offset= offset;
+    arg.size= size;
+    my_qsort2(keys, n, sizeof(RADIX_KEY), radix_key_cmp, &arg);
+    return 0;
+  }
+  /* Move every key to its bucket, which ends where the next one starts */
+  for (b= 0, pos= 0; b < 256; b++)
+  {
+    uint bucket_end= (pos+= count[b]);
+    while (next[b] < bucket_end)
+    {
+      RADIX_KEY tmp, cur= keys[next[b]];
+      uint cur_b= (uint) (cur.prefix >> shift) & 255;
+      while (cur_b != b)
+      {
+        tmp= keys[next[cur_b]];
+        keys[next[cur_b]++]= cur;
+        cur= tmp;
+        cur_b= (uint) (cur.prefix >> shift) & 255;
+      }
+      keys[next[b]++]= cur;
+    }
+  }
+  for (b= 0, pos= 0; b < 256; pos+= count[b++])
+  {
+    if (count[b] > 1)
+      radix_msd_sort(keys + pos, count[b], offset, byte + 1, size,
+                     work + 512, 0);
+  }
+  return 0;
+}
+
+
+my_bool radixsort_msd_for_str_ptr(uchar **base, uint number_of_elements,
+                                  size_t size_of_element, myf MyFlags)
+{
+  RADIX_KEY *keys, *key;
+  uchar **ptr, **end= base + number_of_elements;
+  uint *work;
+
+  if (!(keys= (RADIX_KEY*) my_malloc(sizeof(RADIX_KEY) * number_of_elements +
+                                     sizeof(uint) * 512 * RADIX_MAX_DEPTH,
+                                     MyFlags)))
+    return 1;
+  work= (uint*) (keys + number_of_elements);
+  for (ptr= base, key= keys; ptr < end; ptr++, key++)
+  {
+    key->prefix= radix_prefix(*ptr, size_of_element);
+    key->ptr= *ptr;
+  }
+  if (radix_msd_sort(keys, number_of_elements, 0, 0, size_of_element, work,
+                     1))
+  {
+    my_free(keys);
+    return 1;
+  }
+  for (ptr= base, key= keys; ptr < end; ptr++, key++)
+    *ptr= key->ptr;
+  my_free(keys);
+  return 0;
+}
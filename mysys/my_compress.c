@@ -23,6 +23,9 @@
 #endif
 #include <zlib.h>
 
+/* Memory level used by deflateInit() */
+#define DEF_MEM_LEVEL 8
+
 /*
    This replaces the packet with a compressed packet
 
@@ -98,6 +101,19 @@ void my_az_free(void *dummy __attribute__((unused)), void *address)
 */
 int my_compress_buffer(uchar *dest, size_t *destLen,
                        const uchar *source, size_t sourceLen)
+{
+  return my_compress_buffer2(dest, destLen, source, sourceLen,
+                             Z_DEFAULT_COMPRESSION, MAX_WBITS, DEF_MEM_LEVEL);
+}
+
+/*
+  As my_compress_buffer(), but with the zlib level, window size and
+  memory level given by the caller. Any window size gives a stream that
+  can be read by uncompress().
+*/
+int my_compress_buffer2(uchar *dest, size_t *destLen,
+                        const uchar *source, size_t sourceLen,
+                        int level, int window_bits, int mem_level)
 {
     z_stream stream;
     int err;
@@ -113,7 +129,8 @@ int my_compress_buffer(uchar *dest, size_t *destLen,
     stream.zfree = (free_func)my_az_free;
     stream.opaque = (voidpf)0;
 
-    err = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+    err = deflateInit2(&stream, level, Z_DEFLATED, window_bits, mem_level,
+                       Z_DEFAULT_STRATEGY);
     if (err != Z_OK) return err;
 
     err = deflate(&stream, Z_FINISH);
@@ -131,7 +148,7 @@ uchar *my_compress_alloc(const uchar *packet, size_t *len, size_t *complen)
 {
   uchar *compbuf;
   int res;
-  *complen=  *len * 120 / 100 + 12;
+  *complen= my_compress_bound(*len);
 
   if (!(compbuf= (uchar *) my_malloc(*complen, MYF(MY_WME))))
     return 0;					/* Not enough memory */
@@ -157,6 +174,63 @@ uchar *my_compress_alloc(const uchar *packet, size_t *len, size_t *complen)
 }
 
 
+/*
+  Compress a packet into another buffer
+
+   SYNOPSIS
+     my_compress_to()
+     dest	Buffer of at least my_compress_bound(*len) bytes
+     packet	Data to compress
+     len	in:  Length of data to compress at 'packet'
+		out: Length of the compressed data at 'dest'
+     complen	out: Length of the original data
+     level	zlib compression level (1-9), or 0 for the zlib default
+
+   NOTES
+     Unlike my_compress() no temporary buffer is allocated and nothing is
+     copied. The window of the compressor is sized after the packet, so
+     that small packets don't pay for setting up (and zero filling) the
+     full 32K window and 128K hash table on both sides of the connection.
+
+   RETURN
+     1   Packet not compressed (too short, or got longer); 'dest' is not
+	 valid and 'len' is not changed
+     0   ok
+*/
+
+my_bool my_compress_to(uchar *dest, const uchar *packet, size_t *len,
+                       size_t *complen, uint level)
+{
+  size_t dest_len;
+  int window_bits;
+  DBUG_ENTER("my_compress_to");
+
+  if (*len < MIN_COMPRESS_LENGTH)
+  {
+    DBUG_PRINT("note",("Packet too short: Not compressed"));
+    DBUG_RETURN(1);
+  }
+  for (window_bits= 9;
+       window_bits < MAX_WBITS && ((size_t) 1 << window_bits) < *len;
+       window_bits++)
+  {}
+  dest_len= my_compress_bound(*len);
+  if (my_compress_buffer2(dest, &dest_len, packet, *len,
+                          level ? (int) level : Z_DEFAULT_COMPRESSION,
+                          window_bits, MY_MIN(window_bits - 6, DEF_MEM_LEVEL))
+      != Z_OK)
+    DBUG_RETURN(1);
+  if (dest_len >= *len)
+  {
+    DBUG_PRINT("note",("Packet got longer on compression; Not compressed"));
+    DBUG_RETURN(1);
+  }
+  *complen= *len;
+  *len= dest_len;
+  DBUG_RETURN(0);
+}
+
+
 /*
   Uncompress packet
 
@@ -92,8 +92,8 @@ static int prepare_for_fill(TABLE_LIST *tables)
   thd->thread_id= thd->variables.pseudo_thread_id= thd_thread_id;
   mysql_mutex_lock(&LOCK_thread_count);
   thread_count++;
-  threads.append(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   thd->thread_stack= (char*) &tables;
   if (thd->store_globals())
     return 1;
@@ -261,6 +261,7 @@ static void send_report(const char *when)
       reset all thread local status variables to minimize
       the effect of the background thread on SHOW STATUS.
     */
+    server_threads.erase(thd);
     mysql_mutex_lock(&LOCK_thread_count);
     thd->set_status_var_init();
     thread_count--;
@@ -311,9 +311,9 @@ dbcontext::init_thread(const void *stack_bottom, volatile int& shutdown_flag)
   {
     pthread_mutex_lock(&LOCK_thread_count);
     thd->thread_id = thread_id++;
-    threads.append(thd);
     ++thread_count;
     pthread_mutex_unlock(&LOCK_thread_count);
+    server_threads.insert(thd);
   }
 
   DBG_THR(fprintf(stderr, "HNDSOCK init thread wsts\n"));
@@ -347,6 +347,7 @@ dbcontext::term_thread()
   close_tables_if();
   my_pthread_setspecific_ptr(THR_THD, 0);
   {
+    server_threads.erase(thd);
     pthread_mutex_lock(&LOCK_thread_count);
     delete thd;
     thd = 0;
@@ -453,6 +454,7 @@ dbcontext::unlock_tables_if()
     mysql_unlock_tables(thd, lock);
     lock = thd->lock = 0;
     statistic_increment(unlock_tables_count, &LOCK_status);
+    thd->publish_status();
   }
   if (user_level_lock_locked) {
     if (user_lock->release_lock()) {
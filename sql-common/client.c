@@ -681,7 +681,8 @@ cli_advanced_command(MYSQL *mysql, enum enum_server_command command,
       DBUG_RETURN(1);
   }
   if (mysql->status != MYSQL_STATUS_READY ||
-      mysql->server_status & SERVER_MORE_RESULTS_EXISTS)
+      mysql->server_status & SERVER_MORE_RESULTS_EXISTS ||
+      mysql_pipelined_executes(mysql))
   {
     DBUG_PRINT("error",("state: %d", mysql->status));
     set_mysql_error(mysql, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate);
@@ -933,6 +934,9 @@ void end_server(MYSQL *mysql)
     vio_delete(mysql->net.vio);
     mysql->net.vio= 0;          /* Marker */
     mysql_prune_stmt_list(mysql);
+    if (mysql->options.extension)
+      mysql->options.extension->pipeline_sent=
+        mysql->options.extension->pipeline_read= 0;
   }
   net_end(&mysql->net);
   free_old_query(mysql);
@@ -3077,6 +3081,7 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
   char          *scramble_data;
   const char    *scramble_plugin;
   ulong		pkt_length;
+  ulonglong     server_ext_capabilities= 0;
   NET		*net= &mysql->net;
 #ifdef __WIN__
   HANDLE	hPipe=INVALID_HANDLE_VALUE;
@@ -3479,8 +3484,16 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
                       unknown_sqlstate);        /* purecov: inspected */
       goto error;
     }
+    if (!(mysql->server_capabilities & CLIENT_MYSQL))
+      server_ext_capabilities= ((ulonglong) uint4korr(end+14)) << 32;
   }
   end+= 18;
+  if (server_ext_capabilities || mysql->options.extension)
+  {
+    ENSURE_EXTENSIONS_PRESENT(&mysql->options);
+    mysql->options.extension->server_ext_capabilities=
+      server_ext_capabilities;
+  }
 
   if (mysql->options.secure_auth && passwd[0] &&
       !(mysql->server_capabilities & CLIENT_SECURE_CONNECTION))
@@ -3566,7 +3579,11 @@ CLI_MYSQL_REAL_CONNECT(MYSQL *mysql,const char *host, const char *user,
   */
 
   if (mysql->client_flag & CLIENT_COMPRESS)      /* We will use compression */
+  {
     net->compress=1;
+    if (mysql->options.extension)
+      net->compress_level= mysql->options.extension->compression_level;
+  }
 
   if (db && !mysql->db && mysql_select_db(mysql, db))
   {
@@ -4371,6 +4388,14 @@ mysql_options(MYSQL *mysql,enum mysql_option option, const void *arg)
     if (mysql->net.vio)
       mysql->net.vio->async_context= ctxt;
     break;
+  case MYSQL_OPT_COMPRESSION_LEVEL:
+    if (*(uint*) arg > 9)
+      DBUG_RETURN(1);
+    ENSURE_EXTENSIONS_PRESENT(&(mysql->options));
+    mysql->options.extension->compression_level= *(uint*) arg;
+    if (mysql->net.compress)
+      mysql->net.compress_level= (uchar) *(uint*) arg;
+    break;
   case MYSQL_OPT_SSL_KEY:
     SET_SSL_OPTION(&mysql->options,ssl_key, arg);
     break;
@@ -195,6 +195,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
                           table,
                           thd->variables.max_length_for_sort_data,
                           max_rows, sort_positions);
+  param.sort_threads= (uint) thd->variables.sort_threads;
 
   table_sort.addon_buf= 0;
   table_sort.addon_length= param.addon_length;
@@ -1418,12 +1419,221 @@ bool check_if_pq_applicable(Sort_param *param,
 }
 
 
+/**
+  IO_CACHE::write_function for the threads of merge_pass_parallel().
+  All threads write to the same file, so every write must be positional.
+*/
+
+static int merge_thread_write(IO_CACHE *info, const uchar *buffer,
+                              size_t count)
+{
+  if (buffer != info->write_buffer)
+  {
+    count&= ~((size_t) IO_SIZE - 1);            // The rest goes to the cache
+    if (!count)
+      return 0;
+  }
+  if (mysql_file_pwrite(info->file, buffer, count, info->pos_in_file,
+                        info->myflags | MY_NABP))
+    return info->error= -1;
+  info->pos_in_file+= count;
+  return 0;
+}
+
+
+/** A group of runs that merge_pass_parallel() merges to one run. */
+struct Merge_group
+{
+  BUFFPEK *first, *last;                        // Runs to merge
+  my_off_t to_pos;                              // Where to write the result
+  BUFFPEK result;
+};
+
+
+/**
+  Set up a Merge_group, and return the position after its merged run.
+*/
+
+static my_off_t init_merge_group(Merge_group *group,
+                                 BUFFPEK *first, BUFFPEK *last,
+                                 Sort_param *param, my_off_t to_pos)
+{
+  ha_rows count= 0;
+  group->first= first;
+  group->last= last;
+  group->to_pos= to_pos;
+  for (BUFFPEK *run= first; run <= last; run++)
+    count+= run->count;
+  return to_pos + MY_MIN(count, param->max_rows) * param->rec_length;
+}
+
+
+/** The work of one thread in merge_pass_parallel(). */
+struct Merge_task
+{
+  Sort_param param;                             // With our part of the buffer
+  uchar *sort_buffer;
+  IO_CACHE *from_file;
+  File to_file;
+  Merge_group *first_group, *end_group;
+  THD *thd;                                     // To check if killed
+  uint passes;                                  // Not counted in THD
+  int error;
+};
+
+
+static void merge_groups(void *arg)
+{
+  Merge_task *task= static_cast<Merge_task*>(arg);
+  for (Merge_group *group= task->first_group;
+       group != task->end_group && !task->error;
+       group++)
+  {
+    IO_CACHE to_file;
+    if (task->thd->killed)
+    {
+      task->error= 1;
+      break;
+    }
+    if (init_io_cache(&to_file, task->to_file, DISK_BUFFER_SIZE, WRITE_CACHE,
+                      group->to_pos, 0, MYF(MY_WME)))
+    {
+      task->error= 1;
+      break;
+    }
+    to_file.write_function= merge_thread_write;
+    if (merge_buffers(&task->param, task->from_file, &to_file,
+                      task->sort_buffer, &group->result,
+                      group->first, group->last, 0) ||
+        flush_io_cache(&to_file))
+      task->error= 1;
+    if (!current_thd)
+      task->passes++;                   // merge_buffers() did not count it
+    DBUG_ASSERT(task->error || my_b_tell(&to_file) ==
+                group->to_pos + group->result.count * task->param.rec_length);
+    end_io_cache(&to_file);
+  }
+}
+
+
+/**
+  Number of threads to use for a pass of merge_many_buff().
+
+  Threads share the sort buffer, and read and write the temporary files
+  with positional I/O, which encrypted temporary files do not support.
+  Unique removes duplicates while merging, so the size of each merged
+  run (and its place in the output file) is not known in advance.
+*/
+
+static uint merge_pass_threads(Sort_param *param, IO_CACHE *file)
+{
+  if (param->sort_threads <= 1 || param->unique_buff ||
+      (file->myflags & MY_ENCRYPT))
+    return 1;
+  return MY_MIN(param->sort_threads,
+                param->max_keys_per_buffer / MIN_KEYS_PER_SORT_THREAD);
+}
+
+
+/**
+  Do one pass of merge_many_buff() with several threads.
+
+  The runs are grouped exactly as in merge_many_buff(), and the groups
+  are divided between the threads. Each thread merges its groups with
+  merge_buffers() to their own part of to_file, as the size of each
+  merged run is known before merging.
+
+  @retval 0  OK
+  @retval 1  Error
+*/
+
+static int merge_pass_parallel(Sort_param *param, uchar *sort_buffer,
+                               BUFFPEK *buffpek, uint maxbuffer, uint threads,
+                               IO_CACHE *from_file, IO_CACHE *to_file,
+                               BUFFPEK **lastbuff)
+{
+  THD *thd= current_thd;
+  Merge_task tasks[MAX_SORT_THREADS];
+  Merge_group *groups, *group;
+  my_off_t to_pos= my_b_tell(to_file);
+  uint i, n_groups;
+  int error= 0;
+  DBUG_ENTER("merge_pass_parallel");
+
+  if (!(groups= (Merge_group*) my_malloc(sizeof(Merge_group) *
+                                         (maxbuffer / MERGEBUFF + 2),
+                                         MYF(MY_WME | MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(1);
+  if (to_file->file < 0 && real_open_cached_file(to_file))
+  {
+    my_free(groups);
+    DBUG_RETURN(1);
+  }
+
+  /* Same groups as in merge_many_buff() */
+  group= groups;
+  for (i=0 ; i <= maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+    to_pos= init_merge_group(group++, buffpek+i, buffpek+i+MERGEBUFF-1,
+                             param, to_pos);
+  to_pos= init_merge_group(group++, buffpek+i, buffpek+maxbuffer,
+                           param, to_pos);
+  n_groups= (uint) (group - groups);
+  set_if_smaller(threads, n_groups);
+  DBUG_PRINT("info", ("groups: %u  threads: %u", n_groups, threads));
+
+  uint keys_per_thread= param->max_keys_per_buffer / threads;
+  for (i= 0; i < threads; i++)
+  {
+    Merge_task *task= tasks + i;
+    task->param= *param;
+    task->param.max_keys_per_buffer= keys_per_thread;
+    task->sort_buffer= sort_buffer + (size_t) i * keys_per_thread *
+                                     param->rec_length;
+    task->from_file= from_file;
+    task->to_file= to_file->file;
+    task->first_group= groups + (ulonglong) n_groups * i / threads;
+    task->end_group= groups + (ulonglong) n_groups * (i + 1) / threads;
+    task->thd= thd;
+    task->passes= 0;
+    task->error= 0;
+  }
+  run_sort_tasks(merge_groups, tasks, sizeof(Merge_task), threads);
+
+  for (i= 0; i < threads; i++)
+  {
+    error|= tasks[i].error;
+    while (tasks[i].passes--)
+    {
+      thd->inc_status_sort_merge_passes();
+      thd->query_plan_fsort_passes++;
+    }
+  }
+  if (error)
+  {
+    /* The threads have no THD to report errors to */
+    if (!thd->killed)
+      my_error(ER_TEMP_FILE_WRITE_FAILURE, MYF(0));
+  }
+  else
+  {
+    for (i= 0; i < n_groups; i++)
+      buffpek[i]= groups[i].result;
+    *lastbuff= buffpek + n_groups;
+    /* Make my_b_tell(to_file) point to the end of the merged runs */
+    error= MY_TEST(reinit_io_cache(to_file, WRITE_CACHE, to_pos, 0, 0));
+  }
+  my_free(groups);
+  DBUG_RETURN(error);
+}
+
+
 /** Merge buffers to make < MERGEBUFF2 buffers. */
 
 int merge_many_buff(Sort_param *param, uchar *sort_buffer,
                     BUFFPEK *buffpek, uint *maxbuffer, IO_CACHE *t_file)
 {
   register uint i;
+  uint threads;
   IO_CACHE t_file2,*from_file,*to_file,*temp;
   BUFFPEK *lastbuff;
   DBUG_ENTER("merge_many_buff");
@@ -1436,6 +1646,7 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
     DBUG_RETURN(1);				/* purecov: inspected */
 
   from_file= t_file ; to_file= &t_file2;
+  threads= merge_pass_threads(param, t_file);
   while (*maxbuffer >= MERGEBUFF2)
   {
     if (reinit_io_cache(from_file,READ_CACHE,0L,0,0))
@@ -1443,15 +1654,24 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
     if (reinit_io_cache(to_file,WRITE_CACHE,0L,0,0))
       goto cleanup;
     lastbuff=buffpek;
-    for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+    if (threads > 1)
+    {
+      if (merge_pass_parallel(param, sort_buffer, buffpek, *maxbuffer,
+                              threads, from_file, to_file, &lastbuff))
+        break;
+    }
+    else
     {
+      for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+      {
+        if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
+                          buffpek+i,buffpek+i+MERGEBUFF-1,0))
+        goto cleanup;
+      }
       if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-			buffpek+i,buffpek+i+MERGEBUFF-1,0))
-      goto cleanup;
+                        buffpek+i,buffpek+ *maxbuffer,0))
+        break;					/* purecov: inspected */
     }
-    if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-		      buffpek+i,buffpek+ *maxbuffer,0))
-      break;					/* purecov: inspected */
     if (flush_io_cache(to_file))
       break;					/* purecov: inspected */
     temp=from_file; from_file=to_file; to_file=temp;
@@ -1493,6 +1713,14 @@ uint read_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
     buffpek->file_pos+= length;			/* New filepos */
     buffpek->count-=	count;
     buffpek->mem_count= count;
+#ifdef POSIX_FADV_WILLNEED
+    /* Let the OS read ahead the next part while this one is merged */
+    if (buffpek->count && !(fromfile->myflags & MY_ENCRYPT))
+      posix_fadvise(fromfile->file, buffpek->file_pos,
+                    (off_t) (MY_MIN(buffpek->count, buffpek->max_keys) *
+                             rec_length),
+                    POSIX_FADV_WILLNEED);
+#endif
   }
   return (count*rec_length);
 } /* read_to_buffer */
@@ -1571,11 +1799,15 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
   uchar *src;
   uchar *unique_buff= param->unique_buff;
   const bool killable= !param->not_killable;
+  /* NULL in the threads of merge_pass_parallel() */
   THD* const thd=current_thd;
   DBUG_ENTER("merge_buffers");
 
-  thd->inc_status_sort_merge_passes();
-  thd->query_plan_fsort_passes++;
+  if (thd)
+  {
+    thd->inc_status_sort_merge_passes();
+    thd->query_plan_fsort_passes++;
+  }
 
   error=0;
   rec_length= param->rec_length;
@@ -1652,7 +1884,7 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
 
   while (queue.elements > 1)
   {
-    if (killable && thd->check_killed())
+    if (killable && thd && thd->check_killed())
     {
       error= 1; goto err;                        /* purecov: inspected */
     }
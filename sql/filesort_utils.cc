@@ -18,6 +18,7 @@
 #include "sql_sort.h"
 #include "table.h"
 #include "my_sys.h"
+#include "mysqld.h"                             // key_thread_filesort_worker
 
 
 namespace {
@@ -123,21 +124,178 @@ void Filesort_buffer::free_sort_buffer()
 }
 
 
+namespace {
+/**
+  Sort an array of key pointers.
+
+  Sort keys are compared with memcmp(), so they can be radix sorted:
+  short keys with the LSD radix sort if scratch space of 'count'
+  pointers is given, others with the MSD radix sort when there are
+  enough of them. qsort is used otherwise, or if memory for the MSD
+  radix sort can not be allocated.
+*/
+void sort_key_pointers(uchar **keys, uint count, size_t size, uchar **buffer,
+                       myf flags)
+{
+  if (buffer && radixsort_is_appliccable(count, size))
+  {
+    radixsort_for_str_ptr(keys, count, size, buffer);
+    return;
+  }
+  if (radixsort_msd_is_appliccable(count, size) &&
+      !radixsort_msd_for_str_ptr(keys, count, size, flags))
+    return;
+  my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
+}
+
+
+/** One slice of a Filesort_buffer sorted by its own thread. */
+struct Sort_slice
+{
+  uchar *key;                                   // Current key, for QUEUE
+  uchar **pos;                                  // Position of current key
+  uchar **end;
+  uchar **buffer;                               // Scratch space for radix
+  size_t sort_length;
+};
+
+
+void sort_slice(void *arg)
+{
+  Sort_slice *slice= static_cast<Sort_slice*>(arg);
+  sort_key_pointers(slice->pos, (uint) (slice->end - slice->pos),
+                    slice->sort_length, slice->buffer, MYF(0));
+}
+
+
+struct Sort_thread
+{
+  sort_task_func func;
+  void *task;
+  pthread_t thread;
+  bool started;
+};
+}
+
+
+pthread_handler_t handle_sort_thread(void *arg)
+{
+  Sort_thread *thr= static_cast<Sort_thread*>(arg);
+  my_thread_init();
+  thr->func(thr->task);
+  my_thread_end();
+  return 0;
+}
+
+
+void run_sort_tasks(sort_task_func func, void *tasks, size_t task_size,
+                    uint count)
+{
+  Sort_thread threads[MAX_SORT_THREADS];
+  uchar *task= static_cast<uchar*>(tasks);
+  DBUG_ENTER("run_sort_tasks");
+  DBUG_ASSERT(count <= MAX_SORT_THREADS);
+
+  for (uint i= 1; i < count; i++)
+  {
+    threads[i].func= func;
+    threads[i].task= task + i * task_size;
+    threads[i].started=
+      !mysql_thread_create(key_thread_filesort_worker, &threads[i].thread,
+                           NULL, handle_sort_thread, &threads[i]);
+  }
+  func(task);
+  for (uint i= 1; i < count; i++)
+  {
+    if (threads[i].started)
+      pthread_join(threads[i].thread, NULL);
+    else
+      func(threads[i].task);                    // Out of threads, do it here
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Sort the buffer in 'threads' slices in parallel, and merge the sorted
+  slices back into the buffer.
+
+  @retval false  Could not allocate memory, nothing was done.
+*/
+
+bool Filesort_buffer::sort_buffer_parallel(const Sort_param *param,
+                                           uint count, uint threads)
+{
+  size_t size= param->sort_length;
+  Sort_slice slices[MAX_SORT_THREADS];
+  QUEUE queue;
+  uchar **keys= get_sort_keys();
+  uchar **merged;
+  DBUG_ENTER("Filesort_buffer::sort_buffer_parallel");
+  DBUG_PRINT("info", ("count: %u  threads: %u", count, threads));
+
+  if (!(merged= (uchar**) my_malloc(count * sizeof(uchar*),
+                                    MYF(MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(false);
+  if (init_queue(&queue, threads, offsetof(Sort_slice, key), 0,
+                 (queue_compare) get_ptr_compare(size), &size, 0, 0))
+  {
+    my_free(merged);
+    DBUG_RETURN(false);
+  }
+
+  uint start= 0;
+  for (uint i= 0; i < threads; i++)
+  {
+    uint end= (uint) ((ulonglong) count * (i + 1) / threads);
+    slices[i].pos= keys + start;
+    slices[i].end= keys + end;
+    /* The part of 'merged' matching the slice is free until the merge */
+    slices[i].buffer= merged + start;
+    slices[i].sort_length= size;
+    start= end;
+  }
+  run_sort_tasks(sort_slice, slices, sizeof(Sort_slice), threads);
+
+  for (uint i= 0; i < threads; i++)
+  {
+    slices[i].key= *slices[i].pos;
+    queue_insert(&queue, (uchar*) (slices + i));
+  }
+  uchar **to= merged;
+  while (queue.elements)
+  {
+    Sort_slice *slice= (Sort_slice*) queue_top(&queue);
+    *to++= slice->key;
+    if (++slice->pos == slice->end)
+      queue_remove_top(&queue);
+    else
+    {
+      slice->key= *slice->pos;
+      queue_replace_top(&queue);
+    }
+  }
+  DBUG_ASSERT(to == merged + count);
+  delete_queue(&queue);
+  memcpy(keys, merged, count * sizeof(uchar*));
+  my_free(merged);
+  DBUG_RETURN(true);
+}
+
+
 void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
 {
   size_t size= param->sort_length;
   if (count <= 1 || size == 0)
     return;
+  uint threads= MY_MIN(param->sort_threads, count / MIN_KEYS_PER_SORT_THREAD);
+  if (threads > 1 && sort_buffer_parallel(param, count, threads))
+    return;
+
   uchar **keys= get_sort_keys();
   uchar **buffer= NULL;
-  if (radixsort_is_appliccable(count, param->sort_length) &&
-      (buffer= (uchar**) my_malloc(count*sizeof(char*),
-                                   MYF(MY_THREAD_SPECIFIC))))
-  {
-    radixsort_for_str_ptr(keys, count, param->sort_length, buffer);
-    my_free(buffer);
-    return;
-  }
-  
-  my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
+  if (radixsort_is_appliccable(count, param->sort_length))
+    buffer= (uchar**) my_malloc(count*sizeof(char*), MYF(MY_THREAD_SPECIFIC));
+  sort_key_pointers(keys, count, size, buffer, MYF(MY_THREAD_SPECIFIC));
+  my_free(buffer);
 }
@@ -45,6 +45,25 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       uint    elem_size);
 
 
+/**
+  Run count tasks, each in a thread of its own, and wait for them to finish.
+
+    @param func       Function to call for each task.
+    @param tasks      Array of task arguments.
+    @param task_size  Size of each element in 'tasks'.
+    @param count      Number of tasks.
+
+  The calling thread runs the first task itself. If a thread cannot be
+  created, the task is run by the calling thread instead, so all tasks
+  are always done when the function returns.
+  The tasks must not use the THD of the caller.
+*/
+
+typedef void (*sort_task_func)(void *task);
+void run_sort_tasks(sort_task_func func, void *tasks, size_t task_size,
+                    uint count);
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The buffer is a contiguous chunk of memory,
@@ -119,6 +138,9 @@ class Filesort_buffer
   }
 
 private:
+  bool sort_buffer_parallel(const Sort_param *param, uint count,
+                            uint threads);
+
   typedef Bounds_checked_array<uchar*> Idx_array;
 
   Idx_array  m_idx_array;
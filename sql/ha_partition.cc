@@ -77,6 +77,7 @@
                                         HA_DUPLICATE_POS | \
                                         HA_CAN_SQL_HANDLER | \
                                         HA_CAN_INSERT_DELAYED | \
+                                        HA_CAN_PARALLEL_SCAN | \
                                         HA_READ_BEFORE_WRITE_REMOVAL)
 static const char *ha_par_ext= ".par";
 
@@ -258,6 +258,13 @@ enum enum_alter_inplace_result {
 */
 #define HA_CONCURRENT_OPTIMIZE          (1LL << 46)
 
+/*
+  Clones of the handler (see handler::clone()) can read the table in other
+  threads, concurrently with each other, while the table is locked by the
+  thread that owns the original handler. Used by parallel scans.
+*/
+#define HA_CAN_PARALLEL_SCAN            (1LL << 47)
+
 /*
   Set of all binlog flags. Currently only contain the capabilities
   flags.
@@ -3999,6 +4006,7 @@ class handler :public Sql_alloc
                          enum ha_rkey_function find_flag)
    { return  HA_ERR_WRONG_COMMAND; }
   friend class ha_partition;
+  friend class Parallel_scan;
 public:
   /**
     This method is similar to update_row, however the handler doesn't need
@@ -1408,6 +1408,28 @@ bool Item_sum_sum::add()
 }
 
 
+/**
+  Add the sum of the argument over rows aggregated elsewhere.
+
+  Used by parallel scans (see sql_parallel_scan.cc), which compute
+  partial sums of an integer argument in several threads.
+
+  @param rows         Number of rows with a not NULL argument
+  @param partial_sum  Sum of the argument over these rows
+*/
+
+void Item_sum_sum::merge_sum(ulonglong rows, const my_decimal *partial_sum)
+{
+  DBUG_ASSERT(hybrid_type == DECIMAL_RESULT);
+  if (!rows)
+    return;
+  my_decimal_add(E_DEC_FATAL_ERROR, dec_buffs + (curr_dec_buff^1),
+                 partial_sum, dec_buffs + curr_dec_buff);
+  curr_dec_buff^= 1;
+  null_value= 0;
+}
+
+
 longlong Item_sum_sum::val_int()
 {
   DBUG_ASSERT(fixed == 1);
@@ -1694,6 +1716,12 @@ bool Item_sum_avg::add()
   return FALSE;
 }
 
+void Item_sum_avg::merge_sum(ulonglong rows, const my_decimal *partial_sum)
+{
+  Item_sum_sum::merge_sum(rows, partial_sum);
+  count+= rows;
+}
+
 double Item_sum_avg::val_real()
 {
   DBUG_ASSERT(fixed == 1);
@@ -741,6 +741,7 @@ class Item_sum_sum :public Item_sum_num
   }
   void clear();
   bool add();
+  virtual void merge_sum(ulonglong rows, const my_decimal *partial_sum);
   double val_real();
   longlong val_int();
   String *val_str(String*str);
@@ -798,6 +799,8 @@ class Item_sum_count :public Item_sum_int
     count=count_arg;
     Item_sum::make_const();
   }
+  /* Add the count of rows aggregated elsewhere (by a parallel scan) */
+  void merge_count(ulonglong rows) { count+= rows; }
   longlong val_int();
   void reset_field();
   void update_field();
@@ -830,6 +833,7 @@ class Item_sum_avg :public Item_sum_sum
   }
   void clear();
   bool add();
+  void merge_sum(ulonglong rows, const my_decimal *partial_sum);
   double val_real();
   // In SPs we might force the "wrong" type with select into a declare variable
   longlong val_int() { return val_int_from_real(); }
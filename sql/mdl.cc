@@ -27,10 +27,15 @@
 
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_fast_path_tickets;
+static PSI_mutex_key key_LOCK_mdl_contexts;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_fast_path_tickets,
+    "MDL_context::LOCK_fast_path_tickets", 0},
+  { &key_LOCK_mdl_contexts, "LOCK_mdl_contexts", PSI_FLAG_GLOBAL}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -119,7 +124,8 @@ class MDL_map
 public:
   void init();
   void destroy();
-  MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
+  MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key,
+                           enum_mdl_type type, bool *fast_path);
   unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
   void remove(LF_PINS *pins, MDL_lock *lock);
   LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
@@ -293,6 +299,22 @@ class MDL_lock
 {
 public:
   typedef unsigned short bitmap_t;
+  typedef int64 fast_path_state_t;
+
+  /**
+    Layout of m_fast_path_state. The low bits hold three 20-bit counters
+    of "unobtrusive" locks granted on the fast path (which counter is used
+    for which lock type is defined by MDL_lock_strategy), the high bits
+    hold flags which are changed under protection of m_rwlock.
+  */
+  static const fast_path_state_t FAST_PATH_COUNTER_MAX= (1LL << 20) - 1;
+  static const fast_path_state_t FAST_PATH_COUNTERS= (1LL << 60) - 1;
+  /** There are obtrusive locks in either granted or waiting queue. */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1LL << 60;
+  /** Either granted or waiting queue is not empty. */
+  static const fast_path_state_t HAS_SLOW_PATH= 1LL << 61;
+  /** The object is being removed from MDL_map and must not be used. */
+  static const fast_path_state_t IS_DESTROYED= 1LL << 62;
 
   class Ticket_list
   {
@@ -336,6 +358,13 @@ class MDL_lock
     virtual bool needs_notification(const MDL_ticket *ticket) const = 0;
     virtual bool conflicting_locks(const MDL_ticket *ticket) const = 0;
     virtual bitmap_t hog_lock_types_bitmap() const = 0;
+    /**
+      Value by which m_fast_path_state is incremented when lock of the
+      type is granted on the fast path, 0 for obtrusive lock types.
+    */
+    virtual fast_path_state_t unobtrusive_lock_increment(enum_mdl_type type)
+      const = 0;
+    virtual bitmap_t obtrusive_lock_types_bitmap() const = 0;
     virtual ~MDL_lock_strategy() {}
   };
 
@@ -372,6 +401,16 @@ class MDL_lock
     */
     virtual bitmap_t hog_lock_types_bitmap() const
     { return 0; }
+
+    /*
+      IX locks acquired by every statement changing data are compatible
+      with each other and thus can be granted on the fast path.
+    */
+    virtual fast_path_state_t unobtrusive_lock_increment(enum_mdl_type type)
+      const
+    { return type == MDL_INTENTION_EXCLUSIVE ? 1 : 0; }
+    virtual bitmap_t obtrusive_lock_types_bitmap() const
+    { return MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_EXCLUSIVE); }
   private:
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
@@ -415,7 +454,24 @@ class MDL_lock
               MDL_BIT(MDL_EXCLUSIVE));
     }
 
+    /*
+      S, SH, SR and SW locks used by DML are compatible with each other
+      and thus can be granted on the fast path. S and SH locks have the
+      same compatibility with other types, so they share a counter.
+    */
+    virtual fast_path_state_t unobtrusive_lock_increment(enum_mdl_type type)
+      const
+    { return m_unobtrusive_lock_increment[type]; }
+    virtual bitmap_t obtrusive_lock_types_bitmap() const
+    {
+      return (MDL_BIT(MDL_SHARED_UPGRADABLE) |
+              MDL_BIT(MDL_SHARED_NO_WRITE) |
+              MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+              MDL_BIT(MDL_EXCLUSIVE));
+    }
+
   private:
+    static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
     static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
     static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
   };
@@ -458,11 +514,40 @@ class MDL_lock
   */
   mysql_prlock_t m_rwlock;
 
+  /**
+    Counters of unobtrusive locks granted on the fast path, i.e. without
+    taking m_rwlock and adding tickets to m_granted, and flags telling
+    when the fast path can't be used. See FAST_PATH_COUNTERS and below.
+
+    An unobtrusive lock is granted on the fast path by atomically
+    incrementing its counter, unless HAS_OBTRUSIVE or IS_DESTROYED is
+    set. Obtrusive lock requests set HAS_OBTRUSIVE under m_rwlock before
+    checking compatibility, which forces concurrent unobtrusive requests
+    to the slow path until all obtrusive locks are gone.
+  */
+  volatile fast_path_state_t m_fast_path_state;
+
   bool is_empty() const
   {
     return (m_granted.is_empty() && m_waiting.is_empty());
   }
 
+  fast_path_state_t get_fast_path_state() const
+  {
+    return my_atomic_load64(
+             const_cast<volatile fast_path_state_t*>(&m_fast_path_state));
+  }
+
+  fast_path_state_t unobtrusive_lock_increment(enum_mdl_type type) const
+  { return m_strategy->unobtrusive_lock_increment(type); }
+
+  bitmap_t fast_path_granted_bitmap() const;
+  void sync_fast_path_flags();
+  void set_has_obtrusive();
+  bool fast_path_acquire(enum_mdl_type type);
+  void materialize_fast_path_ticket(MDL_ticket *ticket);
+  void remove_fast_path_ticket(LF_PINS *pins, MDL_ticket *ticket);
+
   const bitmap_t *incompatible_granted_types_bitmap() const
   { return m_strategy->incompatible_granted_types_bitmap(); }
   const bitmap_t *incompatible_waiting_types_bitmap() const
@@ -520,12 +605,14 @@ class MDL_lock
 public:
 
   MDL_lock()
-    : m_hog_lock_count(0),
+    : m_fast_path_state(0),
+      m_hog_lock_count(0),
       m_strategy(0)
   { mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock); }
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
+    m_fast_path_state(0),
     m_hog_lock_count(0),
     m_strategy(&m_scoped_lock_strategy)
   {
@@ -549,10 +636,20 @@ class MDL_lock
     DBUG_ASSERT(key_arg->mdl_namespace() != MDL_key::GLOBAL &&
                 key_arg->mdl_namespace() != MDL_key::COMMIT);
     new (&lock->key) MDL_key(key_arg);
-    if (key_arg->mdl_namespace() == MDL_key::SCHEMA)
-      lock->m_strategy= &m_scoped_lock_strategy;
-    else
-      lock->m_strategy= &m_object_lock_strategy;
+    lock->m_fast_path_state= 0;
+    lock->m_strategy= get_strategy(key_arg);
+  }
+
+  static const MDL_lock_strategy *get_strategy(const MDL_key *key_arg)
+  {
+    switch (key_arg->mdl_namespace()) {
+    case MDL_key::GLOBAL:
+    case MDL_key::SCHEMA:
+    case MDL_key::COMMIT:
+      return &m_scoped_lock_strategy;
+    default:
+      return &m_object_lock_strategy;
+    }
   }
 
   const MDL_lock_strategy *m_strategy;
@@ -569,6 +666,20 @@ const MDL_lock::MDL_object_lock MDL_lock::m_object_lock_strategy;
 static MDL_map mdl_locks;
 
 
+typedef I_P_List<MDL_context,
+                 I_P_List_adapter<MDL_context,
+                                  &MDL_context::next_in_registry,
+                                  &MDL_context::prev_in_registry> >
+        MDL_context_list;
+
+/**
+  All contexts which might own locks granted on the fast path, i.e.
+  which have allocated pins. Allows mdl_iterate() to find such locks.
+*/
+static MDL_context_list mdl_contexts;
+static mysql_mutex_t LOCK_mdl_contexts;
+
+
 extern "C"
 {
 static uchar *
@@ -603,6 +714,8 @@ void mdl_init()
 #endif
 
   mdl_locks.init();
+  mysql_mutex_init(key_LOCK_mdl_contexts, &LOCK_mdl_contexts,
+                   MY_MUTEX_INIT_FAST);
 }
 
 
@@ -619,6 +732,8 @@ void mdl_destroy()
   {
     mdl_initialized= FALSE;
     mdl_locks.destroy();
+    DBUG_ASSERT(mdl_contexts.is_empty());
+    mysql_mutex_destroy(&LOCK_mdl_contexts);
   }
 }
 
@@ -662,6 +777,27 @@ int mdl_iterate(int (*callback)(MDL_ticket *ticket, void *arg), void *arg)
                          (my_hash_walk_action) mdl_iterate_lock, &argument);
     lf_hash_put_pins(pins);
   }
+
+  /* Locks granted on the fast path are only known to their contexts. */
+  if (!res)
+  {
+    MDL_context *ctx;
+
+    mysql_mutex_lock(&LOCK_mdl_contexts);
+    MDL_context_list::Iterator ctx_it(mdl_contexts);
+    while (!res && (ctx= ctx_it++))
+    {
+      MDL_ticket *ticket;
+
+      mysql_mutex_lock(&ctx->m_LOCK_fast_path_tickets);
+      MDL_context::Fast_path_ticket_list::Iterator
+        ticket_it(ctx->m_fast_path_tickets);
+      while ((ticket= ticket_it++) && !(res= callback(ticket, arg)))
+        /* no-op */;
+      mysql_mutex_unlock(&ctx->m_LOCK_fast_path_tickets);
+    }
+    mysql_mutex_unlock(&LOCK_mdl_contexts);
+  }
   DBUG_RETURN(res);
 }
 
@@ -712,12 +848,21 @@ void MDL_map::destroy()
   Find MDL_lock object corresponding to the key, create it
   if it does not exist.
 
+  @param          pins       Pins for MDL_map::m_locks.
+  @param          mdl_key    The key of the lock.
+  @param          type       Type of the lock being requested.
+  @param[in,out]  fast_path  In: whether the lock can be granted on the
+                             fast path. Out: whether it has been granted
+                             on the fast path.
+
   @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
+                     locked MDL_lock::m_rwlock, or with the lock
+                     granted if *fast_path is set.
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
+MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key,
+                                  enum_mdl_type type, bool *fast_path)
 {
   MDL_lock *lock;
 
@@ -738,6 +883,10 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
     lock= (mdl_key->mdl_namespace() == MDL_key::GLOBAL) ? m_global_lock :
                                                           m_commit_lock;
 
+    if (*fast_path && lock->fast_path_acquire(type))
+      return lock;
+
+    *fast_path= false;
     mysql_prlock_wrlock(&lock->m_rwlock);
 
     return lock;
@@ -749,6 +898,12 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
     if (lf_hash_insert(&m_locks, pins, (uchar*) mdl_key) == -1)
       return NULL;
 
+  if (*fast_path && lock->fast_path_acquire(type))
+  {
+    lf_hash_search_unpin(pins);
+    return lock;
+  }
+
   mysql_prlock_wrlock(&lock->m_rwlock);
   if (unlikely(!lock->m_strategy))
   {
@@ -757,6 +912,7 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
     goto retry;
   }
   lf_hash_search_unpin(pins);
+  *fast_path= false;
 
   return lock;
 }
@@ -805,10 +961,15 @@ MDL_map::get_lock_owner(LF_PINS *pins, const MDL_key *mdl_key)
   Destroy MDL_lock object or delegate this responsibility to
   whatever thread that holds the last outstanding reference to
   it.
+
+  @pre MDL_lock::m_rwlock is write-locked, granted and waiting queues
+       are empty. The lock is unlocked on return.
 */
 
 void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
 {
+  MDL_lock::fast_path_state_t old_state= 0;
+
   if (lock->key.mdl_namespace() == MDL_key::GLOBAL ||
       lock->key.mdl_namespace() == MDL_key::COMMIT)
   {
@@ -820,6 +981,17 @@ void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
     return;
   }
 
+  /*
+    Locks may still be granted on the fast path without m_rwlock.
+    The last of them will destroy the object when released.
+  */
+  if (!my_atomic_cas64(&lock->m_fast_path_state, &old_state,
+                       MDL_lock::IS_DESTROYED))
+  {
+    mysql_prlock_unlock(&lock->m_rwlock);
+    return;
+  }
+
   lock->m_strategy= 0;
   mysql_prlock_unlock(&lock->m_rwlock);
   lf_hash_delete(&m_locks, pins, lock->key.ptr(), lock->key.length());
@@ -840,6 +1012,8 @@ MDL_context::MDL_context()
   m_pins(NULL)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  mysql_mutex_init(key_MDL_context_LOCK_fast_path_tickets,
+                   &m_LOCK_fast_path_tickets, MY_MUTEX_INIT_FAST);
 }
 
 
@@ -860,16 +1034,35 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_STATEMENT].is_empty());
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
+  DBUG_ASSERT(m_fast_path_tickets.is_empty());
 
   mysql_prlock_destroy(&m_LOCK_waiting_for);
   if (m_pins)
+  {
+    mysql_mutex_lock(&LOCK_mdl_contexts);
+    mdl_contexts.remove(this);
+    mysql_mutex_unlock(&LOCK_mdl_contexts);
     lf_hash_put_pins(m_pins);
+  }
+  mysql_mutex_destroy(&m_LOCK_fast_path_tickets);
 }
 
 
+/**
+  Allocate pins for MDL_map, if not allocated yet, and register the
+  context in the list of contexts which can acquire locks.
+*/
+
 bool MDL_context::fix_pins()
 {
-  return m_pins ? false : (m_pins= mdl_locks.get_pins()) == 0;
+  if (m_pins)
+    return false;
+  if (!(m_pins= mdl_locks.get_pins()))
+    return true;
+  mysql_mutex_lock(&LOCK_mdl_contexts);
+  mdl_contexts.push_front(this);
+  mysql_mutex_unlock(&LOCK_mdl_contexts);
+  return false;
 }
 
 
@@ -1514,6 +1707,19 @@ MDL_lock::MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END]=
 };
 
 
+/**
+  Increments of MDL_lock::m_fast_path_state for per-object locks granted
+  on the fast path. S and SH locks use the first counter, SR and SW locks
+  use the second and the third one. Obtrusive types have 0 here.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_lock::MDL_object_lock::m_unobtrusive_lock_increment[MDL_TYPE_END]=
+{
+  0, 1, 1, 1LL << 20, 1LL << 40, 0, 0, 0, 0
+};
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1549,7 +1755,15 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+    {
+      /*
+        Locks granted on the fast path belong to other contexts: unobtrusive
+        locks are compatible with each other, and requestor has moved its
+        own locks to m_granted before asking for an obtrusive one.
+      */
+    }
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1634,6 +1848,7 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
+  sync_fast_path_flags();
   if (is_empty())
     mdl_locks.remove(pins, this);
   else
@@ -1658,6 +1873,168 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 }
 
 
+/**
+  Return bitmap of types of locks granted on the fast path.
+*/
+
+MDL_lock::bitmap_t MDL_lock::fast_path_granted_bitmap() const
+{
+  fast_path_state_t counters= get_fast_path_state() & FAST_PATH_COUNTERS;
+  bitmap_t result= 0;
+
+  if (counters)
+  {
+    for (uint i= 0; i < MDL_TYPE_END; i++)
+    {
+      fast_path_state_t unit= unobtrusive_lock_increment((enum_mdl_type) i);
+      if (counters & (unit * FAST_PATH_COUNTER_MAX))
+        result|= MDL_BIT(i);
+    }
+  }
+  return result;
+}
+
+
+/**
+  Bring HAS_SLOW_PATH and HAS_OBTRUSIVE flags in m_fast_path_state in
+  sync with the granted and waiting queues.
+
+  @pre m_rwlock is write-locked. Must be called every time the queues
+       are changed.
+*/
+
+void MDL_lock::sync_fast_path_flags()
+{
+  fast_path_state_t flags= 0;
+  fast_path_state_t old_state;
+
+  if (!is_empty())
+    flags|= HAS_SLOW_PATH;
+  if ((m_granted.bitmap() | m_waiting.bitmap()) &
+      m_strategy->obtrusive_lock_types_bitmap())
+    flags|= HAS_OBTRUSIVE;
+
+  old_state= get_fast_path_state();
+  do
+  {
+    if ((old_state & (HAS_SLOW_PATH | HAS_OBTRUSIVE)) == flags)
+      break;
+  } while (!my_atomic_cas64(&m_fast_path_state, &old_state,
+                            (old_state & ~(HAS_SLOW_PATH | HAS_OBTRUSIVE)) |
+                            flags));
+}
+
+
+/**
+  Stop granting locks on the fast path, as an obtrusive lock is being
+  requested. Must be done before checking whether the obtrusive lock
+  is compatible with the locks granted on the fast path.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::set_has_obtrusive()
+{
+  fast_path_state_t old_state= get_fast_path_state();
+  do
+  {
+    if (old_state & HAS_OBTRUSIVE)
+      break;
+  } while (!my_atomic_cas64(&m_fast_path_state, &old_state,
+                            old_state | HAS_OBTRUSIVE));
+}
+
+
+/**
+  Try to grant an unobtrusive lock on the fast path, i.e. by incrementing
+  its counter in m_fast_path_state without taking m_rwlock.
+
+  @pre The object is pinned (or is one of the pre-allocated ones).
+
+  @retval TRUE   The lock has been granted.
+  @retval FALSE  The lock type is obtrusive, there are obtrusive locks or
+                 the object is being destroyed. Slow path must be used.
+*/
+
+bool MDL_lock::fast_path_acquire(enum_mdl_type type)
+{
+  /*
+    m_strategy is reset when the object is destroyed, but IS_DESTROYED
+    is set before that, so it is enough to check it below.
+  */
+  const MDL_lock_strategy *strategy= m_strategy;
+  fast_path_state_t unit, old_state;
+
+  if (!strategy || !(unit= strategy->unobtrusive_lock_increment(type)))
+    return false;
+
+  old_state= get_fast_path_state();
+  do
+  {
+    if (old_state & (HAS_OBTRUSIVE | IS_DESTROYED))
+      return false;
+    DBUG_ASSERT(((old_state / unit) & FAST_PATH_COUNTER_MAX) <
+                FAST_PATH_COUNTER_MAX);
+  } while (!my_atomic_cas64(&m_fast_path_state, &old_state,
+                            old_state + unit));
+  return true;
+}
+
+
+/**
+  Move a ticket for the lock granted on the fast path to the granted
+  queue, making it visible to other contexts.
+*/
+
+void MDL_lock::materialize_fast_path_ticket(MDL_ticket *ticket)
+{
+  mysql_prlock_wrlock(&m_rwlock);
+  m_granted.add_ticket(ticket);
+  /* HAS_SLOW_PATH must be set before the counter is decremented. */
+  sync_fast_path_flags();
+  my_atomic_add64(&m_fast_path_state,
+                  -unobtrusive_lock_increment(ticket->get_type()));
+  mysql_prlock_unlock(&m_rwlock);
+}
+
+
+/**
+  Release the lock granted on the fast path.
+
+  Normally it is just a decrement of the counter. m_rwlock is taken
+  only if there are obtrusive locks, which might wait for this one,
+  or if this was the last lock and the object is to be destroyed.
+*/
+
+void MDL_lock::remove_fast_path_ticket(LF_PINS *pins, MDL_ticket *ticket)
+{
+  fast_path_state_t unit= unobtrusive_lock_increment(ticket->get_type());
+  fast_path_state_t old_state= get_fast_path_state();
+  bool can_be_destroyed= key.mdl_namespace() != MDL_key::GLOBAL &&
+                         key.mdl_namespace() != MDL_key::COMMIT;
+
+  do
+  {
+    if ((old_state & HAS_OBTRUSIVE) ||
+        (old_state == unit && can_be_destroyed))
+    {
+      mysql_prlock_wrlock(&m_rwlock);
+      old_state= my_atomic_add64(&m_fast_path_state, -unit);
+      if (old_state == unit)
+        mdl_locks.remove(pins, this);
+      else
+      {
+        if (old_state & HAS_OBTRUSIVE)
+          reschedule_waiters();
+        mysql_prlock_unlock(&m_rwlock);
+      }
+      return;
+    }
+  } while (!my_atomic_cas64(&m_fast_path_state, &old_state,
+                            old_state - unit));
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -1805,8 +2182,10 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       We can't get here if we allocated a new lock object so there
       is no need to release it.
     */
-    DBUG_ASSERT(! ticket->m_lock->is_empty());
-    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+    MDL_lock *lock= ticket->m_lock;
+    DBUG_ASSERT(! lock->is_empty() || lock->fast_path_granted_bitmap());
+    lock->sync_fast_path_flags();
+    mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
 
@@ -1838,6 +2217,7 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
   enum_mdl_duration found_duration;
+  bool is_obtrusive, fast_path;
 
   DBUG_ASSERT(mdl_request->type != MDL_EXCLUSIVE ||
               is_lock_owner(MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE));
@@ -1886,6 +2266,27 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   if (fix_pins())
     return TRUE;
 
+  is_obtrusive= !MDL_lock::get_strategy(key)->
+                   unobtrusive_lock_increment(mdl_request->type);
+  if (is_obtrusive)
+  {
+    /*
+      Obtrusive lock is checked against locks granted on the fast path,
+      which are all assumed to belong to other contexts.
+    */
+    materialize_fast_path_locks();
+    fast_path= false;
+  }
+  else
+  {
+    /*
+      Contexts which might need to be notified about conflicting requests
+      must be visible in granted queues. Also keep all tickets there when
+      Galera is on, as wsrep code aborts conflicting granted tickets.
+    */
+    fast_path= !m_needs_thr_lock_abort && !WSREP_ON;
+  }
+
   if (!(ticket= MDL_ticket::create(this, mdl_request->type
 #ifndef DBUG_OFF
                                    , mdl_request->duration
@@ -1893,8 +2294,12 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
-  /* The below call implicitly locks MDL_lock::m_rwlock on success. */
-  if (!(lock= mdl_locks.find_or_insert(m_pins, key)))
+  /*
+    The below call implicitly locks MDL_lock::m_rwlock on success,
+    unless the lock is granted on the fast path.
+  */
+  if (!(lock= mdl_locks.find_or_insert(m_pins, key, mdl_request->type,
+                                       &fast_path)))
   {
     MDL_ticket::destroy(ticket);
     return TRUE;
@@ -1902,9 +2307,26 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  if (fast_path)
+  {
+    ticket->m_is_fast_path= true;
+    mysql_mutex_lock(&m_LOCK_fast_path_tickets);
+    m_fast_path_tickets.push_front(ticket);
+    mysql_mutex_unlock(&m_LOCK_fast_path_tickets);
+
+    m_tickets[mdl_request->duration].push_front(ticket);
+
+    mdl_request->ticket= ticket;
+    return FALSE;
+  }
+
+  if (is_obtrusive)
+    lock->set_has_obtrusive();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
+    lock->sync_fast_path_flags();
 
     mysql_prlock_unlock(&lock->m_rwlock);
 
@@ -1968,6 +2390,7 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
 
   mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
   ticket->m_lock->m_granted.add_ticket(ticket);
+  ticket->m_lock->sync_fast_path_flags();
   mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
 
   m_tickets[mdl_request->duration].push_front(ticket);
@@ -2020,6 +2443,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
   lock= ticket->m_lock;
 
   lock->m_waiting.add_ticket(ticket);
+  lock->sync_fast_path_flags();
 
   /*
     Once we added a pending ticket to the waiting queue,
@@ -2243,6 +2667,7 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   DBUG_ASSERT(mdl_ticket->m_type == MDL_SHARED_UPGRADABLE ||
               mdl_ticket->m_type == MDL_SHARED_NO_WRITE ||
               mdl_ticket->m_type == MDL_SHARED_NO_READ_WRITE);
+  DBUG_ASSERT(!mdl_ticket->m_is_fast_path);
 
   mdl_xlock_request.init(&mdl_ticket->m_lock->key, new_type,
                          MDL_TRANSACTION);
@@ -2264,6 +2689,7 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
   mdl_ticket->m_type= new_type;
   mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  mdl_ticket->m_lock->sync_fast_path_flags();
 
   mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
 
@@ -2541,7 +2967,15 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   DBUG_ASSERT(this == ticket->get_ctx());
 
-  lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    mysql_mutex_lock(&m_LOCK_fast_path_tickets);
+    m_fast_path_tickets.remove(ticket);
+    mysql_mutex_unlock(&m_LOCK_fast_path_tickets);
+    lock->remove_fast_path_ticket(m_pins, ticket);
+  }
+  else
+    lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2550,6 +2984,32 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 }
 
 
+/**
+  Move tickets for locks granted on the fast path to the granted queues
+  of the corresponding MDL_lock objects, where they can be seen by other
+  contexts (e.g. by the deadlock detector or notify_conflicting_locks()).
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  Fast_path_ticket_list tickets;
+  MDL_ticket *ticket;
+
+  if (m_fast_path_tickets.is_empty())
+    return;
+
+  mysql_mutex_lock(&m_LOCK_fast_path_tickets);
+  tickets.swap(m_fast_path_tickets);
+  mysql_mutex_unlock(&m_LOCK_fast_path_tickets);
+
+  while ((ticket= tickets.pop_front()))
+  {
+    ticket->m_is_fast_path= false;
+    ticket->m_lock->materialize_fast_path_ticket(ticket);
+  }
+}
+
+
 /**
   Release lock with explicit duration.
 
@@ -2645,6 +3105,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   /* Only allow downgrade from EXCLUSIVE and SHARED_NO_WRITE. */
   DBUG_ASSERT(m_type == MDL_EXCLUSIVE ||
               m_type == MDL_SHARED_NO_WRITE);
+  DBUG_ASSERT(!m_is_fast_path);
 
   mysql_prlock_wrlock(&m_lock->m_rwlock);
   /*
@@ -2654,6 +3115,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->sync_fast_path_flags();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
@@ -627,7 +627,8 @@ class MDL_ticket : public MDL_wait_for_subgraph
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -656,6 +657,15 @@ class MDL_ticket : public MDL_wait_for_subgraph
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock was granted on the fast path, i.e. the ticket is
+    accounted for in MDL_lock::m_fast_path_state instead of being
+    present in MDL_lock::m_granted. Such tickets are linked into
+    MDL_context::m_fast_path_tickets through next_in_lock/prev_in_lock.
+    Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -750,6 +760,12 @@ class MDL_context
 
   typedef Ticket_list::Iterator Ticket_iterator;
 
+  typedef I_P_List<MDL_ticket,
+                   I_P_List_adapter<MDL_ticket,
+                                    &MDL_ticket::next_in_lock,
+                                    &MDL_ticket::prev_in_lock> >
+          Fast_path_ticket_list;
+
   MDL_context();
   void destroy();
 
@@ -824,6 +840,12 @@ class MDL_context
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+    /*
+      Conflicting lock requests notify such contexts by looking through
+      granted queues, so they can't keep locks on the fast path.
+    */
+    if (needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -920,6 +942,18 @@ class MDL_context
    */
   MDL_wait_for_subgraph *m_waiting_for;
   LF_PINS *m_pins;
+  /**
+    Tickets for locks acquired on the fast path, linked through
+    MDL_ticket::next_in_lock. Changed only by the owner of the context,
+    but under protection of m_LOCK_fast_path_tickets so that mdl_iterate()
+    can inspect them.
+  */
+  Fast_path_ticket_list m_fast_path_tickets;
+  mysql_mutex_t m_LOCK_fast_path_tickets;
+public:
+  /** Links in the list of all contexts which have allocated pins. */
+  MDL_context *next_in_registry;
+  MDL_context **prev_in_registry;
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
@@ -928,6 +962,7 @@ class MDL_context
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
   bool fix_pins();
+  void materialize_fast_path_locks();
 
 public:
   THD *get_thd() const { return m_owner->get_thd(); }
@@ -941,6 +976,12 @@ class MDL_context
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /*
+      Locks granted on the fast path are invisible to the deadlock
+      detector, so make them visible before we become a node in the
+      wait-for graph.
+    */
+    materialize_fast_path_locks();
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -967,6 +1008,7 @@ class MDL_context
 
   /* metadata_lock_info plugin */
   friend int i_s_metadata_lock_info_fill_row(MDL_ticket*, void*);
+  friend int mdl_iterate(int (*)(MDL_ticket *, void *), void *);
 };
 
 
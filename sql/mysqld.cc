@@ -668,26 +668,10 @@ Le_creator le_creator;
 MYSQL_FILE *bootstrap_file;
 int bootstrap_error;
 
-I_List<THD> threads;
 Rpl_filter* cur_rpl_filter;
 Rpl_filter* global_rpl_filter;
 Rpl_filter* binlog_filter;
 
-THD *first_global_thread()
-{
-  if (threads.is_empty())
-    return NULL;
-  return threads.head();
-}
-
-THD *next_global_thread(THD *thd)
-{
-  if (threads.is_last(thd))
-    return NULL;
-  struct ilink *next= thd->next;
-  return static_cast<THD*>(next);
-}
-
 struct system_variables global_system_variables;
 struct system_variables max_system_variables;
 struct system_status_var global_status_var;
@@ -878,8 +862,8 @@ PSI_mutex_key key_BINLOG_LOCK_index, key_BINLOG_LOCK_xid_list,
   key_LOCK_manager,
   key_LOCK_prepared_stmt_count,
   key_LOCK_rpl_status, key_LOCK_server_started,
-  key_LOCK_status, key_LOCK_show_status,
-  key_LOCK_system_variables_hash, key_LOCK_thd_data,
+  key_LOCK_status, key_LOCK_status_partition, key_LOCK_show_status,
+  key_LOCK_system_variables_hash, key_LOCK_thd_data, key_LOCK_thd_list,
   key_LOCK_user_conn, key_LOCK_uuid_short_generator, key_LOG_LOCK_log,
   key_master_info_data_lock, key_master_info_run_lock,
   key_master_info_sleep_lock,
@@ -940,6 +924,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_rpl_status, "LOCK_rpl_status", PSI_FLAG_GLOBAL},
   { &key_LOCK_server_started, "LOCK_server_started", PSI_FLAG_GLOBAL},
   { &key_LOCK_status, "LOCK_status", PSI_FLAG_GLOBAL},
+  { &key_LOCK_status_partition, "LOCK_status_partition", 0},
   { &key_LOCK_show_status, "LOCK_show_status", PSI_FLAG_GLOBAL},
   { &key_LOCK_system_variables_hash, "LOCK_system_variables_hash", PSI_FLAG_GLOBAL},
   { &key_LOCK_stats, "LOCK_stats", PSI_FLAG_GLOBAL},
@@ -950,6 +935,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_wait_commit, "wait_for_commit::LOCK_wait_commit", 0},
   { &key_LOCK_gtid_waiting, "gtid_waiting::LOCK_gtid_waiting", 0},
   { &key_LOCK_thd_data, "THD::LOCK_thd_data", 0},
+  { &key_LOCK_thd_list, "THD_list::lock", 0},
   { &key_LOCK_user_conn, "LOCK_user_conn", PSI_FLAG_GLOBAL},
   { &key_LOCK_uuid_short_generator, "LOCK_uuid_short_generator", PSI_FLAG_GLOBAL},
   { &key_LOG_LOCK_log, "LOG::LOCK_log", 0},
@@ -1081,7 +1067,8 @@ static PSI_cond_info all_server_conds[]=
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand,
-  key_thread_slave_init, key_rpl_parallel_thread;
+  key_thread_slave_init, key_rpl_parallel_thread,
+  key_thread_filesort_worker;
 
 static PSI_thread_info all_server_threads[]=
 {
@@ -1108,7 +1095,8 @@ static PSI_thread_info all_server_threads[]=
   { &key_thread_one_connection, "one_connection", 0},
   { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL},
   { &key_thread_slave_init, "slave_init", PSI_FLAG_GLOBAL},
-  { &key_rpl_parallel_thread, "rpl_parallel_thread", 0}
+  { &key_rpl_parallel_thread, "rpl_parallel_thread", 0},
+  { &key_thread_filesort_worker, "filesort_worker", 0}
 };
 
 #ifdef HAVE_MMAP
@@ -1436,7 +1424,8 @@ int deny_severity = LOG_WARNING;
 #endif
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
-Query_cache query_cache;
+uint query_cache_instances;
+Query_cache_instances query_cache;
 #endif
 #ifdef HAVE_SMEM
 char *shared_memory_base_name= default_shared_memory_base_name;
@@ -1634,9 +1623,7 @@ static void close_connections(void)
   */
 
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -1677,7 +1664,6 @@ static void close_connections(void)
     }
     mysql_mutex_unlock(&tmp->LOCK_thd_data);
   }
-  mysql_mutex_unlock(&LOCK_thread_count); // For unlink from list
 
   Events::deinit();
   end_slave();
@@ -1707,14 +1693,11 @@ static void close_connections(void)
 
   for (;;)
   {
-    DBUG_PRINT("quit",("Locking LOCK_thread_count"));
-    mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-    if (!(tmp=threads.get()))
-    {
-      DBUG_PRINT("quit",("Unlocking LOCK_thread_count"));
-      mysql_mutex_unlock(&LOCK_thread_count);
+    THD_list_iterator it(server_threads);
+    if (!(tmp=it++))
       break;
-    }
+    /* Take it off the list, under the partition lock held by 'it' */
+    tmp->unlink();
 #ifndef __bsdi__				// Bug in BSDI kernel
     if (tmp->vio_ok())
     {
@@ -1754,8 +1737,6 @@ static void close_connections(void)
       }
     }
 #endif
-    DBUG_PRINT("quit",("Unlocking LOCK_thread_count"));
-    mysql_mutex_unlock(&LOCK_thread_count);
   }
   /* All threads has now been aborted */
   DBUG_PRINT("quit",("Waiting for threads to die (count=%u)",thread_count));
@@ -2227,8 +2208,10 @@ static void clean_up_mutexes()
   DBUG_ENTER("clean_up_mutexes");
   mysql_rwlock_destroy(&LOCK_grant);
   mysql_mutex_destroy(&LOCK_thread_count);
+  server_threads.destroy();
   mysql_mutex_destroy(&LOCK_thread_cache);
   mysql_mutex_destroy(&LOCK_status);
+  destroy_status_var_partitions();
   mysql_mutex_destroy(&LOCK_show_status);
   mysql_mutex_destroy(&LOCK_delayed_insert);
   mysql_mutex_destroy(&LOCK_delayed_status);
@@ -2844,9 +2827,7 @@ void dec_connection_count(THD *thd)
 
 void delete_running_thd(THD *thd)
 {
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->unlink();
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.erase(thd);
 
   delete thd;
   dec_thread_running();
@@ -2899,15 +2880,13 @@ void unlink_thd(THD *thd)
 
   thd->add_status_to_global();
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->unlink();
+  server_threads.erase(thd);
   /*
     Used by binlog_reset_master.  It would be cleaner to use
     DEBUG_SYNC here, but that's not possible because the THD's debug
     sync feature has been shut down at this point.
   */
   DBUG_EXECUTE_IF("sleep_after_lock_thread_count_before_delete_thd", sleep(5););
-  mysql_mutex_unlock(&LOCK_thread_count);
 
   delete thd;
   thread_safe_decrement32(&thread_count);
@@ -2987,9 +2966,7 @@ static bool cache_thread()
       thd->start_utime= thd->thr_create_utime;
 
       /* Link thd into list of all active threads (THD's) */
-      mysql_mutex_lock(&LOCK_thread_count);
-      threads.append(thd);
-      mysql_mutex_unlock(&LOCK_thread_count);
+      server_threads.insert(thd);
       DBUG_RETURN(1);
     }
   }
@@ -4615,8 +4592,10 @@ static int init_thread_environment()
 {
   DBUG_ENTER("init_thread_environment");
   mysql_mutex_init(key_LOCK_thread_count, &LOCK_thread_count, MY_MUTEX_INIT_FAST);
+  server_threads.init();
   mysql_mutex_init(key_LOCK_thread_cache, &LOCK_thread_cache, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_status, &LOCK_status, MY_MUTEX_INIT_FAST);
+  init_status_var_partitions();
   mysql_mutex_init(key_LOCK_show_status, &LOCK_show_status, MY_MUTEX_INIT_SLOW);
   mysql_mutex_init(key_LOCK_delayed_insert,
                    &LOCK_delayed_insert, MY_MUTEX_INIT_FAST);
@@ -4901,8 +4880,7 @@ static int init_server_components()
     all things are initialized so that unireg_abort() doesn't fail
   */
   mdl_init();
-  tdc_init();
-  if (hostname_cache_init())
+  if (tdc_init() || hostname_cache_init())
     unireg_abort(1);
 
   query_cache_set_min_res_unit(query_cache_min_res_unit);
@@ -6309,7 +6287,7 @@ void handle_connection_in_main_thread(THD *thd)
 {
   mysql_mutex_assert_owner(&LOCK_thread_count);
   thread_cache_size=0;			// Safety
-  threads.append(thd);
+  server_threads.insert(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
   thd->start_utime= microsecond_interval_timer();
   do_handle_one_connection(thd);
@@ -6348,7 +6326,7 @@ void create_thread_to_handle_connection(THD *thd)
   /* Create new thread to handle connection */
   int error;
   thread_created++;
-  threads.append(thd);
+  server_threads.insert(thd);
   DBUG_PRINT("info",(("creating thread %lu"), thd->thread_id));
   thd->prior_thr_create_utime= microsecond_interval_timer();
   if ((error= mysql_thread_create(key_thread_one_connection,
@@ -6375,9 +6353,7 @@ void create_thread_to_handle_connection(THD *thd)
     net_send_error(thd, ER_CANT_CREATE_THREAD, error_message_buff, NULL);
     close_connection(thd, ER_OUT_OF_RESOURCES);
 
-    mysql_mutex_lock(&LOCK_thread_count);
-    thd->unlink();
-    mysql_mutex_unlock(&LOCK_thread_count);
+    server_threads.erase(thd);
     delete thd;
     thread_safe_decrement32(&thread_count);
     return;
@@ -7615,7 +7591,6 @@ struct my_option my_long_options[]=
   MYSQL_TO_BE_IMPLEMENTED_OPTION("eq-range-index-dive-limit"),
   MYSQL_COMPATIBILITY_OPTION("server-id-bits"),
   MYSQL_TO_BE_IMPLEMENTED_OPTION("slave-rows-search-algorithms"), // HAVE_REPLICATION
-  MYSQL_COMPATIBILITY_OPTION("table-open-cache-instances"),
   MYSQL_TO_BE_IMPLEMENTED_OPTION("slave-allow-batching"),         // HAVE_REPLICATION
   MYSQL_COMPATIBILITY_OPTION("slave-checkpoint-period"),      // HAVE_REPLICATION
   MYSQL_COMPATIBILITY_OPTION("slave-checkpoint-group"),       // HAVE_REPLICATION
@@ -8271,6 +8246,50 @@ static int show_default_keycache(THD *thd, SHOW_VAR *var, char *buff,
 }
 
 
+#ifdef HAVE_QUERY_CACHE
+static int show_query_cache(THD *thd, SHOW_VAR *var, char *buff,
+                            enum enum_var_type scope)
+{
+  struct st_data {
+    Query_cache_status stats;
+    SHOW_VAR var[9];
+  } *data;
+  SHOW_VAR *v;
+
+  data=(st_data *)buff;
+  v= data->var;
+
+  var->type= SHOW_ARRAY;
+  var->value= v;
+
+  query_cache.get_status(&data->stats);
+
+#define set_one_qcache_var(X,Y)         \
+  v->name= X;                           \
+  v->type= SHOW_LONG_NOFLUSH;           \
+  v->value= (char*) &data->stats.Y;     \
+  v++;
+
+  set_one_qcache_var("free_blocks",       free_memory_blocks);
+  set_one_qcache_var("free_memory",       free_memory);
+  set_one_qcache_var("hits",              hits);
+  set_one_qcache_var("inserts",           inserts);
+  set_one_qcache_var("lowmem_prunes",     lowmem_prunes);
+  set_one_qcache_var("not_cached",        refused);
+  set_one_qcache_var("queries_in_cache",  queries_in_cache);
+  set_one_qcache_var("total_blocks",      total_blocks);
+
+  v->name= 0;
+
+  DBUG_ASSERT((char*)(v+1) <= buff + SHOW_VAR_FUNC_BUFF_SIZE);
+
+#undef set_one_qcache_var
+
+  return 0;
+}
+#endif /* HAVE_QUERY_CACHE */
+
+
 static int show_memory_used(THD *thd, SHOW_VAR *var, char *buff,
                             struct system_status_var *status_var,
                             enum enum_var_type scope)
@@ -8427,18 +8446,13 @@ SHOW_VAR status_vars[]= {
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONG_STATUS},
   {"Opened_views",             (char*) offsetof(STATUS_VAR, opened_views), SHOW_LONG_STATUS},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_SIMPLE_FUNC},
+  {"Prepared_stmt_cache_hits", (char*) offsetof(STATUS_VAR, ps_cache_hits), SHOW_LONG_STATUS},
+  {"Prepared_stmt_plan_cache_hits", (char*) offsetof(STATUS_VAR, ps_plan_cache_hits), SHOW_LONG_STATUS},
   {"Rows_sent",                (char*) offsetof(STATUS_VAR, rows_sent), SHOW_LONGLONG_STATUS},
   {"Rows_read",                (char*) offsetof(STATUS_VAR, rows_read), SHOW_LONGLONG_STATUS},
   {"Rows_tmp_read",            (char*) offsetof(STATUS_VAR, rows_tmp_read), SHOW_LONGLONG_STATUS},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache",                   (char*) &show_query_cache, SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_SIMPLE_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONG_STATUS},
@@ -8513,6 +8527,8 @@ SHOW_VAR status_vars[]= {
 #endif
 #ifdef HAVE_POOL_OF_THREADS
   {"Threadpool_idle_threads",  (char *) &show_threadpool_idle_threads, SHOW_SIMPLE_FUNC},
+  {"Threadpool_moved_connections", (char *) &tp_stats.moved_connections, SHOW_LONGLONG},
+  {"Threadpool_stolen_events", (char *) &tp_stats.stolen_events, SHOW_LONGLONG},
   {"Threadpool_threads",       (char *) &tp_stats.num_worker_threads, SHOW_INT},
 #endif
   {"Threads_cached",           (char*) &cached_thread_count,    SHOW_LONG_NOFLUSH},
@@ -8737,7 +8753,6 @@ static int mysql_init_variables(void)
   executed_events= 0;
   global_query_id= thread_id= 1L;
   strnmov(server_version, MYSQL_SERVER_VERSION, sizeof(server_version)-1);
-  threads.empty();
   thread_cache.empty();
   key_caches.empty();
   if (!(dflt_key_cache= get_or_create_key_cache(default_key_cache_base.str,
@@ -9943,12 +9958,16 @@ void refresh_status(THD *thd)
   mysql_mutex_lock(&LOCK_status);
 
   /* Add thread's status variabes to global status */
-  add_to_status(&global_status_var, &thd->status_var);
+  add_diff_to_status(&global_status_var, &thd->status_var,
+                     &thd->published_status_var);
+  update_global_memory_status(thd->status_var.global_memory_used);
 
   /* Reset thread's status variables */
   thd->set_status_var_init();
   thd->status_var.global_memory_used= 0;
   bzero((uchar*) &thd->org_status_var, sizeof(thd->org_status_var)); 
+  bzero((uchar*) &thd->published_status_var,
+        offsetof(STATUS_VAR, last_cleared_system_status_var));
   thd->start_bytes_received= 0;
 
   /* Reset some global variables */
@@ -9960,6 +9979,9 @@ void refresh_status(THD *thd)
 
   /* Reset the counters of all key caches (default and named). */
   process_key_caches(reset_key_cache_counters, 0);
+#ifdef HAVE_QUERY_CACHE
+  query_cache.reset_status();
+#endif
   flush_status_time= time((time_t*) 0);
   mysql_mutex_unlock(&LOCK_status);
 
@@ -138,7 +138,7 @@ my_bool my_net_init(NET *net, Vio *vio, void *thd, uint my_flags)
   net->pkt_nr=net->compress_pkt_nr=0;
   net->write_pos=net->read_pos = net->buff;
   net->last_error[0]=0;
-  net->compress=0; net->reading_or_writing=0;
+  net->compress=0; net->compress_level=0; net->reading_or_writing=0;
   net->where_b = net->remain_in_buf=0;
   net->net_skip_rest_factor= 0;
   net->last_errno=0;
@@ -430,6 +430,78 @@ my_bool my_net_write(NET *net, const uchar *packet, size_t len)
 }
 
 
+#ifdef MYSQL_SERVER
+/**
+  Write a logical packet that is in several buffers to the network.
+
+  Works like my_net_write() for the concatenation of the buffers, but
+  without copying them to one buffer first. Buffers that are longer than
+  the net buffer are sent directly from their own memory by
+  net_write_buff().
+
+  @param net    NET handler
+  @param parts  buffers of the packet, in order
+  @param count  number of buffers
+
+  @return
+    @retval 0   ok
+    @retval 1   error
+*/
+
+my_bool my_net_write_parts(NET *net, const NET_PART *parts, uint count)
+{
+  uchar buff[NET_HEADER_SIZE];
+  size_t len= 0, left= 0;
+  const uchar *pos= 0;
+  uint i;
+  int rc= 0;
+
+  if (unlikely(!net->vio)) /* nowhere to write */
+    return 0;
+
+  for (i= 0; i < count; i++)
+    len+= parts[i].length;
+
+  MYSQL_NET_WRITE_START(len);
+
+  /*
+    Split in packets of MAX_PACKET_LENGTH like my_net_write(). The last
+    packet is always < MAX_PACKET_LENGTH (and may have a length of 0).
+  */
+  i= 0;
+  for (;;)
+  {
+    size_t z_size= MY_MIN(len, MAX_PACKET_LENGTH);
+    size_t packet_length= z_size;
+    int3store(buff, z_size);
+    buff[3]= (uchar) net->pkt_nr++;
+    if ((rc= net_write_buff(net, buff, NET_HEADER_SIZE)))
+      break;
+    while (z_size)
+    {
+      size_t length;
+      while (!left)
+      {
+        pos= parts[i].data;
+        left= parts[i++].length;
+      }
+      length= MY_MIN(z_size, left);
+      if ((rc= net_write_buff(net, pos, (ulong) length)))
+        break;
+      pos+= length;
+      left-= length;
+      z_size-= length;
+    }
+    if (rc || packet_length < MAX_PACKET_LENGTH)
+      break;
+    len-= packet_length;
+  }
+  MYSQL_NET_WRITE_DONE(rc);
+  return rc;
+}
+#endif
+
+
 /**
   Send a command to the server.
 
@@ -616,8 +688,8 @@ net_real_write(NET *net,const uchar *packet, size_t len)
     size_t complen;
     uchar *b;
     uint header_length=NET_HEADER_SIZE+COMP_HEADER_SIZE;
-    if (!(b= (uchar*) my_malloc(len + NET_HEADER_SIZE +
-                                COMP_HEADER_SIZE + 1,
+    if (!(b= (uchar*) my_malloc(MY_MAX(len, my_compress_bound(len)) +
+                                NET_HEADER_SIZE + COMP_HEADER_SIZE + 1,
                                 MYF(MY_WME |
                                     (net->thread_specific_malloc ?
                                      MY_THREAD_SPECIFIC : 0)))))
@@ -628,10 +700,12 @@ net_real_write(NET *net,const uchar *packet, size_t len)
       net->reading_or_writing= 0;
       DBUG_RETURN(1);
     }
-    memcpy(b+header_length,packet,len);
-
-    if (my_compress(b+header_length, &len, &complen))
+    if (my_compress_to(b+header_length, packet, &len, &complen,
+                       net->compress_level))
+    {
+      memcpy(b+header_length,packet,len);
       complen=0;
+    }
     int3store(&b[NET_HEADER_SIZE],complen);
     int3store(b,len);
     b[3]=(uchar) (net->compress_pkt_nr++);
@@ -0,0 +1,216 @@
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "opt_scan_filter.h"
+
+/*
+  Check if the field is an integer column that can be read directly from
+  the record buffer with Scan_filter::int_value()
+*/
+
+bool Scan_filter::is_int_field(const Field *field)
+{
+  if (field->vcol_info)
+    return FALSE;
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+    return TRUE;
+  case MYSQL_TYPE_LONGLONG:
+    /* Values above LONGLONG_MAX can't be compared as longlong */
+    return !(field->flags & UNSIGNED_FLAG);
+  default:
+    return FALSE;
+  }
+}
+
+
+/* Check if the item is an integer column of the table */
+
+static Field *scan_filter_field(Item *item, TABLE *table)
+{
+  Field *field;
+  if (item->type() != Item::FIELD_ITEM)
+    return NULL;
+  field= ((Item_field*) item)->field;
+  if (field->table != table || !Scan_filter::is_int_field(field))
+    return NULL;
+  return field;
+}
+
+
+/* Get the value of an integer literal, FALSE if there is none */
+
+static bool scan_filter_const(Item *item, longlong *value)
+{
+  if (item->type() != Item::INT_ITEM)
+    return FALSE;
+  *value= item->val_int();
+  return !(item->unsigned_flag && *value < 0);
+}
+
+
+/*
+  Compile one conjunct of the condition into a range
+
+  RETURN
+    TRUE   The conjunct is stored in 'range'
+    FALSE  The conjunct is not a simple comparison and has to be
+           evaluated by the Item tree
+*/
+
+bool Scan_filter::add(Item *item, TABLE *table, Range *range)
+{
+  Item **args;
+  Item_func::Functype functype;
+  Field *field;
+  longlong value;
+
+  if (item->type() != Item::FUNC_ITEM)
+    return FALSE;
+  args= ((Item_func*) item)->arguments();
+  range->min= LONGLONG_MIN;
+  range->max= LONGLONG_MAX;
+
+  switch ((functype= ((Item_func*) item)->functype())) {
+  case Item_func::BETWEEN:
+  {
+    longlong value2;
+    if (((Item_func_between*) item)->negated ||
+        !(field= scan_filter_field(args[0], table)) ||
+        !scan_filter_const(args[1], &value) ||
+        !scan_filter_const(args[2], &value2))
+      return FALSE;
+    range->min= value;
+    range->max= value2;
+    break;
+  }
+  case Item_func::EQ_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    if (((Item_bool_rowready_func2*) item)->compare_type() != INT_RESULT)
+      return FALSE;
+    if ((field= scan_filter_field(args[0], table)))
+    {
+      if (!scan_filter_const(args[1], &value))
+        return FALSE;
+    }
+    else
+    {
+      /* "const <op> column" is "column <reversed op> const" */
+      if (!(field= scan_filter_field(args[1], table)) ||
+          !scan_filter_const(args[0], &value))
+        return FALSE;
+      if (functype != Item_func::EQ_FUNC)
+        functype= ((Item_bool_rowready_func2*) item)->rev_functype();
+    }
+    switch (functype) {
+    case Item_func::EQ_FUNC:
+      range->min= range->max= value;
+      break;
+    case Item_func::LT_FUNC:
+      if (value == LONGLONG_MIN)
+        return FALSE;
+      range->max= value - 1;
+      break;
+    case Item_func::LE_FUNC:
+      range->max= value;
+      break;
+    case Item_func::GT_FUNC:
+      if (value == LONGLONG_MAX)
+        return FALSE;
+      range->min= value + 1;
+      break;
+    default:
+      range->min= value;
+      break;
+    }
+    break;
+  default:
+    return FALSE;
+  }
+
+  range->ptr= field->ptr;
+  range->null_ptr= field->null_ptr;
+  range->null_bit= field->null_bit;
+  range->length= (uchar) field->pack_length();
+  range->unsigned_flag= MY_TEST(field->flags & UNSIGNED_FLAG);
+  return TRUE;
+}
+
+
+/*
+  Build a scan filter for the condition of a table
+
+  SYNOPSIS
+    Scan_filter::create()
+      thd      Thread handle
+      table    The table that is scanned
+      cond     The condition attached to the table
+
+  RETURN
+    NULL   No part of the condition can be checked by a filter (or OOM)
+    #      The filter
+*/
+
+Scan_filter *Scan_filter::create(THD *thd, TABLE *table, Item *cond)
+{
+  Scan_filter *filter;
+  Range *ranges, *range;
+  uint count= 1;
+  bool covers_cond= TRUE;
+  bool is_and= (cond->type() == Item::COND_ITEM &&
+                ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC);
+  DBUG_ENTER("Scan_filter::create");
+
+  if (is_and)
+    count= ((Item_cond*) cond)->argument_list()->elements;
+  if (!(range= ranges= (Range*) thd->alloc(sizeof(Range) * count)))
+    DBUG_RETURN(NULL);
+
+  if (is_and)
+  {
+    List_iterator_fast<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+    {
+      if (add(item, table, range))
+        range++;
+      else
+        covers_cond= FALSE;
+    }
+  }
+  else if (add(cond, table, range))
+    range++;
+
+  if (range == ranges ||
+      !(filter= new (thd->mem_root) Scan_filter))
+    DBUG_RETURN(NULL);
+  filter->ranges= ranges;
+  filter->ranges_end= range;
+  filter->cond= cond;
+  filter->covers_cond= covers_cond;
+  DBUG_PRINT("info", ("ranges: %u  covers_cond: %d",
+                      (uint) (range - ranges), (int) covers_cond));
+  DBUG_RETURN(filter);
+}
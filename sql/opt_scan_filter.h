@@ -0,0 +1,102 @@
+#ifndef OPT_SCAN_FILTER_INCLUDED
+#define OPT_SCAN_FILTER_INCLUDED
+
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Scan filter: the conjuncts of a table's condition of the form
+  "int_column <op> constant" and "int_column BETWEEN const AND const",
+  compiled into ranges that are checked directly on the record buffer.
+
+  Every row of a table scan is checked against the filter before
+  select_cond->val_int() is called, so rows that fail a simple
+  comparison are rejected without walking the Item tree. If the whole
+  condition was compiled, the Item tree is not evaluated at all.
+*/
+
+class Scan_filter :public Sql_alloc
+{
+  struct Range
+  {
+    const uchar *ptr;                   /* Column value in record[0] */
+    const uchar *null_ptr;
+    uchar null_bit;
+    uchar length;                       /* 1, 2, 3, 4 or 8 bytes */
+    bool unsigned_flag;
+    longlong min, max;                  /* Both included */
+
+    inline longlong value(my_ptrdiff_t diff) const
+    {
+      return int_value(ptr + diff, length, unsigned_flag);
+    }
+  };
+
+  Range *ranges, *ranges_end;
+
+  Scan_filter() {}
+  static bool add(Item *item, TABLE *table, Range *range);
+public:
+  /* Get the value of an integer column stored in 'length' bytes */
+  static inline longlong int_value(const uchar *ptr, uint length,
+                                   bool unsigned_flag)
+  {
+    switch (length) {
+    case 1:
+      return unsigned_flag ? (longlong) ptr[0] :
+                             (longlong) ((const signed char*) ptr)[0];
+    case 2:
+      return unsigned_flag ? (longlong) uint2korr(ptr) :
+                             (longlong) sint2korr(ptr);
+    case 3:
+      return unsigned_flag ? (longlong) uint3korr(ptr) :
+                             (longlong) sint3korr(ptr);
+    case 4:
+      return unsigned_flag ? (longlong) uint4korr(ptr) :
+                             (longlong) sint4korr(ptr);
+    default:
+      return sint8korr(ptr);
+    }
+  }
+  static bool is_int_field(const Field *field);
+
+  /* The condition the filter was built for */
+  Item *cond;
+  /* TRUE <=> the filter is equivalent to the whole condition */
+  bool covers_cond;
+
+  static Scan_filter *create(THD *thd, TABLE *table, Item *cond);
+
+  /*
+    FALSE <=> the row does not satisfy the condition. 'diff' is the offset
+    of the record buffer from record[0].
+  */
+  inline bool check(my_ptrdiff_t diff= 0) const
+  {
+    for (const Range *range= ranges; range < ranges_end; range++)
+    {
+      longlong value;
+      if (range->null_ptr && (range->null_ptr[diff] & range->null_bit))
+        return FALSE;
+      value= range->value(diff);
+      if (value < range->min || value > range->max)
+        return FALSE;
+    }
+    return TRUE;
+  }
+};
+
+#endif /* OPT_SCAN_FILTER_INCLUDED */
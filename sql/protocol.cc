@@ -671,6 +671,10 @@ void Protocol::init(THD *thd_arg)
   thd=thd_arg;
   packet= &thd->packet;
   convert= &thd->convert_buffer;
+  metadata_copy= 0;
+#ifndef EMBEDDED_LIBRARY
+  external_value_count= 0;
+#endif
 #ifndef DBUG_OFF
   field_types= 0;
 #endif
@@ -722,6 +726,22 @@ bool Protocol::flush()
     1	Error  (Note that in this case the error is not sent to the
     client)
 */
+
+/**
+  Append a metadata packet to Protocol::metadata_copy, preceded by its
+  length. An empty packet stands for the EOF packet.
+*/
+
+static bool copy_metadata_packet(String *copy, const uchar *data,
+                                 size_t length)
+{
+  uchar buff[9];
+  uchar *pos= net_store_length(buff, length);
+  return copy->append((char*) buff, (uint32) (pos - buff)) ||
+         copy->append((const char*) data, (uint32) length);
+}
+
+
 bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
 {
   List_iterator_fast<Item> it(*list);
@@ -736,7 +756,9 @@ bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
   if (flags & SEND_NUM_ROWS)
   {				// Packet with number of elements
     uchar *pos= net_store_length(buff, list->elements);
-    if (my_net_write(&thd->net, buff, (size_t) (pos-buff)))
+    if (my_net_write(&thd->net, buff, (size_t) (pos-buff)) ||
+        (metadata_copy &&
+         copy_metadata_packet(metadata_copy, buff, (size_t) (pos-buff))))
       DBUG_RETURN(1);
   }
 
@@ -848,6 +870,10 @@ bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
       item->send(&prot, &tmp);			// Send default value
     if (prot.write())
       DBUG_RETURN(1);
+    if (metadata_copy &&
+        copy_metadata_packet(metadata_copy, (uchar*) local_packet->ptr(),
+                             local_packet->length()))
+      goto err;
 #ifndef DBUG_OFF
     field_types[count++]= field.type;
 #endif
@@ -861,7 +887,8 @@ bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
       Send no warning information, as it will be sent at statement end.
     */
     if (write_eof_packet(thd, &thd->net, thd->server_status,
-                         thd->get_stmt_da()->current_statement_warn_count()))
+                         thd->get_stmt_da()->current_statement_warn_count()) ||
+        (metadata_copy && copy_metadata_packet(metadata_copy, buff, 0)))
       DBUG_RETURN(1);
   }
   DBUG_RETURN(prepare_for_send(list->elements));
@@ -873,12 +900,84 @@ bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
 }
 
 
+/**
+  Send metadata packets saved by send_result_set_metadata() again.
+
+  @param copy  the packets, see Protocol::metadata_copy
+
+  @retval
+    0	ok
+  @retval
+    1	Error
+*/
+
+bool Protocol::send_saved_metadata(const String *copy)
+{
+  uchar *pos= (uchar*) copy->ptr();
+  uchar *end= pos + copy->length();
+  DBUG_ENTER("Protocol::send_saved_metadata");
+
+  while (pos < end)
+  {
+    ulong length= net_field_length(&pos);
+    if (length ? my_net_write(&thd->net, pos, length) :
+        write_eof_packet(thd, &thd->net, thd->server_status,
+                         thd->get_stmt_da()->current_statement_warn_count()))
+      DBUG_RETURN(1);
+    pos+= length;
+  }
+  DBUG_RETURN(0);
+}
+
+
 bool Protocol::write()
 {
   DBUG_ENTER("Protocol::write");
+  if (external_value_count)
+  {
+    NET_PART parts[MAX_EXTERNAL_VALUES * 2 + 1];
+    size_t offset= 0;
+    uint count= 0;
+    for (uint i= 0; i < external_value_count; i++)
+    {
+      st_external_value *value= external_values + i;
+      parts[count].data= (uchar*) packet->ptr() + offset;
+      parts[count++].length= value->offset - offset;
+      parts[count].data= (uchar*) value->data;
+      parts[count++].length= value->length;
+      offset= value->offset;
+    }
+    parts[count].data= (uchar*) packet->ptr() + offset;
+    parts[count++].length= packet->length() - offset;
+    external_value_count= 0;
+    DBUG_RETURN(my_net_write_parts(&thd->net, parts, count));
+  }
   DBUG_RETURN(my_net_write(&thd->net, (uchar*) packet->ptr(),
                            packet->length()));
 }
+
+
+/**
+  Store the length of a value in packet, and let write() send the value
+  from its own memory, that must stay valid until then.
+*/
+
+bool Protocol::store_external(const char *from, size_t length)
+{
+  ulong packet_length= packet->length();
+  st_external_value *value= external_values + external_value_count++;
+  DBUG_ASSERT(external_value_count <= MAX_EXTERNAL_VALUES);
+
+  if (packet_length+9 > packet->alloced_length() &&
+      packet->realloc(packet_length+9))
+    return 1;
+  uchar *to= net_store_length((uchar*) packet->ptr()+packet_length, length);
+  packet->length((uint) (to - (uchar*) packet->ptr()));
+  value->offset= packet->length();
+  value->data= from;
+  value->length= length;
+  return 0;
+}
 #endif /* EMBEDDED_LIBRARY */
 
 
@@ -981,6 +1080,7 @@ bool Protocol::store(I_List<i_string>* str_list)
 void Protocol_text::prepare_for_resend()
 {
   packet->length(0);
+  external_value_count= 0;
 #ifndef DBUG_OFF
   field_pos= 0;
 #endif
@@ -1174,6 +1274,19 @@ bool Protocol_text::store(Field *field)
     dbug_tmp_restore_column_map(table->read_set, old_map);
 #endif
 
+#ifndef EMBEDDED_LIBRARY
+  /*
+    A large value that points to the record or to the blob memory of the
+    table stays there until the row is sent, so it doesn't have to be
+    copied to packet.
+  */
+  if (str.length() > thd->net.max_packet &&
+      str.ptr() != buff && !str.is_alloced() &&
+      external_value_count < MAX_EXTERNAL_VALUES &&
+      (!tocs || my_charset_same(str.charset(), tocs) ||
+       str.charset() == &my_charset_bin || tocs == &my_charset_bin))
+    return store_external(str.ptr(), str.length());
+#endif
   return store_string_aux(str.ptr(), str.length(), str.charset(), tocs);
 }
 
@@ -42,6 +42,19 @@ class Protocol
 #endif
   uint field_count;
 #ifndef EMBEDDED_LIBRARY
+  /*
+    Large values of the row that are sent from their own memory by write(),
+    instead of being copied to packet. See Protocol_text::store(Field *).
+  */
+  enum { MAX_EXTERNAL_VALUES= 8 };
+  struct st_external_value
+  {
+    size_t offset;                              /* Position in packet */
+    const char *data;
+    size_t length;
+  } external_values[MAX_EXTERNAL_VALUES];
+  uint external_value_count;
+  bool store_external(const char *from, size_t length);
   bool net_store_data(const uchar *from, size_t length);
   bool net_store_data_cs(const uchar *from, size_t length,
                       CHARSET_INFO *fromcs, CHARSET_INFO *tocs);
@@ -71,12 +84,20 @@ class Protocol
 
 public:
   THD	 *thd;
+  /*
+    If set, send_result_set_metadata() also appends the packets it sends
+    here, each one preceded by its length, and an empty one for the EOF
+    packet. Used to save what COM_STMT_PREPARE sent, see
+    Prepared_statement::saved_metadata.
+  */
+  String *metadata_copy;
   Protocol(THD *thd_arg) { init(thd_arg); }
   virtual ~Protocol() {}
   void init(THD* thd_arg);
 
   enum { SEND_NUM_ROWS= 1, SEND_DEFAULTS= 2, SEND_EOF= 4 };
   virtual bool send_result_set_metadata(List<Item> *list, uint flags);
+  bool send_saved_metadata(const String *copy);
   bool send_result_set_row(List<Item> *row_items);
 
   bool store(I_List<i_string> *str_list);
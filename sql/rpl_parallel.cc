@@ -971,8 +971,8 @@ handle_rpl_parallel_thread(void *arg)
   thd->thread_stack = (char*)&thd;
   mysql_mutex_lock(&LOCK_thread_count);
   thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
-  threads.append(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   set_current_thd(thd);
   pthread_detach_this_thread();
   thd->init_for_queries();
@@ -1373,9 +1373,7 @@ handle_rpl_parallel_thread(void *arg)
   thd_proc_info(thd, "Slave worker thread exiting");
   thd->temporary_tables= 0;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->unlink();
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.erase(thd);
   delete thd;
 
   mysql_mutex_lock(&rpt->LOCK_rpl_thread);
@@ -265,8 +265,6 @@ extern uint report_port;
 extern char *master_info_file, *report_user;
 extern char *report_host, *report_password;
 
-extern I_List<THD> threads;
-
 #else
 #define close_active_mi() /* no-op */
 #endif /* HAVE_REPLICATION */
@@ -11329,14 +11329,16 @@ static bool send_server_handshake_packet(MPVIO_EXT *mpvio,
   end+= SCRAMBLE_LENGTH_323;
   *end++= 0;
 
-  int2store(end, thd->client_capabilities);
+  /* A cleared CLIENT_MYSQL tells the client to look for extended flags */
+  int2store(end, thd->client_capabilities & ~CLIENT_MYSQL);
   /* write server characteristics: up to 16 bytes allowed */
   end[2]= (char) default_charset_info->number;
   int2store(end+3, mpvio->thd->server_status);
   int2store(end+5, thd->client_capabilities >> 16);
   end[7]= data_len;
   DBUG_EXECUTE_IF("poison_srv_handshake_scramble_len", end[7]= -100;);
-  bzero(end + 8, 10);
+  bzero(end + 8, 6);
+  int4store(end + 14, MARIADB_CLIENT_EXTENDED_FLAGS >> 32);
   end+= 18;
   /* write scramble tail */
   end= (char*) memcpy(end, data + SCRAMBLE_LENGTH_323,
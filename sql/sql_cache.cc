@@ -269,9 +269,19 @@ are stored in one block.
 
 If join_results allocated new block(s) then we need call pack_cache again.
 
-7. Interface
+7. Instances
+The query cache of the server (query_cache) is a Query_cache_instances
+object which splits the memory into query_cache_instances Query_cache
+objects, each with its own structure_guard_mutex. A statement is stored in
+and looked up from the instance chosen by the hash of its text (after
+comments are stripped, if query_cache_strip_comments is set); the result
+is written to the instance remembered in thd->query_cache_tls. Every
+instance keeps a counting filter of the keys of its tables, so a table is
+only invalidated in the instances which may hold queries using it.
+
+8. Interface
 The query cache interfaces with the rest of the server code through 7
-functions:
+functions of Query_cache_instances, which forward to the instances:
  1. Query_cache::send_result_to_client
        - Called before parsing and used to match a statement with the stored
          queries hash.
@@ -347,6 +357,7 @@ TODO list:
 #include "log_slow.h"
 #include "transaction.h"
 #include "strfunc.h"
+#include "my_atomic.h"
 
 const uchar *query_state_map;
 
@@ -1111,8 +1122,8 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1221,9 +1232,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= MY_MAX(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= MY_MAX(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1258,6 +1269,195 @@ void mysql_query_cache_invalidate4(THD *thd,
 }
 
 
+/*****************************************************************************
+   Query_cache_instances methods
+*****************************************************************************/
+
+/**
+  Instance which caches the statement with the given text.
+*/
+
+Query_cache *Query_cache_instances::instance(const String *query)
+{
+  if (m_count == 1)
+    return m_instances;
+  return &m_instances[my_hash_sort(&my_charset_bin, (uchar*) query->ptr(),
+                                   query->length()) % m_count];
+}
+
+
+void Query_cache_instances::init()
+{
+  DBUG_ENTER("Query_cache_instances::init");
+  m_count= query_cache_instances;
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].init();
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Split the memory of the query cache evenly between the instances, the
+  first instance also gets the remainder of the division.
+
+  @return the total size of the instances, 0 if the cache is disabled
+*/
+
+ulong Query_cache_instances::resize(ulong query_cache_size_arg)
+{
+  ulong new_query_cache_size= 0;
+  DBUG_ENTER("Query_cache_instances::resize");
+  for (uint i= 0; i < m_count; i++)
+    new_query_cache_size+=
+      m_instances[i].resize(query_cache_size_arg / m_count +
+                            (i ? 0 : query_cache_size_arg % m_count));
+  query_cache_size= new_query_cache_size;
+  DBUG_RETURN(new_query_cache_size);
+}
+
+
+/*
+  The limits are set at startup before init(), when the number of the
+  used instances is not known yet, so they are set in all of them.
+*/
+
+void Query_cache_instances::result_size_limit(ulong limit)
+{
+  for (uint i= 0; i < QUERY_CACHE_MAX_INSTANCES; i++)
+    m_instances[i].result_size_limit(limit);
+}
+
+
+ulong Query_cache_instances::set_min_res_unit(ulong size)
+{
+  for (uint i= 0; i < QUERY_CACHE_MAX_INSTANCES; i++)
+    size= m_instances[i].set_min_res_unit(size);
+  return size;
+}
+
+
+bool Query_cache_instances::is_disable_in_progress(void)
+{
+  for (uint i= 0; i < m_count; i++)
+  {
+    if (m_instances[i].is_disable_in_progress())
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+void Query_cache_instances::disable_query_cache(THD *thd)
+{
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].disable_query_cache(thd);
+}
+
+
+void Query_cache_instances::store_query(THD *thd, TABLE_LIST *tables_used)
+{
+  /*
+    thd->base_query is only prepared by send_result_to_client() when
+    the query may be cached. See also Query_cache::store_query().
+  */
+  if (!thd->query_cache_is_applicable || query_cache_size == 0)
+    return;
+  instance(&thd->base_query)->store_query(thd, tables_used);
+}
+
+
+/*
+  The result of a query is written to the instance which registered
+  the query in store_query(). See the comment on double-check locking
+  usage above.
+*/
+
+void Query_cache_instances::insert(THD *thd, Query_cache_tls *query_cache_tls,
+                                   const char *packet, ulong length,
+                                   unsigned pkt_nr)
+{
+  if (query_cache_tls->first_query_block == NULL)
+    return;
+  query_cache_tls->cache->insert(thd, query_cache_tls, packet, length,
+                                 pkt_nr);
+}
+
+
+void Query_cache_instances::end_of_result(THD *thd)
+{
+  if (thd->query_cache_tls.first_query_block == NULL)
+    return;
+  thd->query_cache_tls.cache->end_of_result(thd);
+}
+
+
+void Query_cache_instances::abort(THD *thd, Query_cache_tls *query_cache_tls)
+{
+  if (query_cache_tls->first_query_block == NULL)
+    return;
+  query_cache_tls->cache->abort(thd, query_cache_tls);
+}
+
+
+void Query_cache_instances::flush()
+{
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].flush();
+}
+
+
+void Query_cache_instances::pack(THD *thd, ulong join_limit,
+                                 uint iteration_limit)
+{
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].pack(thd, join_limit, iteration_limit);
+}
+
+
+void Query_cache_instances::destroy()
+{
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].destroy();
+}
+
+
+/**
+  Sum the statistics of the instances. The counters are read without
+  locking, as with a single query cache before.
+*/
+
+void Query_cache_instances::get_status(Query_cache_status *status)
+{
+  bzero(status, sizeof(*status));
+  for (uint i= 0; i < m_count; i++)
+  {
+    Query_cache *qc= &m_instances[i];
+    status->free_memory_blocks+= qc->free_memory_blocks;
+    status->free_memory+= qc->free_memory;
+    status->hits+= qc->hits;
+    status->inserts+= qc->inserts;
+    status->lowmem_prunes+= qc->lowmem_prunes;
+    status->refused+= qc->refused;
+    status->queries_in_cache+= qc->queries_in_cache;
+    status->total_blocks+= qc->total_blocks;
+  }
+}
+
+
+/**
+  Reset the statistics which FLUSH STATUS clears.
+*/
+
+void Query_cache_instances::reset_status()
+{
+  for (uint i= 0; i < m_count; i++)
+  {
+    Query_cache *qc= &m_instances[i];
+    qc->hits= qc->inserts= qc->lowmem_prunes= qc->refused= 0;
+  }
+}
+
+
 /*****************************************************************************
    Query_cache methods
 *****************************************************************************/
@@ -1284,6 +1484,7 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   set_if_bigger(min_allocation_unit,min_needed);
   this->min_allocation_unit= ALIGN_SIZE(min_allocation_unit);
   set_if_bigger(this->min_result_data_size,min_allocation_unit);
+  bzero(table_filter, sizeof(table_filter));
 }
 
 
@@ -1546,6 +1747,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.cache= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1684,19 +1886,11 @@ size_t build_normalized_name(char *buff, size_t bufflen,
 */
 
 int
-Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
+Query_cache_instances::send_result_to_client(THD *thd, char *org_sql,
+                                             uint query_length)
 {
-  ulonglong engine_data;
-  Query_cache_query *query;
-#ifndef EMBEDDED_LIBRARY
-  Query_cache_block *first_result_block;
-#endif
-  Query_cache_block *result_block;
-  Query_cache_block_table *block_table, *block_table_end;
-  ulong tot_length;
-  Query_cache_query_flags flags;
   const char *sql, *sql_end, *found_brace= 0;
-  DBUG_ENTER("Query_cache::send_result_to_client");
+  DBUG_ENTER("Query_cache_instances::send_result_to_client");
 
   /*
     Testing without a lock here is safe: the thing
@@ -1834,6 +2028,53 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
       goto err;
     }
   }
+  /*
+    The statement without comments is the key of the query and selects
+    the instance, so it is built before any instance is locked.
+  */
+  if (thd->variables.query_cache_strip_comments)
+  {
+    if (found_brace)
+      sql= found_brace;
+    make_base_query(&thd->base_query, sql, (size_t) (sql_end - sql),
+                    thd->db_length + 1 + QUERY_CACHE_DB_LENGTH_SIZE +
+                    QUERY_CACHE_FLAGS_SIZE);
+  }
+  else
+    thd->base_query.set(org_sql, query_length, system_charset_info);
+
+  DBUG_RETURN(instance(&thd->base_query)->send_result_to_client(thd));
+
+err:
+  thd->query_cache_is_applicable= 0;            // Query can't be cached
+  DBUG_RETURN(0);				// Query was not cached
+}
+
+
+/*
+  Check if the query in thd->base_query is in this instance. If it was
+  cached, send it to the user.
+
+  @param thd Pointer to the thread handler
+
+  @return status code, see Query_cache_instances::send_result_to_client()
+*/
+
+int Query_cache::send_result_to_client(THD *thd)
+{
+  ulonglong engine_data;
+  Query_cache_query *query;
+#ifndef EMBEDDED_LIBRARY
+  Query_cache_block *first_result_block;
+#endif
+  Query_cache_block *result_block;
+  Query_cache_block_table *block_table, *block_table_end;
+  ulong tot_length;
+  Query_cache_query_flags flags;
+  const char *sql= thd->base_query.ptr();
+  uint query_length= thd->base_query.length();
+  DBUG_ENTER("Query_cache::send_result_to_client");
+
   /*
     Try to obtain an exclusive lock on the query cache. If the cache is
     disabled or if a full cache flush is in progress, the attempt to
@@ -1851,22 +2092,6 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
   }
 
   Query_cache_block *query_block;
-  if (thd->variables.query_cache_strip_comments)
-  {
-    if (found_brace)
-      sql= found_brace;
-    make_base_query(&thd->base_query, sql, (size_t) (sql_end - sql),
-                    thd->db_length + 1 + QUERY_CACHE_DB_LENGTH_SIZE +
-                    QUERY_CACHE_FLAGS_SIZE);
-    sql=          thd->base_query.ptr();
-    query_length= thd->base_query.length();
-  }
-  else
-  {
-    sql= org_sql;
-    thd->base_query.set(sql, query_length, system_charset_info);
-  }
-
   tot_length= (query_length + 1 + QUERY_CACHE_DB_LENGTH_SIZE +
                thd->db_length + QUERY_CACHE_FLAGS_SIZE);
 
@@ -2185,10 +2410,10 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
   Remove all cached queries that uses any of the tables in the list
 */
 
-void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
-			     my_bool using_transactions)
+void Query_cache_instances::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                       my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table list)");
+  DBUG_ENTER("Query_cache_instances::invalidate (table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2216,9 +2441,10 @@ void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used)
+void Query_cache_instances::invalidate(THD *thd,
+                                       CHANGED_TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate (changed table list)");
+  DBUG_ENTER("Query_cache_instances::invalidate (changed table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2238,16 +2464,16 @@ void Query_cache::invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used)
   Invalidate locked for write
 
   SYNOPSIS
-    Query_cache::invalidate_locked_for_write()
+    Query_cache_instances::invalidate_locked_for_write()
     tables_used - table list
 
   NOTE
     can be used only for opened tables
 */
-void Query_cache::invalidate_locked_for_write(THD *thd,
-                                              TABLE_LIST *tables_used)
+void Query_cache_instances::invalidate_locked_for_write(THD *thd,
+                                                        TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate_locked_for_write");
+  DBUG_ENTER("Query_cache_instances::invalidate_locked_for_write");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2267,10 +2493,10 @@ void Query_cache::invalidate_locked_for_write(THD *thd,
   Remove all cached queries that uses the given table
 */
 
-void Query_cache::invalidate(THD *thd, TABLE *table, 
-			     my_bool using_transactions)
+void Query_cache_instances::invalidate(THD *thd, TABLE *table,
+                                       my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table)");
+  DBUG_ENTER("Query_cache_instances::invalidate (table)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2285,10 +2511,11 @@ void Query_cache::invalidate(THD *thd, TABLE *table,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
-			     my_bool using_transactions)
+void Query_cache_instances::invalidate(THD *thd, const char *key,
+                                       uint32  key_length,
+                                       my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (key)");
+  DBUG_ENTER("Query_cache_instances::invalidate (key)");
   if (is_disabled())
    DBUG_VOID_RETURN;
 
@@ -2306,6 +2533,19 @@ void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
    Remove all cached queries that uses the given database.
 */
 
+void Query_cache_instances::invalidate(THD *thd, char *db)
+{
+  DBUG_ENTER("Query_cache_instances::invalidate (db)");
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].invalidate(thd, db);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+   Remove all queries of this instance that uses the given database.
+*/
+
 void Query_cache::invalidate(THD *thd, char *db)
 {
   DBUG_ENTER("Query_cache::invalidate (db)");
@@ -2379,9 +2619,9 @@ void Query_cache::invalidate(THD *thd, char *db)
 }
 
 
-void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
+void Query_cache_instances::invalidate_by_MyISAM_filename(const char *filename)
 {
-  DBUG_ENTER("Query_cache::invalidate_by_MyISAM_filename");
+  DBUG_ENTER("Query_cache_instances::invalidate_by_MyISAM_filename");
 
   if (is_disabled())
     DBUG_VOID_RETURN;
@@ -2389,7 +2629,8 @@ void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
   /* Calculate the key outside the lock to make the lock shorter */
   char key[MAX_DBKEY_LENGTH];
   uint32 db_length;
-  uint key_length= filename_2_table_key(key, filename, &db_length);
+  uint key_length= Query_cache::filename_2_table_key(key, filename,
+                                                    &db_length);
   THD *thd= current_thd;
   invalidate_table(thd,(uchar *)key, key_length);
   DBUG_VOID_RETURN;
@@ -2413,7 +2654,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2739,6 +2980,7 @@ void Query_cache::make_disabled()
   first_block= 0;
   total_blocks= 0;
   tables_blocks= 0;
+  bzero(table_filter, sizeof(table_filter));
   DBUG_VOID_RETURN;
 }
 
@@ -3216,7 +3458,7 @@ my_bool Query_cache::allocate_data_chain(Query_cache_block **result_block,
   Invalidate the first table in the table_list
 */
 
-void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
+void Query_cache_instances::invalidate_table(THD *thd, TABLE_LIST *table_list)
 {
   if (table_list->table != 0)
     invalidate_table(thd, table_list->table);	// Table is open
@@ -3231,12 +3473,35 @@ void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
   }
 }
 
-void Query_cache::invalidate_table(THD *thd, TABLE *table)
+void Query_cache_instances::invalidate_table(THD *thd, TABLE *table)
 {
   invalidate_table(thd, (uchar*) table->s->table_cache_key.str,
                    table->s->table_cache_key.length);
 }
 
+
+/**
+  Invalidate a table in the instances which may hold it.
+
+  The table filters are read without locking the instances. A query is
+  registered in the filter when it starts being stored, that is while
+  it holds its table locks and before it reads any data, so a statement
+  which invalidates a table after changing it sees every query that
+  could have read the old data. With a single instance the filter is
+  not used and the table is always invalidated under the lock.
+*/
+
+void Query_cache_instances::invalidate_table(THD *thd,
+                                             uchar *key, uint32 key_length)
+{
+  for (uint i= 0; i < m_count; i++)
+  {
+    if (m_count == 1 || m_instances[i].may_hold_table(key, key_length))
+      m_instances[i].invalidate_table(thd, key, key_length);
+  }
+}
+
+
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
@@ -3256,6 +3521,37 @@ void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 }
 
 
+/**
+  Slot of a table key in the table filter.
+*/
+
+uint Query_cache::table_filter_slot(const uchar *key, uint32 key_length)
+{
+  /* The same collation as of the 'tables' hash, see init_cache() */
+#ifndef FN_NO_CASE_SENSE
+  CHARSET_INFO *cs= &my_charset_bin;
+#else
+  CHARSET_INFO *cs= (lower_case_table_names ? &my_charset_bin :
+                     files_charset_info);
+#endif
+  return (uint) (my_hash_sort(cs, key, key_length) &
+                 (QUERY_CACHE_TABLE_FILTER_SIZE - 1));
+}
+
+
+/**
+  Check, without locking, if a table may be held by this instance.
+
+  @return FALSE if no query of this instance uses the table
+*/
+
+bool Query_cache::may_hold_table(const uchar *key, uint32 key_length)
+{
+  return my_atomic_load32(&table_filter[table_filter_slot(key,
+                                                          key_length)]) != 0;
+}
+
+
 /**
   Try to locate and invalidate a table by name.
   The caller must ensure that no other thread is trying to work with
@@ -3504,6 +3800,9 @@ Query_cache::insert_table(THD *thd, uint key_len, const char *key,
       free_memory_block(table_block);
       DBUG_RETURN(0);
     }
+    if (hash)
+      my_atomic_add32(&table_filter[table_filter_slot((uchar*) key,
+                                                      key_len)], 1);
     char *db= header->db();
     header->table(db + db_length + 1);
     header->key_length(key_len);
@@ -3567,7 +3866,12 @@ void Query_cache::unlink_table(Query_cache_block_table *node)
                                &tables_blocks);
     Query_cache_table *header= table_block->table();
     if (header->is_hashed())
+    {
+      my_atomic_add32(&table_filter[table_filter_slot((uchar*) header->db(),
+                                                      header->key_length())],
+                      -1);
       my_hash_delete(&tables,(uchar *) table_block);
+    }
     free_memory_block(table_block);
   }
   DBUG_VOID_RETURN;
@@ -4179,7 +4483,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4211,7 +4515,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -4593,6 +4897,22 @@ my_bool in_blocks(Query_cache_block * point) { return 0; }
 #else
 
 
+void Query_cache_instances::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < m_count; i++)
+    m_instances[i].wreck(line, message);
+}
+
+
+my_bool Query_cache_instances::check_integrity(bool locked)
+{
+  my_bool result= 0;
+  for (uint i= 0; i < m_count; i++)
+    result|= m_instances[i].check_integrity(locked);
+  return result;
+}
+
+
 /*
   Debug method which switch query cache off but left content for
   investigation.
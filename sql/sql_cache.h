@@ -20,6 +20,7 @@
 #include "my_base.h"                            /* ha_rows */
 
 class MY_LOCALE;
+class String;
 struct TABLE_LIST;
 class Time_zone;
 struct LEX;
@@ -66,6 +67,12 @@ typedef struct st_changed_table_list CHANGED_TABLE_LIST;
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* maximal number of query cache instances (see Query_cache_instances) */
+#define QUERY_CACHE_MAX_INSTANCES		64
+
+/* number of counters in the table filter of an instance (power of 2) */
+#define QUERY_CACHE_TABLE_FILTER_SIZE		256
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -74,6 +81,7 @@ struct Query_cache_table;
 struct Query_cache_query;
 struct Query_cache_result;
 class Query_cache;
+class Query_cache_instances;
 struct Query_cache_tls;
 struct LEX;
 class THD;
@@ -287,8 +295,26 @@ struct Query_cache_memory_bin_step
   }
 };
 
+/**
+  Values of the Qcache_% status variables, summed over all instances.
+*/
+
+struct Query_cache_status
+{
+  ulong free_memory_blocks, free_memory, hits, inserts, lowmem_prunes,
+    refused, queries_in_cache, total_blocks;
+};
+
+
+/**
+  One instance of the query cache: its memory, the hashes of queries and
+  tables and the lock protecting them. The server uses the instances
+  through Query_cache_instances.
+*/
+
 class Query_cache
 {
+  friend class Query_cache_instances;
 public:
   /* Info */
   ulong query_cache_size, query_cache_limit;
@@ -308,8 +334,18 @@ class Query_cache
   enum Cache_staus {OK, DISABLE_REQUEST, DISABLED};
   Cache_staus m_cache_status;
 
+  /*
+    Counting filter of the keys in the 'tables' hash: the number of
+    hashed tables whose key falls in each slot. It is changed under
+    structure_guard_mutex and read without it by
+    Query_cache_instances::invalidate_table() to skip this instance.
+  */
+  int32 table_filter[QUERY_CACHE_TABLE_FILTER_SIZE];
+
   void free_query_internal(Query_cache_block *point);
   void invalidate_table_internal(THD *thd, uchar *key, uint32 key_length);
+  static uint table_filter_slot(const uchar *key, uint32 key_length);
+  bool may_hold_table(const uchar *key, uint32 key_length);
 
 protected:
   /*
@@ -360,10 +396,7 @@ class Query_cache
 			      ulong data_len,
 			      Query_cache_block *query_block,
 			      my_bool first_block);
-  void invalidate_table(THD *thd, TABLE_LIST *table);
-  void invalidate_table(THD *thd, TABLE *table);
   void invalidate_table(THD *thd, uchar *key, uint32  key_length);
-  void invalidate_table(THD *thd, Query_cache_block *table_block);
   void invalidate_query_block_list(THD *thd, 
                                    Query_cache_block_table *list_root);
 
@@ -460,26 +493,14 @@ class Query_cache
   void store_query(THD *thd, TABLE_LIST *used_tables);
 
   /*
-    Check if the query is in the cache and if this is true send the
-    data to client.
+    Check if the query in thd->base_query is in the cache and if this
+    is true send the data to client.
   */
-  int send_result_to_client(THD *thd, char *query, uint query_length);
-
-  /* Remove all queries that uses any of the listed following tables */
-  void invalidate(THD *thd, TABLE_LIST *tables_used,
-		  my_bool using_transactions);
-  void invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used);
-  void invalidate_locked_for_write(THD *thd, TABLE_LIST *tables_used);
-  void invalidate(THD *thd, TABLE *table, my_bool using_transactions);
-  void invalidate(THD *thd, const char *key, uint32  key_length,
-		  my_bool using_transactions);
+  int send_result_to_client(THD *thd);
 
   /* Remove all queries that uses any of the tables in following database */
   void invalidate(THD *thd, char *db);
 
-  /* Remove all queries that uses any of the listed following table */
-  void invalidate_by_MyISAM_filename(const char *filename);
-
   void flush();
   void pack(THD *thd,
             ulong join_limit = QUERY_CACHE_PACK_LIMIT,
@@ -533,6 +554,98 @@ class Query_cache
   void disable_query_cache(THD *thd);
 };
 
+
+/**
+  The query cache of the server, split into query_cache_instances
+  independent Query_cache instances.
+
+  A statement is stored in and looked up from the instance selected by
+  the hash of its text (thd->base_query), so lookups and stores of
+  different statements take different locks. A table is invalidated
+  only in the instances whose table filter says they may hold it.
+*/
+
+class Query_cache_instances
+{
+  Query_cache m_instances[QUERY_CACHE_MAX_INSTANCES];
+  uint m_count;
+
+  Query_cache *instance(const String *query);
+  void invalidate_table(THD *thd, TABLE_LIST *table);
+  void invalidate_table(THD *thd, TABLE *table);
+  void invalidate_table(THD *thd, uchar *key, uint32  key_length);
+public:
+  /* Sum of the sizes of all instances */
+  ulong query_cache_size;
+
+  Query_cache_instances() :m_count(1), query_cache_size(0) {}
+
+  uint count() const { return m_count; }
+  Query_cache *instance(uint i) { return &m_instances[i]; }
+
+  /*
+    All instances are enabled and disabled together, disabling an
+    instance only completes when its last request ends.
+  */
+  inline bool is_disabled(void) { return m_instances[0].is_disabled(); }
+  bool is_disable_in_progress(void);
+
+  /* initialize the instances (mutexes) */
+  void init();
+  /* resize query cache (return real query size, 0 if disabled) */
+  ulong resize(ulong query_cache_size);
+  /* set limit on result size */
+  void result_size_limit(ulong limit);
+  /* set minimal result data allocation unit size */
+  ulong set_min_res_unit(ulong size);
+
+  /* register query in cache */
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+
+  /*
+    Check if the query is in the cache and if this is true send the
+    data to client.
+  */
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  /* Remove all queries that uses any of the listed following tables */
+  void invalidate(THD *thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(THD *thd, TABLE_LIST *tables_used);
+  void invalidate(THD *thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+
+  /* Remove all queries that uses any of the tables in following database */
+  void invalidate(THD *thd, char *db);
+
+  /* Remove all queries that uses any of the listed following table */
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack(THD *thd,
+            ulong join_limit = QUERY_CACHE_PACK_LIMIT,
+	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
+
+  void destroy();
+
+  void insert(THD *thd, Query_cache_tls *query_cache_tls,
+              const char *packet,
+              ulong length,
+              unsigned pkt_nr);
+  void end_of_result(THD *thd);
+  void abort(THD *thd, Query_cache_tls *query_cache_tls);
+
+  void wreck(uint line, const char *message);
+  my_bool check_integrity(bool not_locked);
+
+  void get_status(Query_cache_status *status);
+  void reset_status();
+
+  void disable_query_cache(THD *thd);
+};
+
 #ifdef HAVE_QUERY_CACHE
 struct Query_cache_query_flags
 {
@@ -596,5 +709,5 @@ struct Query_cache_query_flags
 #define query_cache_is_cacheable_query(L) 0
 #endif /*HAVE_QUERY_CACHE*/
 
-extern Query_cache query_cache;
+extern Query_cache_instances query_cache;
 #endif
@@ -1425,6 +1425,7 @@ void THD::init(void)
   reset_binlog_local_stmt_filter();
   set_status_var_init();
   bzero((char *) &org_status_var, sizeof(org_status_var));
+  bzero((char *) &published_status_var, sizeof(published_status_var));
   start_bytes_received= 0;
   last_commit_gtid.seq_no= 0;
   status_in_global= 0;
@@ -1806,6 +1807,165 @@ void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
   */
 }
 
+
+/*
+  Status published by running threads.
+
+  The global status is global_status_var, which holds the status of
+  threads that have ended or flushed their status, plus the sum of these
+  partitions, plus what the running threads have not published yet.
+  Threads publish into the partition of their thread id, so that threads
+  ending statements at the same time don't all wait for one mutex.
+*/
+
+static struct status_var_partition
+{
+  mysql_mutex_t lock;
+  STATUS_VAR status_var;
+} status_var_partitions[STATUS_VAR_PARTITIONS];
+
+
+void init_status_var_partitions()
+{
+  for (uint i= 0; i < STATUS_VAR_PARTITIONS; i++)
+    mysql_mutex_init(key_LOCK_status_partition,
+                     &status_var_partitions[i].lock, MY_MUTEX_INIT_FAST);
+}
+
+
+void destroy_status_var_partitions()
+{
+  for (uint i= 0; i < STATUS_VAR_PARTITIONS; i++)
+    mysql_mutex_destroy(&status_var_partitions[i].lock);
+}
+
+
+/*
+  Add the status published by all running threads
+
+  SYNOPSIS
+    add_published_status()
+    to_var       add to this array
+*/
+
+void add_published_status(STATUS_VAR *to_var)
+{
+  for (uint i= 0; i < STATUS_VAR_PARTITIONS; i++)
+  {
+    status_var_partition *part= &status_var_partitions[i];
+    mysql_mutex_lock(&part->lock);
+    add_to_status(to_var, &part->status_var);
+    to_var->local_memory_used+= part->status_var.local_memory_used;
+    mysql_mutex_unlock(&part->lock);
+  }
+}
+
+
+/**
+  Add what status_var has gained since the last call to the global status.
+
+  Called at the end of every statement, so that SHOW GLOBAL STATUS can
+  sum the global status without visiting every THD. Threads that run
+  one long command or none at all (binlog dump, slave and wsrep
+  appliers, handler_socket workers) call it after each event or batch.
+*/
+
+void THD::publish_status()
+{
+  if (status_in_global)
+    return;
+  status_var_partition *part=
+    &status_var_partitions[thread_id % STATUS_VAR_PARTITIONS];
+  mysql_mutex_lock(&part->lock);
+  add_diff_to_status(&part->status_var, &status_var, &published_status_var);
+  part->status_var.local_memory_used+= (status_var.local_memory_used -
+                                        published_status_var.local_memory_used);
+  mysql_mutex_unlock(&part->lock);
+  memcpy(&published_status_var, &status_var, sizeof(status_var));
+}
+
+
+/*****************************************************************************
+  THD_list
+*****************************************************************************/
+
+THD_list server_threads;
+
+
+void THD_list::init()
+{
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+    mysql_mutex_init(key_LOCK_thd_list, &partitions[i].lock,
+                     MY_MUTEX_INIT_FAST);
+}
+
+
+void THD_list::destroy()
+{
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+    mysql_mutex_destroy(&partitions[i].lock);
+}
+
+
+/**
+  Add a THD to the list, making it visible in SHOW PROCESSLIST, KILL etc.
+*/
+
+void THD_list::insert(THD *thd)
+{
+  Partition *part= partition_of(thd);
+  mysql_mutex_lock(&part->lock);
+  part->threads.append(thd);
+  mysql_mutex_unlock(&part->lock);
+}
+
+
+/**
+  Remove a THD from the list. It's safe to call this for a THD that is
+  not in the list.
+*/
+
+void THD_list::erase(THD *thd)
+{
+  Partition *part= partition_of(thd);
+  mysql_mutex_lock(&part->lock);
+  thd->unlink();
+  mysql_mutex_unlock(&part->lock);
+}
+
+
+bool THD_list::is_empty()
+{
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Partition *part= &partitions[i];
+    mysql_mutex_lock(&part->lock);
+    bool empty= part->threads.is_empty();
+    mysql_mutex_unlock(&part->lock);
+    if (!empty)
+      return false;
+  }
+  return true;
+}
+
+
+THD *THD_list_iterator::operator++(int)
+{
+  THD *thd;
+  while (partition < THD_LIST_PARTITIONS)
+  {
+    if ((thd= it++))
+      return thd;
+    mysql_mutex_unlock(&list->partitions[partition].lock);
+    if (++partition == THD_LIST_PARTITIONS)
+      break;
+    it= I_List_iterator<THD>(list->partitions[partition].threads);
+    mysql_mutex_lock(&list->partitions[partition].lock);
+  }
+  return NULL;
+}
+
+
 #define SECONDS_TO_WAIT_FOR_KILL 2
 #if !defined(__WIN__) && defined(HAVE_SELECT)
 /* my_sleep() can wait for sub second times */
@@ -3739,8 +3899,27 @@ static uchar *get_stmt_name_hash_key(Statement *entry, size_t *length,
   return (uchar*) entry->name.str;
 }
 
+static uchar *get_stmt_query_hash_key(Statement *entry, size_t *length,
+                                      my_bool not_used __attribute__((unused)))
+{
+  *length= entry->query_length();
+  return (uchar*) entry->query();
+}
+
 C_MODE_END
 
+
+/* Delete a record from a hash without freeing it */
+
+static void hash_delete_keep(HASH *hash, uchar *record)
+{
+  void (*free_element)(void *)= hash->free;
+  hash->free= 0;
+  my_hash_delete(hash, record);
+  hash->free= free_element;
+}
+
+
 Statement_map::Statement_map() :
   last_found_statement(0)
 {
@@ -3755,6 +3934,9 @@ Statement_map::Statement_map() :
   my_hash_init(&names_hash, system_charset_info, START_NAME_HASH_SIZE, 0, 0,
                (my_hash_get_key) get_stmt_name_hash_key,
                NULL,MYF(0));
+  my_hash_init(&closed_hash, &my_charset_bin, START_STMT_HASH_SIZE, 0, 0,
+               (my_hash_get_key) get_stmt_query_hash_key,
+               delete_statement_as_hash_key, MYF(0));
 }
 
 
@@ -3797,6 +3979,13 @@ int Statement_map::insert(THD *thd, Statement *statement)
     goto err_names_hash;
   }
   mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  if (prepared_stmt_count >= max_prepared_stmt_count && closed_hash.records)
+  {
+    /* Make room by dropping the closed statements this connection keeps */
+    mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+    trim_closed(0);
+    mysql_mutex_lock(&LOCK_prepared_stmt_count);
+  }
   /*
     We don't check that prepared_stmt_count is <= max_prepared_stmt_count
     because we would like to allow to lower the total limit
@@ -3852,16 +4041,80 @@ void Statement_map::erase(Statement *statement)
 }
 
 
-void Statement_map::reset()
+void Statement_map::keep_closed(Statement *statement, ulong max_count)
+{
+  Statement *old;
+  if (statement == last_found_statement)
+    last_found_statement= 0;
+  DBUG_ASSERT(!statement->name.str);
+  /* The statement stays in prepared_stmt_count while it is kept */
+  hash_delete_keep(&st_hash, (uchar *) statement);
+
+  /* Only the most recently closed statement with a given text is kept */
+  if ((old= (Statement *) my_hash_search(&closed_hash,
+                                         (uchar *) statement->query(),
+                                         statement->query_length())))
+  {
+    my_hash_delete(&closed_hash, (uchar *) old);
+    dec_prepared_stmt_count(1);
+  }
+  if (my_hash_insert(&closed_hash, (uchar *) statement))
+  {
+    delete statement;
+    dec_prepared_stmt_count(1);
+    return;
+  }
+  closed_list.push_back(statement);
+  trim_closed(max_count);
+}
+
+
+Statement *Statement_map::take_closed(const char *query, size_t length)
+{
+  Statement *statement;
+  if ((statement= (Statement *) my_hash_search(&closed_hash, (uchar *) query,
+                                               length)))
+  {
+    statement->unlink();
+    hash_delete_keep(&closed_hash, (uchar *) statement);
+    /* insert() counts it again */
+    dec_prepared_stmt_count(1);
+  }
+  return statement;
+}
+
+
+void Statement_map::trim_closed(ulong max_count)
+{
+  ulong count= 0;
+  while (closed_hash.records > max_count)
+  {
+    /* Statement destructor unlinks it from closed_list */
+    my_hash_delete(&closed_hash, (uchar *) closed_list.head());
+    count++;
+  }
+  if (count)
+    dec_prepared_stmt_count(count);
+}
+
+
+void Statement_map::dec_prepared_stmt_count(ulong count)
 {
-  /* Must be first, hash_free will reset st_hash.records */
   mysql_mutex_lock(&LOCK_prepared_stmt_count);
-  DBUG_ASSERT(prepared_stmt_count >= st_hash.records);
-  prepared_stmt_count-= st_hash.records;
+  DBUG_ASSERT(prepared_stmt_count >= count);
+  prepared_stmt_count-= count;
   mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+}
+
+
+void Statement_map::reset()
+{
+  /* Must be first, hash_free will reset st_hash.records */
+  dec_prepared_stmt_count(st_hash.records + closed_hash.records);
 
   my_hash_reset(&names_hash);
   my_hash_reset(&st_hash);
+  my_hash_reset(&closed_hash);
   last_found_statement= 0;
 }
 
@@ -3869,13 +4122,11 @@ void Statement_map::reset()
 Statement_map::~Statement_map()
 {
   /* Must go first, hash_free will reset st_hash.records */
-  mysql_mutex_lock(&LOCK_prepared_stmt_count);
-  DBUG_ASSERT(prepared_stmt_count >= st_hash.records);
-  prepared_stmt_count-= st_hash.records;
-  mysql_mutex_unlock(&LOCK_prepared_stmt_count);
+  dec_prepared_stmt_count(st_hash.records + closed_hash.records);
 
   my_hash_free(&names_hash);
   my_hash_free(&st_hash);
+  my_hash_free(&closed_hash);
 }
 
 bool my_var_user::set(THD *thd, Item *item)
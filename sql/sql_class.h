@@ -397,6 +397,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -405,12 +406,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* The query cache instance 'first_query_block' belongs to */
+  Query_cache *cache;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), cache(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -554,6 +557,7 @@ typedef struct system_variables
   ulong auto_increment_increment, auto_increment_offset;
   ulong lock_wait_timeout;
   ulong join_cache_level;
+  ulong join_cache_spill_partitions;
   ulong max_allowed_packet;
   ulong max_error_count;
   ulong max_length_for_sort_data;
@@ -563,6 +567,7 @@ typedef struct system_variables
   ulong min_examined_row_limit;
   ulong multi_range_count;
   ulong net_buffer_length;
+  ulong net_compression_level;
   ulong net_interactive_timeout;
   ulong net_read_timeout;
   ulong net_retry_count;
@@ -576,10 +581,13 @@ typedef struct system_variables
   ulong histogram_size;
   ulong histogram_type;
   ulong preload_buff_size;
+  ulong prepared_stmt_cache_size;
   ulong profiling_history_size;
   ulong read_buff_size;
   ulong read_rnd_buff_size;
   ulong mrr_buff_size;
+  ulong sort_threads;
+  ulong parallel_scan_threads;
   ulong div_precincrement;
   /* Total size of all buffers used by the subselect_rowid_merge_engine. */
   ulong rowid_merge_buff_size;
@@ -665,6 +673,7 @@ typedef struct system_variables
   Time_zone *time_zone;
 
   my_bool sysdate_is_now;
+  my_bool prepared_stmt_plan_cache;
 
   /* deadlock detection */
   ulong wt_timeout_short, wt_deadlock_search_depth_short;
@@ -743,6 +752,8 @@ typedef struct system_status_var
   ulong opened_tables;
   ulong opened_shares;
   ulong opened_views;               /* +1 opening a view */
+  ulong ps_plan_cache_hits;         /* join order reused by a PS execute */
+  ulong ps_cache_hits;              /* closed PS reused by a prepare */
 
   ulong select_full_join_count_;
   ulong select_full_range_join_count_;
@@ -822,6 +833,16 @@ void add_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var);
 void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
                         STATUS_VAR *dec_var);
 
+/*
+  Number of partitions that running threads publish their status to,
+  see THD::publish_status()
+*/
+#define STATUS_VAR_PARTITIONS 32
+
+void init_status_var_partitions();
+void destroy_status_var_partitions();
+void add_published_status(STATUS_VAR *to_var);
+
 /*
   Update global_memory_used. We have to do this with atomic_add as the
   global value can change outside of LOCK_status.
@@ -1143,14 +1164,30 @@ class Statement_map
   */
   void close_transient_cursors();
   void erase(Statement *statement);
+  /*
+    Take a closed statement out of the map but keep it, so that a later
+    prepare of the same text can reuse it (see prepared_stmt_cache_size).
+    At most max_count closed statements are kept, the oldest go first.
+    Kept statements count in prepared_stmt_count, and are dropped when a
+    new statement of this connection would exceed max_prepared_stmt_count.
+  */
+  void keep_closed(Statement *statement, ulong max_count);
+  /* Remove a kept closed statement with this text from the map */
+  Statement *take_closed(const char *query, size_t length);
+  void trim_closed(ulong max_count);
   /* Erase all statements (calls Statement destructor) */
   void reset();
   ~Statement_map();
 private:
   HASH st_hash;
   HASH names_hash;
+  /* Closed statements by their text, oldest first in closed_list */
+  HASH closed_hash;
+  I_List<Statement> closed_list;
   I_List<Statement> transient_cursor_list;
   Statement *last_found_statement;
+
+  void dec_prepared_stmt_count(ulong count);
 };
 
 struct st_savepoint {
@@ -1962,6 +1999,11 @@ class THD :public Statement,
   struct  system_variables variables;	// Changeable local variables
   struct  system_status_var status_var; // Per thread statistic vars
   struct  system_status_var org_status_var; // For user statistics
+  /*
+    status_var as it was when last published to the global status.
+    The difference to status_var is not yet part of the global status.
+  */
+  struct  system_status_var published_status_var;
   struct  system_status_var *initial_status_var; /* used by show status */
   THR_LOCK_INFO lock_info;              // Locking info of this thread
   /**
@@ -3860,11 +3902,17 @@ class THD :public Statement,
   /* Wake this thread up from wait_for_wakeup_ready(). */
   void signal_wakeup_ready();
 
+  void publish_status();
   void add_status_to_global()
   {
     DBUG_ASSERT(status_in_global == 0);
     mysql_mutex_lock(&LOCK_status);
-    add_to_status(&global_status_var, &status_var);
+    add_diff_to_status(&global_status_var, &status_var,
+                       &published_status_var);
+    /* Memory of this thread is no longer part of the global status */
+    global_status_var.local_memory_used-=
+      published_status_var.local_memory_used;
+    update_global_memory_status(status_var.global_memory_used);
     /* Mark that this THD status has already been added in global status */
     status_var.global_memory_used= 0;
     status_in_global= 1;
@@ -4063,6 +4111,87 @@ class THD :public Statement,
 };
 
 
+#define THD_LIST_PARTITIONS 16
+
+/**
+  The list of all THDs in the server, for SHOW PROCESSLIST, KILL,
+  shutdown and the like.
+
+  The list is split into partitions, each with its own mutex, so that
+  threads connecting and disconnecting at the same time seldom wait for
+  each other. A THD is kept in the partition given by its address, which
+  doesn't change while it is in the list.
+
+  A THD is not deleted while the partition it is in is locked. To keep
+  using it after that, lock its LOCK_thd_data before releasing the
+  partition, as deleting a THD waits for LOCK_thd_data.
+
+  Lock order is LOCK_thread_count, then a partition lock, then
+  LOCK_thd_data. Only one partition is locked at a time.
+
+  LOCK_thread_count doesn't protect the list; walk it only with
+  THD_list_iterator, which holds the lock of the partition it is in.
+*/
+
+class THD_list
+{
+  struct Partition
+  {
+    mysql_mutex_t lock;
+    I_List<THD> threads;
+  } partitions[THD_LIST_PARTITIONS];
+
+  Partition *partition_of(THD *thd)
+  {
+    return &partitions[((size_t) thd / sizeof(THD)) % THD_LIST_PARTITIONS];
+  }
+
+public:
+  void init();
+  void destroy();
+  void insert(THD *thd);
+  void erase(THD *thd);
+  bool is_empty();
+
+  friend class THD_list_iterator;
+};
+
+
+/**
+  Iterate over all THDs in a THD_list.
+
+  The partition of the THD last returned is locked until the next
+  partition is entered, release() is called or the iterator goes out of
+  scope; THDs may be added to or removed from the other partitions
+  meanwhile.
+*/
+
+class THD_list_iterator
+{
+  THD_list *list;
+  uint partition;
+  I_List_iterator<THD> it;
+public:
+  THD_list_iterator(THD_list &list_arg)
+    :list(&list_arg), partition(0), it(list_arg.partitions[0].threads)
+  {
+    mysql_mutex_lock(&list->partitions[0].lock);
+  }
+  ~THD_list_iterator() { release(); }
+  THD *operator++(int);
+  void release()
+  {
+    if (partition < THD_LIST_PARTITIONS)
+    {
+      mysql_mutex_unlock(&list->partitions[partition].lock);
+      partition= THD_LIST_PARTITIONS;
+    }
+  }
+};
+
+extern THD_list server_threads;
+
+
 /** A short cut for thd->get_stmt_da()->set_ok_status(). */
 
 inline void
@@ -5331,6 +5460,12 @@ class select_dumpvar :public select_result_interceptor {
 */
 #define CF_UPDATES_DATA (1U << 18)
 
+/**
+  Statement that returns no result set and so can be executed for an
+  array of parameter sets in one COM_STMT_EXECUTE (INSERT, UPDATE, DELETE)
+*/
+#define CF_PS_ARRAY_BINDING_SAFE (1U << 19)
+
 /* Bits in server_command_flags */
 
 /**
@@ -1179,7 +1179,10 @@ void prepare_new_connection_state(THD* thd)
   Security_context *sctx= thd->security_ctx;
 
   if (thd->client_capabilities & CLIENT_COMPRESS)
+  {
     thd->net.compress=1;				// Use compression
+    thd->net.compress_level= (uchar) thd->variables.net_compression_level;
+  }
 
   /*
     Much of this is duplicated in create_embedded_thd() for the
@@ -76,6 +76,10 @@
 
 #define MAX_SORT_MEMORY 2048*1024
 #define MIN_SORT_MEMORY 1024
+#define MAX_SORT_THREADS 64                     /* Max for @@sort_threads */
+#define MAX_JOIN_CACHE_SPILL_PARTITIONS 64
+#define MAX_PARALLEL_SCAN_THREADS 64            /* Max for @@parallel_scan_threads */
+#define MIN_ROWS_PER_SCAN_THREAD 10000
 
 /* Some portable defines */
 
@@ -18,11 +18,6 @@
 #include "sql_select.h"
 #include "sql_expression_cache.h"
 
-/**
-  Minimum hit ration to proceed on disk if in memory table overflowed.
-  hit_rate = hit / (miss + hit);
-*/
-#define EXPCACHE_MIN_HIT_RATE_FOR_DISK_TABLE 0.7
 /**
   Minimum hit ratio to keep in memory table (do not switch cache off)
   hit_rate = hit / (miss + hit);
@@ -33,6 +28,17 @@
   impact in the case when the cache is not applicable)
 */
 #define EXPCACHE_CHECK_HIT_RATIO_AFTER 200
+/**
+  Counters of the frequency sketch per cache entry, and the maximum
+  value of a counter
+*/
+#define EXPCACHE_SKETCH_COUNTERS_PER_ENTRY 4
+#define EXPCACHE_SKETCH_MAX_COUNT 15
+/**
+  The counters of the sketch are halved after this many lookups per
+  cache entry, so that the parameters that were hot long ago are evicted
+*/
+#define EXPCACHE_SKETCH_RESET_PER_ENTRY 10
 
 /*
   Expression cache is used only for caching subqueries now, so its statistic
@@ -44,9 +50,11 @@ Expression_cache_tmptable::Expression_cache_tmptable(THD *thd,
                                                      List<Item> &dependants,
                                                      Item *value)
   :cache_table(NULL), table_thd(thd), tracker(NULL), items(dependants), val(value),
-   hit(0), miss(0), inited (0)
+   hit(0), miss(0), evictions(0), clock_hand(0), last_key_hash(0),
+   sketch(NULL), inited (0), full(0)
 {
   DBUG_ENTER("Expression_cache_tmptable::Expression_cache_tmptable");
+  bzero(&entries, sizeof(entries));
   DBUG_VOID_RETURN;
 };
 
@@ -61,6 +69,9 @@ void Expression_cache_tmptable::disable_cache()
     cache_table->file->ha_index_end();
   free_tmp_table(table_thd, cache_table);
   cache_table= NULL;
+  delete_dynamic(&entries);
+  my_free(sketch);
+  sketch= NULL;
   update_tracker();
   if (tracker)
     tracker->cache= NULL;
@@ -96,6 +107,7 @@ void Expression_cache_tmptable::init()
 {
   List_iterator<Item> li(items);
   Item_iterator_list it(li);
+  Item *slot;
   uint field_counter;
   DBUG_ENTER("Expression_cache_tmptable::init");
   DBUG_ASSERT(!inited);
@@ -108,7 +120,10 @@ void Expression_cache_tmptable::init()
     DBUG_VOID_RETURN;
   }
 
-  /* add result field */
+  /* add result field and entry number field */
+  if (!(slot= new (table_thd->mem_root) Item_int(table_thd, (int32) 0)))
+    DBUG_VOID_RETURN;
+  items.push_front(slot);
   items.push_front(val);
 
   cache_table_param.init();
@@ -137,13 +152,13 @@ void Expression_cache_tmptable::init()
     goto error;
   }
 
-  field_counter= 1;
+  field_counter= 2;
 
   if (cache_table->alloc_keys(1) ||
-      cache_table->add_tmp_key(0, items.elements - 1, &field_enumerator,
+      cache_table->add_tmp_key(0, items.elements - 2, &field_enumerator,
                                 (uchar*)&field_counter, TRUE) ||
       ref.tmp_table_index_lookup_init(table_thd, cache_table->key_info, it,
-                                      TRUE, 1 /* skip result field*/))
+                                      TRUE, 2 /* skip result and entry */))
   {
     DBUG_PRINT("error", ("creating index failed"));
     goto error;
@@ -168,6 +183,11 @@ void Expression_cache_tmptable::init()
     goto error;
   }
 
+  if (my_init_dynamic_array(&entries, ALIGN_SIZE(sizeof(Entry)) +
+                            cache_table->file->ref_length,
+                            64, 64, MYF(MY_THREAD_SPECIFIC)))
+    goto error;
+
   update_tracker();
   DBUG_VOID_RETURN;
 
@@ -193,6 +213,118 @@ Expression_cache_tmptable::~Expression_cache_tmptable()
 }
 
 
+/**
+  Hash of the parameters of the last lookup, from the search key
+*/
+
+uint32 Expression_cache_tmptable::key_hash()
+{
+  ulong nr1= 1, nr2= 4;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, ref.key_buff,
+                                 ref.key_length, &nr1, &nr2);
+  return (uint32) nr1;
+}
+
+
+/**
+  Estimate how often the parameters with the given hash were looked up
+
+  @details
+  This is a count-min sketch: every key has EXPCACHE_SKETCH_COUNTERS_PER_ENTRY
+  counters, which may be shared with other keys, and the estimate is the
+  smallest of them.
+*/
+
+uint Expression_cache_tmptable::sketch_estimate(uint32 hash)
+{
+  uint32 step= (hash >> 17) | 1;
+  uint estimate= EXPCACHE_SKETCH_MAX_COUNT;
+  for (uint i= 0; i < EXPCACHE_SKETCH_COUNTERS_PER_ENTRY; i++, hash+= step)
+    set_if_smaller(estimate, sketch[hash & sketch_mask]);
+  return estimate;
+}
+
+
+void Expression_cache_tmptable::sketch_add(uint32 hash)
+{
+  uint estimate= sketch_estimate(hash);
+  uint32 step= (hash >> 17) | 1;
+  if (estimate < EXPCACHE_SKETCH_MAX_COUNT)
+  {
+    /* Increment only the smallest counters (conservative update) */
+    for (uint i= 0; i < EXPCACHE_SKETCH_COUNTERS_PER_ENTRY; i++, hash+= step)
+    {
+      if (sketch[hash & sketch_mask] == estimate)
+        sketch[hash & sketch_mask]++;
+    }
+  }
+  if (++sketch_additions == sketch_reset_after)
+  {
+    for (uint32 i= 0; i <= sketch_mask; i++)
+      sketch[i]>>= 1;
+    sketch_additions= 0;
+  }
+}
+
+
+/**
+  Switch the cache to replacement of entries, as the table is full
+
+  @retval FALSE OK
+  @retval TRUE  The cache can not replace entries, it was disabled
+*/
+
+bool Expression_cache_tmptable::start_replacement()
+{
+  uint capacity= entries.elements;
+  uint32 size= 64;
+  DBUG_ENTER("Expression_cache_tmptable::start_replacement");
+  DBUG_PRINT("info", ("cache is full with %u entries", capacity));
+
+  while (size < capacity * EXPCACHE_SKETCH_COUNTERS_PER_ENTRY)
+    size<<= 1;
+  if (!capacity ||
+      !(sketch= (uchar*) my_malloc(size, MYF(MY_THREAD_SPECIFIC |
+                                             MY_ZEROFILL))))
+  {
+    disable_cache();
+    DBUG_RETURN(TRUE);
+  }
+  sketch_mask= size - 1;
+  sketch_additions= 0;
+  sketch_reset_after= (ulong) capacity * EXPCACHE_SKETCH_RESET_PER_ENTRY;
+  clock_hand= 0;
+  full= TRUE;
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Find the entry to replace by the CLOCK algorithm
+
+  @details
+  The hand goes over the entries, clearing their 'referenced' flag, and
+  stops at the first entry that has not been hit since the hand passed it
+  the last time.
+
+  @return number of the entry
+*/
+
+uint Expression_cache_tmptable::find_victim()
+{
+  for (;;)
+  {
+    Entry *e= entry(clock_hand);
+    uint victim= clock_hand;
+    if (++clock_hand == entries.elements)
+      clock_hand= 0;
+    if (!e->referenced)
+      return victim;
+    e->referenced= FALSE;
+  }
+}
+
+
 /**
   Check if a given set of parameters of the expression is in the cache
 
@@ -220,6 +352,15 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
     if ((res= join_read_key2(table_thd, NULL, cache_table, &ref)) == 1)
       DBUG_RETURN(ERROR);
 
+    /*
+      put_value() stores the hash with the entry, also before the cache is
+      full, so that the admission test can compare against it later
+    */
+    if (res || full)
+      last_key_hash= key_hash();
+    if (full)
+      sketch_add(last_key_hash);
+
     if (res)
     {
       if (((++miss) == EXPCACHE_CHECK_HIT_RATIO_AFTER) &&
@@ -235,6 +376,7 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
     }
 
     hit++;
+    entry((uint) cache_table->field[1]->val_int())->referenced= TRUE;
     *value= cached_result;
     DBUG_RETURN(Expression_cache::HIT);
   }
@@ -258,6 +400,8 @@ Expression_cache::result Expression_cache_tmptable::check_value(Item **value)
 my_bool Expression_cache_tmptable::put_value(Item *value)
 {
   int error;
+  uint slot;
+  Entry *e;
   DBUG_ENTER("Expression_cache_tmptable::put_value");
   DBUG_ASSERT(inited);
 
@@ -267,16 +411,46 @@ my_bool Expression_cache_tmptable::put_value(Item *value)
     DBUG_RETURN(FALSE);
   }
 
+  if (full)
+  {
+    slot= find_victim();
+    e= entry(slot);
+    /* Admit the new result only if it is more popular than the victim */
+    if (sketch_estimate(last_key_hash) <= sketch_estimate(e->key_hash))
+    {
+      DBUG_PRINT("info", ("new entry is not admitted"));
+      DBUG_RETURN(FALSE);
+    }
+    if ((error= cache_table->file->ha_rnd_pos(cache_table->record[1],
+                                              entry_pos(e))) ||
+        (error= cache_table->file->ha_delete_row(cache_table->record[1])))
+    {
+      cache_table->file->print_error(error, MYF(0));
+      goto err;
+    }
+    evictions++;
+  }
+  else
+    slot= entries.elements;
+
   *(items.head_ref())= value;
   fill_record(table_thd, cache_table, cache_table->field, items, TRUE, TRUE);
   if (table_thd->is_error())
     goto err;;
+  cache_table->field[1]->store((longlong) slot, TRUE);
 
   if ((error= cache_table->file->ha_write_tmp_row(cache_table->record[0])))
   {
-    /* create_myisam_from_heap will generate error if needed */
-    if (cache_table->file->is_fatal_error(error, HA_CHECK_DUP))
+    /* Only "table is full" is expected here */
+    if (error != HA_ERR_RECORD_FILE_FULL &&
+        cache_table->file->is_fatal_error(error, HA_CHECK_DUP))
       goto err;
+    else if (full)
+    {
+      DBUG_PRINT("info", ("no room for the entry that replaces the victim"));
+      disable_cache();
+      DBUG_RETURN(FALSE);
+    }
     else
     {
       double hit_rate= ((double)hit / ((double)hit + miss));
@@ -285,25 +459,26 @@ my_bool Expression_cache_tmptable::put_value(Item *value)
       {
         DBUG_PRINT("info", ("hit rate is not so good to keep the cache"));
         disable_cache();
-        DBUG_RETURN(FALSE);
-      }
-      else if (hit_rate < EXPCACHE_MIN_HIT_RATE_FOR_DISK_TABLE)
-      {
-        DBUG_PRINT("info", ("hit rate is not so good to go to disk"));
-        if (cache_table->file->ha_delete_all_rows() ||
-            cache_table->file->ha_write_tmp_row(cache_table->record[0]))
-          goto err;
       }
       else
-      {
-        if (create_internal_tmp_table_from_heap(table_thd, cache_table,
-                                                cache_table_param.start_recinfo,
-                                                &cache_table_param.recinfo,
-                                                error, 1, NULL))
-          goto err;
-      }
+        start_replacement();
+      /* The result is not cached, the next miss may replace an entry */
+      DBUG_RETURN(FALSE);
     }
   }
+
+  if (!full)
+  {
+    if (!(e= (Entry*) alloc_dynamic(&entries)))
+      goto err;
+  }
+  else
+    e= entry(slot);
+  cache_table->file->position(cache_table->record[0]);
+  memcpy(entry_pos(e), cache_table->file->ref, cache_table->file->ref_length);
+  e->key_hash= last_key_hash;
+  e->referenced= FALSE;
+
   cache_table->status= 0; /* cache_table->record contains an existed record */
   ref.has_record= TRUE; /* the same as above */
   DBUG_PRINT("info", ("has_record: TRUE  status: 0"));
@@ -324,6 +499,7 @@ void Expression_cache_tmptable::print(String *str, enum_query_type query_type)
 
   str->append('<');
   li++;  // skip result field
+  li++;  // skip entry number field
   while ((item= li++))
   {
     if (!is_first)
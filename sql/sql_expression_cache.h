@@ -80,16 +80,16 @@ class Expression_cache_tracker :public Sql_alloc
 public:
   enum expr_cache_state {UNINITED, STOPPED, OK};
   Expression_cache_tracker(Expression_cache *c) :
-    cache(c), hit(0), miss(0), state(UNINITED)
+    cache(c), hit(0), miss(0), evictions(0), state(UNINITED)
   {}
 
   Expression_cache *cache;
-  ulong hit, miss;
+  ulong hit, miss, evictions;
   enum expr_cache_state state;
 
   static const char* state_str[3];
-  void set(ulong h, ulong m, enum expr_cache_state s)
-  {hit= h; miss= m; state= s;}
+  void set(ulong h, ulong m, ulong e, enum expr_cache_state s)
+  {hit= h; miss= m; evictions= e; state= s;}
 
   void fetch_current_stats()
   {
@@ -101,6 +101,16 @@ class Expression_cache_tracker :public Sql_alloc
 
 /**
   Implementation of expression cache over a temporary table
+
+  @details
+  The cache is a HEAP table with the result, the number of the entry and
+  the parameters, and a unique index over the parameters. When the table
+  reaches its size limit, new results replace old ones: the victim is
+  chosen by the CLOCK algorithm (entries that had a hit since the hand
+  last passed them get a second chance), and a new result is only
+  admitted if its parameters were looked up more often than those of the
+  victim, according to a small frequency sketch. So the cache keeps the
+  hot parameter values of a skewed distribution.
 */
 
 class Expression_cache_tmptable :public Expression_cache
@@ -124,7 +134,7 @@ class Expression_cache_tmptable :public Expression_cache
   {
     if (tracker)
     {
-      tracker->set(hit, miss, (inited ? (cache_table ?
+      tracker->set(hit, miss, evictions, (inited ? (cache_table ?
                                          Expression_cache_tracker::OK :
                                          Expression_cache_tracker::STOPPED) :
                                Expression_cache_tracker::UNINITED));
@@ -132,7 +142,22 @@ class Expression_cache_tmptable :public Expression_cache
   }
 
 private:
+  /* An entry of the cache, for replacement */
+  struct Entry
+  {
+    uint32 key_hash;                    /* Hash of the parameters */
+    bool referenced;                    /* Hit since the hand passed */
+  };
+
   void disable_cache();
+  uint32 key_hash();
+  Entry *entry(uint idx)
+  { return (Entry*) dynamic_array_ptr(&entries, idx); }
+  uchar *entry_pos(Entry *e) { return ((uchar*) e) + ALIGN_SIZE(sizeof(Entry)); }
+  bool start_replacement();
+  uint find_victim();
+  uint sketch_estimate(uint32 hash);
+  void sketch_add(uint32 hash);
 
   /* tmp table parameters */
   TMP_TABLE_PARAM cache_table_param;
@@ -152,8 +177,22 @@ class Expression_cache_tmptable :public Expression_cache
   Item *val;
   /* hit/miss counters */
   ulong hit, miss;
+  /* Number of results replaced by other ones */
+  ulong evictions;
+  /* Entries in the order they were created, followed by the row position */
+  DYNAMIC_ARRAY entries;
+  /* Position of the CLOCK hand in 'entries' */
+  uint clock_hand;
+  /* Hash of the parameters of the last check_value() */
+  uint32 last_key_hash;
+  /* Frequency sketch: 4 small counters per key, halved periodically */
+  uchar *sketch;
+  uint32 sketch_mask;
+  ulong sketch_additions, sketch_reset_after;
   /* Set on if the object has been succesfully initialized with init() */
   bool inited;
+  /* Set on when the table is full and entries are replaced */
+  bool full;
 };
 
 #endif /* SQL_EXPRESSION_CACHE_INCLUDED */
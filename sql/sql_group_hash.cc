@@ -0,0 +1,439 @@
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "sql_group_hash.h"
+
+/* Number of entries allocated at first, doubled when they are all used */
+#define GROUP_HASH_MIN_ENTRIES 64
+
+
+/*
+  Check if the groups of a join can be collected in a Group_hash
+
+  SYNOPSIS
+    Group_hash::is_applicable()
+      join     The join that writes the groups
+      table    The temporary table, with a key over the group columns
+
+  NOTES
+    The caller has already chosen end_update() to write the groups.
+*/
+
+bool Group_hash::is_applicable(JOIN *join, TABLE *table)
+{
+  return (optimizer_flag(join->thd, OPTIMIZER_SWITCH_HASH_GROUP_BY) &&
+          table->group && table->s->keys && !table->s->blob_fields &&
+          table->key_info[0].user_defined_key_parts ==
+          join->tmp_table_param.group_parts);
+}
+
+
+/*
+  Set up the hash for the groups written to a temporary table
+
+  SYNOPSIS
+    Group_hash::init()
+      join       The join that writes the groups
+      table_arg  The temporary table
+
+  RETURN
+    FALSE  OK
+    TRUE   Out of memory, end_update() must be used
+*/
+
+bool Group_hash::init(JOIN *join, TABLE *table_arg)
+{
+  THD *thd= join->thd;
+  KEY_PART_INFO *key_part;
+  Key_part *part;
+  uint parts= join->tmp_table_param.group_parts;
+  DBUG_ENTER("Group_hash::init");
+
+  free();
+  table= table_arg;
+  param= &join->tmp_table_param;
+  key_length= param->group_length;
+  rec_length= table->s->reclength;
+  entry_length= ALIGN_SIZE(4 + key_length + rec_length);
+  max_memory= (size_t) MY_MIN(thd->variables.tmp_table_size,
+                              thd->variables.max_heap_table_size);
+  entry_count= max_entries= 0;
+  bzero(partition_entries, sizeof(partition_entries));
+  spilled= 0;
+  converted= FALSE;
+
+  if (!my_multi_malloc(MYF(MY_THREAD_SPECIFIC | MY_WME),
+                       &key_parts, sizeof(Key_part) * parts,
+                       &save_record, rec_length,
+                       NullS))
+    DBUG_RETURN(TRUE);
+  key_parts_end= key_parts + parts;
+
+  for (part= key_parts, key_part= table->key_info[0].key_part;
+       part < key_parts_end;
+       part++, key_part++)
+  {
+    part->length= key_part->length;
+    part->maybe_null= MY_TEST(key_part->null_bit);
+    part->pack_length= 0;
+    switch (key_part->type) {
+    case HA_KEYTYPE_TEXT:
+      part->cs= key_part->field->charset();
+      break;
+    case HA_KEYTYPE_BINARY:
+      part->cs= &my_charset_bin;
+      break;
+    case HA_KEYTYPE_VARTEXT1:
+    case HA_KEYTYPE_VARTEXT2:
+      part->cs= key_part->field->charset();
+      part->pack_length= HA_KEY_BLOB_LENGTH;
+      break;
+    case HA_KEYTYPE_VARBINARY1:
+    case HA_KEYTYPE_VARBINARY2:
+      part->cs= &my_charset_bin;
+      part->pack_length= HA_KEY_BLOB_LENGTH;
+      break;
+    default:
+      part->cs= NULL;
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+void Group_hash::free()
+{
+  my_free(key_parts);
+  my_free(entries);
+  my_free(slots);
+  key_parts= NULL;
+  entries= NULL;
+  slots= NULL;
+}
+
+
+/*
+  Calculate the hash value of a group key
+
+  NOTES
+    Strings are hashed by their collation, so that the groups that are
+    equal by key_eq() have the same hash value.
+*/
+
+uint32 Group_hash::hash_key(const uchar *key) const
+{
+  ulong nr1= 1, nr2= 4;
+  uint32 hash;
+
+  for (Key_part *part= key_parts; part < key_parts_end; part++)
+  {
+    if (part->maybe_null && *key++)
+    {
+      nr1^= (nr1 << 1) | 1;
+      key+= part->pack_length + part->length;
+      continue;
+    }
+    if (part->cs)
+    {
+      uint length= part->pack_length ? uint2korr(key) : part->length;
+      part->cs->coll->hash_sort(part->cs, key + part->pack_length, length,
+                                &nr1, &nr2);
+    }
+    else
+      my_charset_bin.coll->hash_sort(&my_charset_bin, key, part->length,
+                                     &nr1, &nr2);
+    key+= part->pack_length + part->length;
+  }
+
+  /* Mix the bits, as the high bits give the partition */
+  hash= (uint32) nr1;
+  hash^= hash >> 16;
+  hash*= 0x85ebca6b;
+  hash^= hash >> 13;
+  hash*= 0xc2b2ae35;
+  hash^= hash >> 16;
+  return hash;
+}
+
+
+bool Group_hash::key_eq(const uchar *key1, const uchar *key2) const
+{
+  for (Key_part *part= key_parts; part < key_parts_end; part++)
+  {
+    if (part->maybe_null)
+    {
+      if (*key1 != *key2)
+        return FALSE;
+      if (*key1)
+      {
+        key1+= 1 + part->pack_length + part->length;
+        key2+= 1 + part->pack_length + part->length;
+        continue;
+      }
+      key1++;
+      key2++;
+    }
+    if (part->cs)
+    {
+      uint length1= part->length, length2= part->length;
+      if (part->pack_length)
+      {
+        length1= uint2korr(key1);
+        length2= uint2korr(key2);
+      }
+      /* In GROUP BY 'a' and 'a ' are equal */
+      if (part->cs->coll->strnncollsp(part->cs,
+                                      key1 + part->pack_length, length1,
+                                      key2 + part->pack_length, length2, 0))
+        return FALSE;
+    }
+    else if (memcmp(key1, key2, part->length))
+      return FALSE;
+    key1+= part->pack_length + part->length;
+    key2+= part->pack_length + part->length;
+  }
+  return TRUE;
+}
+
+
+/*
+  Find the group with the given key
+
+  RETURN
+    NULL  The group is not in the hash
+    #     The record of the temporary table for the group
+*/
+
+uchar *Group_hash::find(const uchar *key, uint32 hash)
+{
+  uint32 idx;
+  uint32 slot;
+
+  if (!slots)
+    return NULL;
+  for (idx= hash & slot_mask; (slot= slots[idx]); idx= (idx + 1) & slot_mask)
+  {
+    uchar *e= entry(slot - 1);
+    if (uint4korr(e) == hash && key_eq(e + 4, key))
+      return entry_record(e);
+  }
+  return NULL;
+}
+
+
+/* Put all entries into the open addressing slots */
+
+void Group_hash::build_slots()
+{
+  bzero(slots, (slot_mask + 1) * sizeof(uint32));
+  for (uint i= 0; i < entry_count; i++)
+  {
+    uint32 idx= uint4korr(entry(i)) & slot_mask;
+    while (slots[idx])
+      idx= (idx + 1) & slot_mask;
+    slots[idx]= i + 1;
+  }
+}
+
+
+/*
+  Make room for more entries
+
+  RETURN
+    FALSE  OK
+    TRUE   The entries would take more than max_memory (or out of memory)
+*/
+
+bool Group_hash::grow()
+{
+  uint new_max= max_entries ? max_entries * 2 : GROUP_HASH_MIN_ENTRIES;
+  uint32 slot_count= 1;
+  uchar *new_entries;
+  uint32 *new_slots;
+
+  /* At most half of the slots are used */
+  while (slot_count < new_max * 2)
+    slot_count<<= 1;
+  if ((double) new_max * entry_length + slot_count * sizeof(uint32) >
+      (double) max_memory)
+    return TRUE;
+
+  if (!(new_slots= (uint32*) my_malloc(slot_count * sizeof(uint32),
+                                       MYF(MY_THREAD_SPECIFIC))))
+    return TRUE;
+  if (!(new_entries= (uchar*) my_realloc(entries,
+                                         (size_t) new_max * entry_length,
+                                         MYF(MY_THREAD_SPECIFIC |
+                                             MY_ALLOW_ZERO_PTR))))
+  {
+    my_free(new_slots);
+    return TRUE;
+  }
+  my_free(slots);
+  entries= new_entries;
+  slots= new_slots;
+  slot_mask= slot_count - 1;
+  max_entries= new_max;
+  build_slots();
+  return FALSE;
+}
+
+
+/*
+  Add a new group
+
+  SYNOPSIS
+    Group_hash::add()
+      key     The group key
+      hash    hash_key() of the key
+      rec     OUT: where to store the record of the temporary table
+
+  DESCRIPTION
+    If there is no room for the group, the biggest partition is written
+    to the temporary table. This may be the partition of the new group,
+    which must then be written by spill_select.
+
+  RETURN
+    0   The group was added
+    1   The partition of the group has been spilled
+    -1  Error writing the temporary table
+*/
+
+int Group_hash::add(const uchar *key, uint32 hash, uchar **rec)
+{
+  uchar *e;
+  uint32 idx;
+  DBUG_ASSERT(!is_spilled(hash));
+
+  while (entry_count == max_entries && grow())
+  {
+    uint part= partition(hash);
+    for (uint i= 0; i < GROUP_HASH_PARTITIONS; i++)
+    {
+      if (partition_entries[i] > partition_entries[part])
+        part= i;
+    }
+    if (spill_partition(part))
+      return -1;
+    if (is_spilled(hash))
+      return 1;
+  }
+
+  e= entry(entry_count);
+  int4store(e, hash);
+  memcpy(e + 4, key, key_length);
+  for (idx= hash & slot_mask; slots[idx]; idx= (idx + 1) & slot_mask)
+  {}
+  slots[idx]= ++entry_count;
+  partition_entries[partition(hash)]++;
+  *rec= entry_record(e);
+  return 0;
+}
+
+
+/*
+  Write the record of an entry to the temporary table
+
+  NOTES
+    If the in-memory table is full, it is converted to an on-disk table,
+    like end_update() does.
+*/
+
+int Group_hash::write_entry(uchar *e)
+{
+  int error;
+  memcpy(table->record[0], entry_record(e), rec_length);
+  if ((error= table->file->ha_write_tmp_row(table->record[0])))
+  {
+    if (create_internal_tmp_table_from_heap(table->in_use, table,
+                                            param->start_recinfo,
+                                            &param->recinfo,
+                                            error, 0, NULL))
+      return -1;                                // Not a table_is_full error
+    converted= TRUE;
+  }
+  return 0;
+}
+
+
+/*
+  Move the groups of a partition to the temporary table
+
+  NOTES
+    The order of the remaining entries is kept, so that the groups are
+    written in the order they were found, as with end_update().
+*/
+
+int Group_hash::spill_partition(uint part)
+{
+  uint i, count= 0;
+  DBUG_ENTER("Group_hash::spill_partition");
+  DBUG_PRINT("info", ("partition %u with %u groups of %u",
+                      part, partition_entries[part], entry_count));
+
+  /* The record of the current row is in record[0] */
+  memcpy(save_record, table->record[0], rec_length);
+  for (i= 0; i < entry_count; i++)
+  {
+    uchar *e= entry(i);
+    if (partition(uint4korr(e)) == part)
+    {
+      if (write_entry(e))
+        DBUG_RETURN(-1);
+    }
+    else
+    {
+      if (count != i)
+        memcpy(entry(count), e, entry_length);
+      count++;
+    }
+  }
+  memcpy(table->record[0], save_record, rec_length);
+
+  entry_count= count;
+  partition_entries[part]= 0;
+  spilled|= 1U << part;
+  if (slots)
+    build_slots();
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Write all groups in memory to the temporary table
+
+  RETURN
+    0   OK
+    -1  Error
+*/
+
+int Group_hash::flush()
+{
+  DBUG_ENTER("Group_hash::flush");
+  for (uint i= 0; i < entry_count; i++)
+  {
+    if (write_entry(entry(i)))
+      DBUG_RETURN(-1);
+  }
+  entry_count= 0;
+  bzero(partition_entries, sizeof(partition_entries));
+  if (slots)
+    build_slots();
+  DBUG_RETURN(0);
+}
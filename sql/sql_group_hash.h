@@ -0,0 +1,100 @@
+#ifndef SQL_GROUP_HASH_INCLUDED
+#define SQL_GROUP_HASH_INCLUDED
+
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  In-memory hash aggregation for GROUP BY into a temporary table.
+
+  Instead of looking up the group of every row in the index of the
+  temporary table (end_update()), the groups are kept in an open
+  addressing hash table in memory. Every entry holds the group key and
+  the record of the temporary table with the state of the aggregate
+  functions, which is updated in place. The groups are written to the
+  temporary table only when all rows were read.
+
+  The groups are split into partitions by their hash value. When the
+  entries would take more than the size of an in-memory temporary table,
+  the biggest partition is written to the temporary table (which is
+  converted to an on-disk table if it gets full) and the rows of the
+  groups in that partition go to end_update() from then on. The other
+  partitions stay in memory.
+*/
+
+#define GROUP_HASH_PARTITIONS 16
+
+class Group_hash :public Sql_alloc
+{
+  /* A part of the group key, as stored by end_update() */
+  struct Key_part
+  {
+    CHARSET_INFO *cs;                   /* NULL if not a string */
+    uint16 length;
+    uint8 pack_length;                  /* Of the length of a VARCHAR */
+    bool maybe_null;
+  };
+
+  TABLE *table;
+  TMP_TABLE_PARAM *param;
+  Key_part *key_parts, *key_parts_end;
+  uint key_length;
+  uint rec_length;
+  uint entry_length;
+  size_t max_memory;
+  uchar *save_record;
+
+  uchar *entries;                       /* In the order of creation */
+  uint entry_count;
+  uint max_entries;
+  uint32 *slots;                        /* Entry number + 1, or 0 */
+  uint32 slot_mask;
+  uint partition_entries[GROUP_HASH_PARTITIONS];
+  uint spilled;                         /* Bitmap of spilled partitions */
+
+  /* An entry is: hash value, group key, record of the temporary table */
+  uchar *entry(uint idx) const
+  { return entries + (size_t) idx * entry_length; }
+  uchar *entry_record(uchar *e) const { return e + 4 + key_length; }
+  static uint partition(uint32 hash) { return hash >> 28; }
+
+  bool key_eq(const uchar *key1, const uchar *key2) const;
+  void build_slots();
+  bool grow();
+  int write_entry(uchar *e);
+  int spill_partition(uint part);
+
+public:
+  /* end_update() or end_unique_update(), for the spilled partitions */
+  Next_select_func spill_select;
+  /* The temporary table was converted to an on-disk table */
+  bool converted;
+
+  Group_hash() :key_parts(NULL), save_record(NULL), entries(NULL),
+    slots(NULL) {}
+  static bool is_applicable(JOIN *join, TABLE *table);
+  bool init(JOIN *join, TABLE *table_arg);
+  void free();
+
+  uint32 hash_key(const uchar *key) const;
+  bool is_spilled(uint32 hash) const
+  { return MY_TEST(spilled & (1U << partition(hash))); }
+  uchar *find(const uchar *key, uint32 hash);
+  int add(const uchar *key, uint32 hash, uchar **rec);
+  int flush();
+};
+
+#endif /* SQL_GROUP_HASH_INCLUDED */
@@ -2083,11 +2083,11 @@ class Delayed_insert :public ilink {
       close_thread_tables(&thd);
       thd.mdl_context.release_transactional_locks();
     }
+    server_threads.erase(&thd);
     mysql_mutex_lock(&LOCK_thread_count);
     mysql_mutex_destroy(&mutex);
     mysql_cond_destroy(&cond);
     mysql_cond_destroy(&cond_client);
-    thd.unlink();				// Must be unlinked under lock
     my_free(thd.query());
     thd.security_ctx->user= thd.security_ctx->host=0;
     delayed_insert_threads--;
@@ -2817,7 +2817,7 @@ pthread_handler_t handle_delayed_insert(void *arg)
   mysql_mutex_lock(&LOCK_thread_count);
   thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
   thd->set_current_time();
-  threads.append(thd);
+  server_threads.insert(thd);
   if (abort_loop)
     thd->killed= KILL_CONNECTION;
   else
@@ -3004,6 +3004,7 @@ pthread_handler_t handle_delayed_insert(void *arg)
           /* Some fatal error */
           thd->killed= KILL_CONNECTION;
         }
+        thd->publish_status();
       }
       di->status=0;
       if (!di->stacked_inserts && !di->tables_in_use && thd->lock)
@@ -34,6 +34,9 @@
 
 #define NO_MORE_RECORDS_IN_BUFFER  (uint)(-1)
 
+/* Size of the IO_CACHE buffer of a partition file of a spilling cache */
+#define JOIN_CACHE_SPILL_BUFFER_SIZE (IO_SIZE*4)
+
 static void save_or_restore_used_tabs(JOIN_TAB *join_tab, bool save);
 
 /*****************************************************************************
@@ -2276,7 +2279,15 @@ enum_nested_loop_state JOIN_CACHE::join_matching_records(bool skip_last)
     
     /* Prepare to read matching candidates from the join buffer */
     if (prepare_look_for_matches(skip_last))
+    {
+      /* A spilling BNLH cache could not write the record to disk */
+      if (join->thd->is_error())
+      {
+        rc= NESTED_LOOP_ERROR;
+        goto finish;
+      }
       continue;
+    }
     join_tab->jbuf_tracker->r_scans++;
 
     uchar *rec_ptr;
@@ -3653,6 +3664,8 @@ uchar *JOIN_CACHE_BNLH::get_matching_chain_by_join_key()
   KEY *keyinfo= join_tab->get_keyinfo_by_key_no(ref->key);
   /* Build the join key value out of the record in the record buffer */
   key_copy(key_buff, table->record[0], keyinfo, key_length, TRUE);
+  if (spill_state == SPILL_INNER && spill_join_tab_record(key_buff))
+    return 0;
   /* Look for this key in the join buffer */
   if (!key_search(key_buff, key_length, &key_ref_ptr))
     return 0;
@@ -3813,6 +3826,418 @@ int JOIN_CACHE_BNLH::init(bool for_explain)
 }
 
 
+/*
+  Check whether the BNLH join cache can spill its records to disk
+
+  SYNOPSIS
+    can_spill()
+
+  DESCRIPTION
+    The records are spilled as images of the record buffers of the tables
+    whose fields are stored in the join buffer. This is possible only for
+    a plain inner join where the join buffer is not linked to other join
+    buffers, no match flags are used, no rowids are needed and no table
+    has blob fields whose data is not in the record buffers.
+
+  RETURN VALUE
+    TRUE    the cache may spill
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::can_spill()
+{
+  JOIN_TAB *tab;
+
+  if (get_join_alg() != BNLH_JOIN_ALG ||
+      !join->thd->variables.join_cache_spill_partitions ||
+      prev_cache || next_cache || with_match_flag || blobs ||
+      join_tab->first_inner || join_tab->check_only_first_match() ||
+      join_tab->use_quick == 2 || join_tab->keep_current_rowid ||
+      join_tab->bush_children || join_tab->table->s->blob_fields)
+    return FALSE;
+
+  for (tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    if (tab->keep_current_rowid || tab->table->s->blob_fields)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Open the partition files of the BNLH join cache
+
+  SYNOPSIS
+    start_spilling()
+
+  DESCRIPTION
+    The function is called when the join buffer has been filled up for
+    the first time. If the cache may spill, the function creates the
+    partition files and sets spill_state to SPILL_INNER, so that the
+    records of join_tab are written into the partitions while the
+    buffer is joined.
+
+  RETURN VALUE
+    FALSE   the cache spills to disk from now on
+    TRUE    otherwise
+*/
+
+bool JOIN_CACHE_BNLH::start_spilling()
+{
+  uint i, files;
+  DBUG_ENTER("JOIN_CACHE_BNLH::start_spilling");
+
+  if (!can_spill())
+    DBUG_RETURN(TRUE);
+
+  spill_partitions= (uint) join->thd->variables.join_cache_spill_partitions;
+  files= spill_partitions * 2;
+  if (!(spill_files= (IO_CACHE*) my_malloc(sizeof(IO_CACHE) * files,
+                                           MYF(MY_WME | MY_ZEROFILL |
+                                               MY_THREAD_SPECIFIC))))
+  {
+    spill_partitions= 0;
+    DBUG_RETURN(TRUE);
+  }
+  for (i= 0; i < files; i++)
+  {
+    if (open_cached_file(spill_files + i, mysql_tmpdir, TEMP_PREFIX,
+                         JOIN_CACHE_SPILL_BUFFER_SIZE, MYF(0)))
+    {
+      end_spilling();
+      DBUG_RETURN(TRUE);
+    }
+  }
+  spill_state= SPILL_INNER;
+  DBUG_PRINT("info", ("partitions: %u", spill_partitions));
+  DBUG_RETURN(FALSE);
+}
+
+
+/* Close the partition files and stop spilling */
+
+void JOIN_CACHE_BNLH::end_spilling()
+{
+  if (spill_files)
+  {
+    for (uint i= 0; i < spill_partitions * 2; i++)
+      close_cached_file(spill_files + i);
+    my_free(spill_files);
+    spill_files= 0;
+  }
+  spill_partitions= 0;
+  spill_state= SPILL_NONE;
+}
+
+
+/*
+  Get the partition for a join key
+
+  DESCRIPTION
+    The hash value is scrambled because its remainder also selects the
+    entry in the hash table of the join buffer: otherwise the keys of one
+    partition would use only a part of the hash table.
+*/
+
+uint JOIN_CACHE_BNLH::get_spill_partition(uchar *key)
+{
+  ulong nr= key_hashnr(ref_key_info, ref_used_key_parts, key);
+  return (uint) (((nr * 2654435761UL) & 0xFFFFFFFFUL) >> 8) %
+         spill_partitions;
+}
+
+
+/*
+  Report an error on a partition file
+
+  DESCRIPTION
+    The partition files are opened without MY_WME, so that a full tmpdir
+    is reported as the error of the join.
+
+  RETURN VALUE
+    TRUE
+*/
+
+static bool report_spill_error(IO_CACHE *file, uint error)
+{
+  my_error(error, MYF(0), my_filename(file->file), my_errno);
+  return TRUE;
+}
+
+
+/*
+  Write the current partial join record into its partition file
+
+  DESCRIPTION
+    For every table whose fields are stored in the join buffer the
+    null_row flag and the record buffer are written.
+
+  RETURN VALUE
+    FALSE   the record has been written
+    TRUE    write error, ER_ERROR_ON_WRITE has been reported
+*/
+
+bool JOIN_CACHE_BNLH::spill_record()
+{
+  TABLE_REF *ref= &join_tab->ref;
+  IO_CACHE *file;
+  JOIN_TAB *tab;
+
+  cp_buffer_from_ref(join->thd, join_tab->table, ref);
+  file= spill_files + get_spill_partition(ref->key_buff);
+  for (tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    TABLE *table= tab->table;
+    uchar null_row= (uchar) table->null_row;
+    if (my_b_write(file, &null_row, 1) ||
+        my_b_write(file, table->record[0], table->s->reclength))
+      return report_spill_error(file, ER_ERROR_ON_WRITE);
+  }
+  return FALSE;
+}
+
+
+/*
+  Read a spilled partial join record back into the record buffers
+
+  RETURN VALUE
+    FALSE   the record has been read
+    TRUE    end of the partition file, or read error which has been
+            reported
+*/
+
+bool JOIN_CACHE_BNLH::read_spilled_record(IO_CACHE *file)
+{
+  JOIN_TAB *tab;
+
+  for (tab= start_tab; tab != join_tab;
+       tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+  {
+    TABLE *table= tab->table;
+    uchar null_row;
+    if (my_b_read(file, &null_row, 1) ||
+        my_b_read(file, table->record[0], table->s->reclength))
+    {
+      if (file->error == -1)
+        report_spill_error(file, ER_ERROR_ON_READ);
+      return TRUE;
+    }
+    table->null_row= null_row;
+  }
+  return FALSE;
+}
+
+
+/*
+  Write the record of join_tab with the join key 'key' into its partition
+
+  RETURN VALUE
+    FALSE   the record has been written
+    TRUE    write error, ER_ERROR_ON_WRITE has been reported
+*/
+
+bool JOIN_CACHE_BNLH::spill_join_tab_record(uchar *key)
+{
+  TABLE *table= join_tab->table;
+  IO_CACHE *file= spill_files + spill_partitions + get_spill_partition(key);
+  if (my_b_write(file, table->record[0], table->s->reclength))
+    return report_spill_error(file, ER_ERROR_ON_WRITE);
+  return FALSE;
+}
+
+
+/*
+  Add a record into the BNLH join buffer or into its partition on disk
+
+  SYNOPSIS
+    put_record()
+
+  DESCRIPTION
+    While the cache spills the partial join records to disk, the function
+    writes the record into its partition and reports that the buffer
+    is not full. Otherwise the record is put into the buffer. When the
+    buffer is filled up for the first time the cache starts spilling if
+    this is possible.
+
+  RETURN VALUE
+    TRUE    the buffer is full and its records have to be joined now, or
+            the record could not be written into its partition: then
+            join_records() fails the join
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::put_record()
+{
+  bool is_full;
+
+  if (spill_state == SPILL_OUTER)
+    return spill_record();
+  is_full= JOIN_CACHE_HASHED::put_record();
+  if (is_full && spill_state == SPILL_NONE)
+    start_spilling();
+  return is_full;
+}
+
+
+/*
+  Find matches from join_tab for records from the BNLH join buffer
+
+  SYNOPSIS
+    join_matching_records()
+      skip_last    do not look for matches for the last partial join record
+
+  DESCRIPTION
+    If the partial join records have been spilled to disk, the function
+    joins the partitions. Otherwise it scans join_tab as usual, and if
+    the records of join_tab have been written into the partitions during
+    the scan, the partial join records are spilled from now on.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_matching_records(bool skip_last)
+{
+  enum_nested_loop_state rc;
+
+  if (spill_state == SPILL_OUTER)
+    return join_spilled_records();
+
+  rc= JOIN_CACHE::join_matching_records(skip_last);
+  if (spill_state == SPILL_INNER)
+  {
+    if (rc == NESTED_LOOP_OK || rc == NESTED_LOOP_NO_MORE_ROWS)
+      spill_state= SPILL_OUTER;
+    else
+      end_spilling();
+  }
+  return rc;
+}
+
+
+/*
+  Join the spilled partial join records with the spilled records of join_tab
+
+  SYNOPSIS
+    join_spilled_records()
+
+  DESCRIPTION
+    The partial join records of every partition are loaded into the join
+    buffer and joined with the records of join_tab from the same partition,
+    which are read by a JOIN_TAB_SCAN_SPILLED object. If the records of a
+    partition do not fit into the buffer, they are joined in several
+    refills of the buffer. Partitions where one side is empty are skipped
+    as the join is an inner join. The partition files are closed at the
+    end.
+
+  RETURN VALUE
+    return one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_spilled_records()
+{
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  JOIN_TAB_SCAN *save_join_tab_scan= join_tab_scan;
+  DBUG_ENTER("JOIN_CACHE_BNLH::join_spilled_records");
+
+  for (uint part= 0; part < spill_partitions; part++)
+  {
+    IO_CACHE *file= spill_files + part;
+    IO_CACHE *join_tab_file= file + spill_partitions;
+    JOIN_TAB_SCAN_SPILLED spilled_scan(join, join_tab, join_tab_file);
+
+    if (join->thd->is_error())
+      break;
+    if (!my_b_tell(file) || !my_b_tell(join_tab_file))
+      continue;
+    /* This writes out the rest of the buffer */
+    if (reinit_io_cache(file, READ_CACHE, 0L, 0, 0))
+    {
+      report_spill_error(file, ER_ERROR_ON_WRITE);
+      break;
+    }
+
+    join_tab_scan= &spilled_scan;
+    reset(TRUE);
+    while (!read_spilled_record(file))
+    {
+      if (JOIN_CACHE_HASHED::put_record())
+      {
+        rc= JOIN_CACHE::join_matching_records(FALSE);
+        reset(TRUE);
+        if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+          goto finish;
+      }
+    }
+    if (join->thd->is_error())
+      break;
+    rc= JOIN_CACHE::join_matching_records(FALSE);
+    reset(TRUE);
+    if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+      goto finish;
+  }
+  if (join->thd->is_error())
+    rc= NESTED_LOOP_ERROR;
+
+finish:
+  join_tab_scan= save_join_tab_scan;
+  end_spilling();
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Start reading the spilled records of the joined table
+
+  RETURN VALUE
+    0            the initiation is a success
+    error code   otherwise
+*/
+
+int JOIN_TAB_SCAN_SPILLED::open()
+{
+  TABLE *table= join_tab->table;
+  save_or_restore_used_tabs(join_tab, FALSE);
+  table->status= 0;
+  table->null_row= 0;
+  if (reinit_io_cache(file, READ_CACHE, 0L, 0, 0))
+    return report_spill_error(file, ER_ERROR_ON_WRITE);
+  return 0;
+}
+
+
+/*
+  Read the next spilled record of the joined table into its record buffer
+
+  RETURN VALUE
+    0            the next record has been read
+    -1           there are no more records in the partition
+    1            read error
+*/
+
+int JOIN_TAB_SCAN_SPILLED::next()
+{
+  TABLE *table= join_tab->table;
+  if (my_b_read(file, table->record[0], table->s->reclength))
+  {
+    if (file->error != -1)
+      return -1;
+    report_spill_error(file, ER_ERROR_ON_READ);
+    return 1;
+  }
+  return 0;
+}
+
+
+void JOIN_TAB_SCAN_SPILLED::close()
+{
+  save_or_restore_used_tabs(join_tab, TRUE);
+}
+
+
 /* 
   Calculate the increment of the MRR buffer for a record write       
 
@@ -668,7 +668,7 @@ class JOIN_CACHE :public Sql_alloc
 
   virtual ~JOIN_CACHE() {}
   void reset_join(JOIN *j) { join= j; }
-  void free()
+  virtual void free()
   { 
     my_free(buff);
     buff= 0;
@@ -1164,6 +1164,40 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
   */
   uchar *next_matching_rec_ref_ptr;
 
+  /*
+    When the records from the join buffer are joined with join_tab for the
+    first time and more records are still to come (the buffer is full),
+    the buffer starts spilling to disk if @@join_cache_spill_partitions
+    allows it:
+    SPILL_INNER  while the buffer is joined, every record of join_tab is
+                 also written into the partition for its join key
+    SPILL_OUTER  further partial join records are not put into the buffer
+                 but written into the partition for their join key
+    When all records have come, the partitions of the partial join records
+    are loaded into the buffer one by one and joined with the records of
+    join_tab from the same partition only.
+  */
+  enum Spill_state { SPILL_NONE, SPILL_INNER, SPILL_OUTER };
+  Spill_state spill_state;
+  /* Number of partitions, 0 if spilling is not used */
+  uint spill_partitions;
+  /*
+    The files of the partitions: the partial join records go into the
+    first spill_partitions files, the records of join_tab into the rest.
+    A file is only created in tmpdir when its buffer is written out, so
+    a cache uses up to 2 * MAX_JOIN_CACHE_SPILL_PARTITIONS temporary files.
+  */
+  IO_CACHE *spill_files;
+
+  bool can_spill();
+  bool start_spilling();
+  void end_spilling();
+  uint get_spill_partition(uchar *key);
+  bool spill_record();
+  bool read_spilled_record(IO_CACHE *file);
+  bool spill_join_tab_record(uchar *key);
+  enum_nested_loop_state join_spilled_records();
+
   /*
     Get the chain of records from buffer matching the current candidate
     record for join
@@ -1178,6 +1212,8 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 
   void read_next_candidate_for_match(uchar *rec_ptr);
 
+  enum_nested_loop_state join_matching_records(bool skip_last);
+
 public:
 
   /* 
@@ -1185,7 +1221,9 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab) : JOIN_CACHE_HASHED(j, tab) {}
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab)
+    : JOIN_CACHE_HASHED(j, tab), spill_state(SPILL_NONE),
+      spill_partitions(0), spill_files(0) {}
 
   /* 
     This constructor creates a linked BNLH join cache. The cache is to be 
@@ -1194,7 +1232,8 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-    : JOIN_CACHE_HASHED(j, tab, prev) {}
+    : JOIN_CACHE_HASHED(j, tab, prev), spill_state(SPILL_NONE),
+      spill_partitions(0), spill_files(0) {}
 
   /* Initialize the BNLH cache */       
   int init(bool for_explain);
@@ -1203,6 +1242,39 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
 
   bool is_key_access() { return TRUE; }
 
+  /* Add a record into the buffer or into its partition on disk */
+  bool put_record();
+
+  void free()
+  {
+    end_spilling();
+    JOIN_CACHE_HASHED::free();
+  }
+};
+
+
+/*
+  The class JOIN_TAB_SCAN_SPILLED is a companion class for the class
+  JOIN_CACHE_BNLH. It iterates over the records of the joined table that
+  have been written into one partition file when the join buffer spilled
+  to disk, reading them back into the record buffer of the table.
+*/
+
+class JOIN_TAB_SCAN_SPILLED: public JOIN_TAB_SCAN
+{
+  /* The partition file with the records of the joined table */
+  IO_CACHE *file;
+
+public:
+
+  JOIN_TAB_SCAN_SPILLED(JOIN *j, JOIN_TAB *tab, IO_CACHE *spill_file)
+    :JOIN_TAB_SCAN(j, tab), file(spill_file) {}
+
+  int open();
+
+  int next();
+
+  void close();
 };
 
 
@@ -566,6 +566,7 @@ typedef class st_select_lex_node SELECT_LEX_NODE;
 class THD;
 class select_result;
 class JOIN;
+class Cached_join_order;
 class select_union;
 class Procedure;
 class Explain_query;
@@ -756,6 +757,8 @@ class st_select_lex: public st_select_lex_node
   List<TABLE_LIST> *join_list;    /* list for the currently parsed join  */
   TABLE_LIST *embedding;          /* table embedding to the above list   */
   List<TABLE_LIST> sj_nests;      /* Semi-join nests within this join */
+  /* Join order kept between executions of a prepared statement */
+  Cached_join_order *join_order_cache;
   /*
     Beginning of the list of leaves in a FROM clause, where the leaves
     inlcude all base tables including view tables. The tables are connected
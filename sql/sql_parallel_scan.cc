@@ -0,0 +1,636 @@
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "opt_scan_filter.h"
+#include "filesort_utils.h"
+#include "sql_parallel_scan.h"
+
+/* Scan threads check for KILL every this many rows */
+#define PARALLEL_SCAN_KILL_CHECK_ROWS 1024
+
+
+/* Store an integer in the format read by Scan_filter::int_value() */
+
+static void store_int_value(uchar *ptr, uint length, longlong value)
+{
+  switch (length) {
+  case 1:
+    *ptr= (uchar) value;
+    break;
+  case 2:
+    int2store(ptr, (uint16) value);
+    break;
+  case 3:
+    int3store(ptr, (ulong) value);
+    break;
+  case 4:
+    int4store(ptr, (uint32) value);
+    break;
+  default:
+    int8store(ptr, (ulonglong) value);
+    break;
+  }
+}
+
+
+/*
+  Check if the query can be done by a parallel scan of the table
+
+  SYNOPSIS
+    Parallel_scan::create()
+      join     The join to execute
+      tab      The only table of the join
+
+  RETURN
+    NULL   The query can't be done by a parallel scan (or OOM)
+    #      The description of the scan; the tasks are not set up yet
+*/
+
+Parallel_scan *Parallel_scan::create(JOIN *join, JOIN_TAB *tab)
+{
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+  Parallel_scan *scan;
+  Item_sum **func_ptr, *func;
+  Item *item;
+  Sum *sum;
+  uint count= 0;
+  DBUG_ENTER("Parallel_scan::create");
+
+  if (join->table_count != 1 || join->const_tables ||
+      join->top_join_tab_count != 1 || join->group_list || join->group ||
+      join->having || join->procedure ||
+      join->rollup.state != ROLLUP::STATE_NONE || !join->sum_funcs ||
+      thd->lex->analyze_stmt ||
+      thd->lex->limit_rows_examined_cnt != ULONGLONG_MAX)
+    DBUG_RETURN(NULL);
+
+  if ((tab->type != JT_ALL && tab->type != JT_NEXT) || tab->bush_children ||
+      (tab->select && tab->select->quick) || tab->use_quick == 2 ||
+      table->s->tmp_table != NO_TMP_TABLE ||
+      !(table->file->ha_table_flags() & HA_CAN_PARALLEL_SCAN) ||
+      table->file->pushed_idx_cond || table->file->pushed_cond ||
+      table->file->stats.records < 2 * MIN_ROWS_PER_SCAN_THREAD)
+    DBUG_RETURN(NULL);
+
+  /* The threads can't evaluate Items: the filter must be the whole WHERE */
+  if (tab->select_cond &&
+      (!tab->scan_filter || tab->scan_filter->cond != tab->select_cond ||
+       !tab->scan_filter->covers_cond))
+    DBUG_RETURN(NULL);
+
+  /* The result row must consist of the aggregates and constants only */
+  List_iterator_fast<Item> it(*join->fields);
+  while ((item= it++))
+  {
+    if (item->type() != Item::SUM_FUNC_ITEM && !item->basic_const_item())
+      DBUG_RETURN(NULL);
+  }
+
+  for (func_ptr= join->sum_funcs; *func_ptr; func_ptr++)
+    count++;
+  if (!(scan= new (thd->mem_root) Parallel_scan) ||
+      !(scan->sums= (Sum*) thd->alloc(sizeof(Sum) * count)))
+    DBUG_RETURN(NULL);
+
+  for (func_ptr= join->sum_funcs, sum= scan->sums;
+       (func= *func_ptr);
+       func_ptr++, sum++)
+  {
+    Item *arg;
+    sum->item= func;
+    sum->field= NULL;
+    switch ((sum->type= func->sum_func())) {
+    case Item_sum::COUNT_FUNC:
+    case Item_sum::SUM_FUNC:
+    case Item_sum::AVG_FUNC:
+    case Item_sum::MIN_FUNC:
+    case Item_sum::MAX_FUNC:
+      break;
+    default:
+      DBUG_RETURN(NULL);
+    }
+    if (func->get_arg_count() != 1)
+      DBUG_RETURN(NULL);
+    arg= func->get_arg(0)->real_item();
+    if (arg->type() == Item::FIELD_ITEM)
+    {
+      Field *field= ((Item_field*) arg)->field;
+      if (field->table != table || !Scan_filter::is_int_field(field))
+        DBUG_RETURN(NULL);
+      sum->field= field;
+      sum->offset= (uint) (field->ptr - table->record[0]);
+      sum->null_offset= field->null_ptr ?
+                        (uint) (field->null_ptr - table->record[0]) : 0;
+      sum->null_bit= field->null_ptr ? field->null_bit : 0;
+      sum->length= (uchar) field->pack_length();
+      sum->unsigned_flag= MY_TEST(field->flags & UNSIGNED_FLAG);
+    }
+    else if (sum->type != Item_sum::COUNT_FUNC ||
+             !arg->basic_const_item() || arg->is_null())
+      DBUG_RETURN(NULL);                        /* Not COUNT(*) */
+  }
+  scan->sums_end= sum;
+  scan->thd= thd;
+  scan->table= table;
+  scan->filter= tab->select_cond ? tab->scan_filter : NULL;
+  if (!scan->choose_key())
+    DBUG_RETURN(NULL);
+  DBUG_RETURN(scan);
+}
+
+
+/*
+  Choose the index to split the table by: the primary key, or else the
+  first usable index, if its first column is an integer.
+*/
+
+bool Parallel_scan::choose_key()
+{
+  keyno= MAX_KEY;
+  for (uint key= 0; key < table->s->keys; key++)
+  {
+    KEY *key_info= table->key_info + key;
+    KEY_PART_INFO *part= key_info->key_part;
+    if (!table->keys_in_use_for_query.is_set(key) ||
+        (key_info->flags & (HA_FULLTEXT | HA_SPATIAL)) ||
+        (table->file->index_flags(key, 0, 1) &
+         (HA_READ_NEXT | HA_READ_ORDER | HA_READ_RANGE)) !=
+        (HA_READ_NEXT | HA_READ_ORDER | HA_READ_RANGE) ||
+        !Scan_filter::is_int_field(part->field) ||
+        part->length != part->field->pack_length())
+      continue;
+    if (keyno == MAX_KEY || key == table->s->primary_key)
+      keyno= key;
+  }
+  if (keyno == MAX_KEY)
+    return FALSE;
+  key_part= table->key_info[keyno].key_part;
+  key_field= key_part->field;
+  return TRUE;
+}
+
+
+/* Make the key image of a value of the first column of the index */
+
+void Parallel_scan::make_key(longlong value, uchar *key) const
+{
+  if (key_part->null_bit)
+    *key++= 0;
+  store_int_value(key, key_part->length, value);
+}
+
+
+/* Estimate the number of rows with a key below 'value' */
+
+ha_rows Parallel_scan::rows_below(longlong value, uchar *key) const
+{
+  key_range range;
+  make_key(value, key);
+  range.key= key;
+  range.length= key_part->store_length;
+  range.keypart_map= 1;
+  range.flag= HA_READ_BEFORE_KEY;
+  return table->file->records_in_range(keyno, NULL, &range);
+}
+
+
+/*
+  Read the smallest and the biggest not NULL value of the first column
+  of the index
+
+  RETURN
+    0                     ok
+    HA_ERR_END_OF_FILE    There are no not NULL values
+    #                     Error code
+*/
+
+int Parallel_scan::read_key_bounds(longlong *min_value, longlong *max_value)
+{
+  handler *file= table->file;
+  uchar *record= table->record[0];
+  uchar key[MAX_KEY_LENGTH];
+  bool unsigned_flag= MY_TEST(key_field->flags & UNSIGNED_FLAG);
+  int error;
+
+  if ((error= file->ha_index_init(keyno, 1)))
+    return error;
+  if (!(error= file->ha_index_first(record)) && key_field->is_null())
+  {
+    /* NULLs come first in the index, skip them */
+    key[0]= 1;
+    bzero(key + 1, key_part->length);
+    error= file->ha_index_read_map(record, key, 1, HA_READ_AFTER_KEY);
+  }
+  if (!error)
+  {
+    *min_value= Scan_filter::int_value(key_field->ptr, key_part->length,
+                                       unsigned_flag);
+    if (!(error= file->ha_index_last(record)))
+      *max_value= Scan_filter::int_value(key_field->ptr, key_part->length,
+                                         unsigned_flag);
+  }
+  file->ha_index_end();
+  return error;
+}
+
+
+static void close_clone(THD *thd, handler *file)
+{
+  file->ha_index_end();
+  file->ha_external_lock(thd, F_UNLCK);
+  file->ha_close();
+  delete file;
+}
+
+
+/*
+  Let a clone see the same state of the table as the handler of the
+  statement
+
+  The clones are not locked through thr_lock. With concurrent inserts
+  (MyISAM) they would read the current state of the table and see rows
+  inserted after the statement locked it. The state is shared the way
+  thr_multi_lock() does it when a table is locked several times.
+*/
+
+static void copy_lock_status(THD *thd, handler *from, handler *to)
+{
+  THR_LOCK_DATA *from_data, *to_data;
+  from->store_lock(thd, &from_data, TL_IGNORE);
+  to->store_lock(thd, &to_data, TL_IGNORE);
+  if (from_data->lock && from_data->lock->copy_status)
+    (*from_data->lock->copy_status)(to_data->status_param,
+                                    from_data->status_param);
+}
+
+
+/*
+  Open 'count' clones of the table handler for the scan threads
+
+  RETURN
+    FALSE  ok
+    TRUE   A clone could not be opened, none is open
+*/
+
+bool Parallel_scan::clone_handlers(uint count)
+{
+  for (task_count= 0; task_count < count; task_count++)
+  {
+    handler *file;
+    if (!(file= table->file->clone(table->s->normalized_path.str,
+                                   thd->mem_root)))
+      break;
+    if (file->ha_external_lock(thd, F_RDLCK))
+    {
+      file->ha_close();
+      delete file;
+      break;
+    }
+    copy_lock_status(thd, table->file, file);
+    if (file->ha_index_init(keyno, 1))
+    {
+      close_clone(thd, file);
+      break;
+    }
+    tasks[task_count].file= file;
+  }
+  if (task_count < count)
+  {
+    close_handlers();
+    return TRUE;
+  }
+  return FALSE;
+}
+
+
+void Parallel_scan::close_handlers()
+{
+  for (uint i= 0; i < task_count; i++)
+    close_clone(thd, tasks[i].file);
+}
+
+
+/*
+  Split the index into ranges holding about the same number of rows
+
+  The first range starts at the beginning of the index, so it includes
+  the rows with NULL in the column. Every other range starts at the first
+  key >= its boundary. Fewer ranges than tasks are made if the column has
+  too few distinct values; the handlers of the unused tasks are closed.
+*/
+
+void Parallel_scan::split_ranges(longlong min_value, longlong max_value)
+{
+  ha_rows total= table->file->stats.records;
+  longlong prev= min_value;
+  uint count;
+
+  tasks[0].start_key= NULL;
+  for (count= 1; count < task_count && prev < max_value; count++)
+  {
+    ha_rows target= (ha_rows) ((ulonglong) total * count / task_count);
+    Task *task= tasks + count;
+    longlong low= prev + 1, high= max_value;
+
+    /* Find the smallest value with at least 'target' rows below it */
+    while (low < high)
+    {
+      longlong middle= low + (longlong) (((ulonglong) high -
+                                          (ulonglong) low) / 2);
+      ha_rows rows= rows_below(middle, task->start_key);
+      if (rows != HA_POS_ERROR && rows >= target)
+        high= middle;
+      else
+        low= middle + 1;
+    }
+    make_key(low, task->start_key);
+    tasks[count - 1].end= low;
+    prev= low;
+  }
+
+  for (uint i= 0; i < count; i++)
+    tasks[i].last= (i == count - 1);
+  /* Close the handlers that are not needed */
+  for (uint i= count; i < task_count; i++)
+    close_clone(thd, tasks[i].file);
+  task_count= count;
+}
+
+
+void Parallel_scan::scan_task(void *arg)
+{
+  Task *task= static_cast<Task*>(arg);
+  task->scan->scan_range(task);
+}
+
+
+/*
+  Read one range of the index and aggregate the rows that match the filter
+
+  This runs in a thread without a THD, so the engine is called directly
+  instead of through the ha_* wrappers, which update the THD and the TABLE.
+*/
+
+void Parallel_scan::scan_range(Task *task)
+{
+  handler *file= task->file;
+  uchar *record= task->record;
+  my_ptrdiff_t diff= record - table->record[0];
+  const uchar *key_ptr= key_field->ptr + diff;
+  const uchar *key_null_ptr= key_field->null_ptr ?
+                             key_field->null_ptr + diff : NULL;
+  bool key_unsigned= MY_TEST(key_field->flags & UNSIGNED_FLAG);
+  int error;
+
+  if (task->start_key)
+    error= file->index_read_map(record, task->start_key, 1,
+                                HA_READ_KEY_OR_NEXT);
+  else
+    error= file->index_first(record);
+
+  for (; !error; error= file->index_next(record))
+  {
+    if (!task->last &&
+        !(key_null_ptr && (*key_null_ptr & key_field->null_bit)) &&
+        Scan_filter::int_value(key_ptr, key_part->length,
+                               key_unsigned) >= task->end)
+      break;
+    if (!(++task->examined % PARALLEL_SCAN_KILL_CHECK_ROWS) && thd->killed)
+      break;
+    if (filter && !filter->check(diff))
+      continue;
+    task->found++;
+
+    Partial *partial= task->partials;
+    for (const Sum *sum= sums; sum < sums_end; sum++, partial++)
+    {
+      longlong value= 0;
+      if (sum->field)
+      {
+        if (record[sum->null_offset] & sum->null_bit)
+          continue;
+        value= Scan_filter::int_value(record + sum->offset, sum->length,
+                                      sum->unsigned_flag);
+      }
+      switch (sum->type) {
+      case Item_sum::SUM_FUNC:
+      case Item_sum::AVG_FUNC:
+      {
+        /* 128 bit addition, the sum of many BIGINTs may not fit */
+        ulonglong low= (ulonglong) partial->value + (ulonglong) value;
+        partial->high+= (value < 0 ? -1 : 0) +
+                        (low < (ulonglong) partial->value ? 1 : 0);
+        partial->value= (longlong) low;
+        break;
+      }
+      case Item_sum::MIN_FUNC:
+        if (!partial->rows || value < partial->value)
+          partial->value= value;
+        break;
+      case Item_sum::MAX_FUNC:
+        if (!partial->rows || value > partial->value)
+          partial->value= value;
+        break;
+      default:
+        break;
+      }
+      partial->rows++;
+    }
+  }
+  task->error= error == HA_ERR_END_OF_FILE ? 0 : error;
+}
+
+
+/* Convert a 128 bit partial sum to a decimal */
+
+static void partial_sum_to_decimal(longlong high, longlong low,
+                                   my_decimal *to)
+{
+  if ((high == 0 && low >= 0) || (high == -1 && low < 0))
+  {
+    int2my_decimal(E_DEC_FATAL_ERROR, low, FALSE, to);
+    return;
+  }
+  my_decimal high_dec, low_dec, word, shift, tmp;
+  int2my_decimal(E_DEC_FATAL_ERROR, high, FALSE, &high_dec);
+  int2my_decimal(E_DEC_FATAL_ERROR, low, TRUE, &low_dec);
+  int2my_decimal(E_DEC_FATAL_ERROR, (longlong) 1 << 32, FALSE, &word);
+  my_decimal_mul(E_DEC_FATAL_ERROR, &shift, &word, &word);
+  my_decimal_mul(E_DEC_FATAL_ERROR, &tmp, &high_dec, &shift);
+  my_decimal_add(E_DEC_FATAL_ERROR, to, &tmp, &low_dec);
+}
+
+
+/*
+  Merge the partial aggregates of the tasks into the Item_sum objects
+
+  MIN and MAX values are values of the column, so they are put into
+  record[0] and added like a row read by the join would be.
+*/
+
+void Parallel_scan::merge_partials(JOIN *join)
+{
+  ha_rows found= 0, examined= 0;
+  uint i= 0;
+
+  for (const Sum *sum= sums; sum < sums_end; sum++, i++)
+  {
+    sum->item->clear();
+    for (Task *task= tasks; task < tasks + task_count; task++)
+    {
+      Partial *partial= task->partials + i;
+      if (!partial->rows)
+        continue;
+      switch (sum->type) {
+      case Item_sum::COUNT_FUNC:
+        ((Item_sum_count*) sum->item)->merge_count(partial->rows);
+        break;
+      case Item_sum::SUM_FUNC:
+      case Item_sum::AVG_FUNC:
+      {
+        my_decimal value;
+        partial_sum_to_decimal(partial->high, partial->value, &value);
+        ((Item_sum_sum*) sum->item)->merge_sum(partial->rows, &value);
+        break;
+      }
+      default:
+        store_int_value(sum->field->ptr, sum->length, partial->value);
+        sum->field->set_notnull();
+        sum->item->add();
+        break;
+      }
+    }
+  }
+
+  for (Task *task= tasks; task < tasks + task_count; task++)
+  {
+    found+= task->found;
+    examined+= task->examined;
+  }
+  join->join_examined_rows+= examined;
+  status_var_add(thd->status_var.ha_read_next_count, examined);
+  /* Tell end_send_group() that the aggregates hold a result */
+  if (found)
+    join->first_record= 1;
+}
+
+
+/*
+  Do the scan of the only table of an aggregate query in parallel
+
+  SYNOPSIS
+    Parallel_scan::run()
+      join     The join to execute
+      tab      The only table of the join
+      rc       OUT: result of the scan, as from sub_select()
+
+  DESCRIPTION
+    Called by do_select() instead of sub_select() for the first table,
+    when the end_select function is end_send_group(). On success the
+    aggregates hold the result and join->first_record is set if any row
+    matched, so that sub_select(join, tab, TRUE) sends the result row.
+
+  RETURN
+    FALSE  The parallel scan is not applicable, scan the table as usual
+    TRUE   The table was scanned, 'rc' is set
+*/
+
+bool Parallel_scan::run(JOIN *join, JOIN_TAB *tab, enum_nested_loop_state *rc)
+{
+  THD *thd= join->thd;
+  Parallel_scan *scan;
+  uint threads= (uint) thd->variables.parallel_scan_threads;
+  uint sum_count;
+  longlong min_value, max_value;
+  uchar *records, *keys;
+  Partial *partials;
+  int error;
+  DBUG_ENTER("Parallel_scan::run");
+  compile_time_assert(MAX_PARALLEL_SCAN_THREADS <= MAX_SORT_THREADS);
+
+  if (threads <= 1 || !(scan= create(join, tab)))
+    DBUG_RETURN(FALSE);
+  TABLE *table= scan->table;
+  threads= (uint) MY_MIN(threads,
+                         table->file->stats.records / MIN_ROWS_PER_SCAN_THREAD);
+
+  if ((error= scan->read_key_bounds(&min_value, &max_value)))
+  {
+    if (report_error(table, error) < 0)
+      DBUG_RETURN(FALSE);                       /* Only NULLs in the index */
+    *rc= NESTED_LOOP_ERROR;
+    DBUG_RETURN(TRUE);
+  }
+
+  sum_count= (uint) (scan->sums_end - scan->sums);
+  if (!(scan->tasks= (Task*) thd->calloc(sizeof(Task) * threads)) ||
+      !(records= (uchar*) thd->alloc(table->s->rec_buff_length * threads)) ||
+      !(keys= (uchar*) thd->alloc(scan->key_part->store_length * threads)) ||
+      !(partials= (Partial*) thd->calloc(sizeof(Partial) * sum_count *
+                                          threads)))
+  {
+    *rc= NESTED_LOOP_ERROR;
+    DBUG_RETURN(TRUE);
+  }
+  for (uint i= 0; i < threads; i++)
+  {
+    Task *task= scan->tasks + i;
+    task->scan= scan;
+    task->record= records + table->s->rec_buff_length * i;
+    task->start_key= keys + scan->key_part->store_length * i;
+    task->partials= partials + sum_count * i;
+  }
+
+  if (scan->clone_handlers(threads))
+  {
+    if (!thd->is_error())
+      DBUG_RETURN(FALSE);
+    *rc= NESTED_LOOP_ERROR;
+    DBUG_RETURN(TRUE);
+  }
+  scan->split_ranges(min_value, max_value);
+  if (scan->task_count < 2)
+  {
+    scan->close_handlers();
+    DBUG_RETURN(FALSE);
+  }
+
+  DBUG_PRINT("info", ("tasks: %u  key: %u", scan->task_count, scan->keyno));
+  run_sort_tasks(scan_task, scan->tasks, sizeof(Task), scan->task_count);
+
+  error= 0;
+  for (uint i= 0; i < scan->task_count && !error; i++)
+    error= scan->tasks[i].error;
+  scan->close_handlers();
+
+  if (error)
+  {
+    report_error(table, error);
+    *rc= NESTED_LOOP_ERROR;
+  }
+  else if (thd->check_killed())
+    *rc= NESTED_LOOP_KILLED;
+  else
+  {
+    scan->merge_partials(join);
+    *rc= NESTED_LOOP_OK;
+  }
+  DBUG_RETURN(TRUE);
+}
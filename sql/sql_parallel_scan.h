@@ -0,0 +1,103 @@
+#ifndef SQL_PARALLEL_SCAN_INCLUDED
+#define SQL_PARALLEL_SCAN_INCLUDED
+
+/*
+   Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Parallel scan of a table for a single-table query with only simple
+  aggregates, like
+
+    SELECT COUNT(*), SUM(a), MAX(b) FROM t1 WHERE c > 10;
+
+  The table is split into ranges of an index whose first column is an
+  integer, with the boundaries balanced by handler::records_in_range().
+  Each range is read by a thread of its own through a clone of the
+  handler (the engine must have HA_CAN_PARALLEL_SCAN). The threads have
+  no THD: the WHERE clause must be fully compiled into a Scan_filter and
+  the aggregates must be COUNT, SUM, AVG, MIN or MAX of an integer column,
+  so that rows are checked and aggregated on the record buffer without
+  evaluating Items. The partial aggregates are merged into the Item_sum
+  objects by the thread that runs the query, and the result row is sent
+  by end_send_group() as usual.
+*/
+
+class Parallel_scan :public Sql_alloc
+{
+  /* An aggregate computed on the record buffer */
+  struct Sum
+  {
+    Item_sum *item;
+    Item_sum::Sumfunctype type;
+    Field *field;                       /* NULL for COUNT(*) */
+    uint offset;                        /* Of the value in the record */
+    uint null_offset;
+    uchar null_bit;                     /* 0 if the column is NOT NULL */
+    uchar length;
+    bool unsigned_flag;
+  };
+
+  /* Partial result of a Sum over the rows of one range */
+  struct Partial
+  {
+    ulonglong rows;                     /* Rows with a not NULL argument */
+    longlong value;                     /* MIN/MAX, or low 64 bits of SUM */
+    longlong high;                      /* High 64 bits of SUM */
+  };
+
+  /* A range of the index, read by one thread */
+  struct Task
+  {
+    Parallel_scan *scan;
+    handler *file;
+    uchar *record;
+    uchar *start_key;                   /* NULL: from the start */
+    longlong end;                       /* Start of the next range */
+    bool last;
+    int error;
+    ha_rows examined;
+    ha_rows found;
+    Partial *partials;
+  };
+
+  THD *thd;
+  TABLE *table;
+  const Scan_filter *filter;
+  Sum *sums, *sums_end;
+  uint keyno;
+  KEY_PART_INFO *key_part;
+  Field *key_field;
+  Task *tasks;
+  uint task_count;
+
+  Parallel_scan() {}
+  static Parallel_scan *create(JOIN *join, JOIN_TAB *tab);
+  bool choose_key();
+  void make_key(longlong value, uchar *key) const;
+  ha_rows rows_below(longlong value, uchar *key) const;
+  int read_key_bounds(longlong *min_value, longlong *max_value);
+  bool clone_handlers(uint count);
+  void close_handlers();
+  void split_ranges(longlong min_value, longlong max_value);
+  static void scan_task(void *arg);
+  void scan_range(Task *task);
+  void merge_partials(JOIN *join);
+
+public:
+  static bool run(JOIN *join, JOIN_TAB *tab, enum_nested_loop_state *rc);
+};
+
+#endif /* SQL_PARALLEL_SCAN_INCLUDED */
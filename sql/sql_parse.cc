@@ -334,40 +334,48 @@ void init_update_queries(void)
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_UPDATES_DATA;
+                                            CF_UPDATES_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_UPDATE_MULTI]=   CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_UPDATES_DATA;
+                                            CF_UPDATES_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_INSERT]=	    CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_INSERTS_DATA;
+                                            CF_INSERTS_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_INSERT_SELECT]=  CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_INSERTS_DATA;
+                                            CF_INSERTS_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_DELETE]=         CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
-                                            CF_CAN_BE_EXPLAINED;
+                                            CF_CAN_BE_EXPLAINED |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_DELETE_MULTI]=   CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
-                                            CF_CAN_BE_EXPLAINED;;
+                                            CF_CAN_BE_EXPLAINED |
+                                            CF_PS_ARRAY_BINDING_SAFE;;
   sql_command_flags[SQLCOM_REPLACE]=        CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_INSERTS_DATA;;
+                                            CF_INSERTS_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;;
   sql_command_flags[SQLCOM_REPLACE_SELECT]= CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
                                             CF_CAN_BE_EXPLAINED |
-                                            CF_INSERTS_DATA;
+                                            CF_INSERTS_DATA |
+                                            CF_PS_ARRAY_BINDING_SAFE;
   sql_command_flags[SQLCOM_SELECT]=         CF_REEXECUTION_FRAGILE |
                                             CF_CAN_GENERATE_ROW_EVENTS |
                                             CF_OPTIMIZER_TRACE |
@@ -1936,6 +1944,8 @@ bool dispatch_command(enum enum_server_command command, THD *thd,
     thd_proc_info(thd, "updating status");
     /* Finalize server status flags after executing a command. */
     thd->update_server_status();
+    /* Make the status of the command global before the client sees it */
+    thd->publish_status();
     thd->protocol->end_statement();
     query_cache_end_of_result(thd);
   }
@@ -5736,6 +5746,10 @@ mysql_execute_command(THD *thd)
     thd->set_binlog_format(orig_binlog_format,
                            orig_current_stmt_binlog_format);
 
+  /* Closed prepared statements may describe tables that changed */
+  if (sql_command_flags[lex->sql_command] & CF_IMPLICIT_COMMIT_END)
+    prepared_stmt_cache_invalidate();
+
   if (! thd->in_sub_stmt && thd->transaction_rollback_request)
   {
     /*
@@ -8085,8 +8099,7 @@ void add_join_natural(TABLE_LIST *a, TABLE_LIST *b, List<String> *using_fields,
 THD *find_thread_by_id(longlong id, bool query_id)
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     if (tmp->get_command() == COM_DAEMON)
@@ -8097,7 +8110,7 @@ THD *find_thread_by_id(longlong id, bool query_id)
       break;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
   return tmp;
 }
 
@@ -8111,7 +8124,7 @@ THD *find_thread_by_id(longlong id, bool query_id)
   @param type                   Type of id: thread id or query id
 
   @note
-    This is written such that we have a short lock on LOCK_thread_count
+    This is written such that we have a short lock on the thread list
 */
 
 uint
@@ -8170,7 +8183,7 @@ kill_one_thread(THD *thd, longlong id, killed_state kill_signal, killed_type typ
   @param only_kill_query        Should it kill the query or the connection
 
   @note
-    This is written such that we have a short lock on LOCK_thread_count
+    This is written such that we have a short lock on the thread list
 
     If we can't kill all threads because of security issues, no threads
     are killed.
@@ -8191,8 +8204,7 @@ static uint kill_threads_for_user(THD *thd, LEX_USER *user,
   DBUG_PRINT("enter", ("user: %s  signal: %u", user->user.str,
                        (uint) kill_signal));
 
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     if (!tmp->security_ctx->user)
@@ -8209,14 +8221,14 @@ static uint kill_threads_for_user(THD *thd, LEX_USER *user,
       if (!(thd->security_ctx->master_access & SUPER_ACL) &&
           !thd->security_ctx->user_matches(tmp->security_ctx))
       {
-        mysql_mutex_unlock(&LOCK_thread_count);
+        it.release();
         DBUG_RETURN(ER_KILL_DENIED_ERROR);
       }
       if (!threads_to_kill.push_back(tmp, thd->mem_root))
         mysql_mutex_lock(&tmp->LOCK_thd_data); // Lock from delete
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
   if (!threads_to_kill.is_empty())
   {
     List_iterator_fast<THD> it2(threads_to_kill);
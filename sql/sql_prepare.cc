@@ -154,7 +154,8 @@ class Prepared_statement: public Statement
   enum flag_values
   {
     IS_IN_USE= 1,
-    IS_SQL_PREPARE= 2
+    IS_SQL_PREPARE= 2,
+    HAS_SAVED_METADATA= 4
   };
 
   THD *thd;
@@ -179,9 +180,23 @@ class Prepared_statement: public Statement
   */
   uint select_number_after_prepare;
   char last_error[MYSQL_ERRMSG_SIZE];
+  /*
+    What COM_STMT_PREPARE sent after the statement id, and the session
+    settings the parse and that metadata depend on. With them a closed
+    statement can answer a later prepare of the same text without parsing
+    it again, see mysqld_stmt_prepare().
+  */
+  String saved_metadata;
+  uint saved_column_count;
+  int32 saved_version;
+  sql_mode_t saved_sql_mode;
+  CHARSET_INFO *saved_client_cs;
+  CHARSET_INFO *saved_connection_cl;
+  CHARSET_INFO *saved_results_cs;
 #ifndef EMBEDDED_LIBRARY
-  bool (*set_params)(Prepared_statement *st, uchar *data, uchar *data_end,
-                     uchar *read_pos, String *expanded_query);
+  bool (*set_params)(Prepared_statement *st, uchar *null_array,
+                     uchar **read_pos, uchar *data_end,
+                     String *expanded_query);
 #else
   bool (*set_params_data)(Prepared_statement *st, String *expanded_query);
 #endif
@@ -199,10 +214,15 @@ class Prepared_statement: public Statement
   inline bool is_in_use() { return flags & (uint) IS_IN_USE; }
   inline bool is_sql_prepare() const { return flags & (uint) IS_SQL_PREPARE; }
   void set_sql_prepare() { flags|= (uint) IS_SQL_PREPARE; }
+  void save_metadata();
+  bool can_be_reused() const;
   bool prepare(const char *packet, uint packet_length);
+  bool reuse();
   bool execute_loop(String *expanded_query,
                     bool open_cursor,
                     uchar *packet_arg, uchar *packet_end_arg);
+  bool execute_bulk_loop(String *expanded_query, ulong iterations,
+                         uchar *packet_arg, uchar *packet_end_arg);
   bool execute_server_runnable(Server_runnable *server_runnable);
   /* Destroy this statement */
   void deallocate();
@@ -215,7 +235,8 @@ class Prepared_statement: public Statement
 private:
   bool set_db(const char *db, uint db_length);
   bool set_parameters(String *expanded_query,
-                      uchar *packet, uchar *packet_end);
+                      uchar **packet, uchar *packet_end);
+  bool execute_with_reprepare(String *expanded_query, bool open_cursor);
   bool execute(String *expanded_query, bool open_cursor);
   bool reprepare();
   bool validate_metadata(Prepared_statement  *copy);
@@ -339,6 +360,11 @@ find_prepared_statement(THD *thd, ulong id)
 /**
   Send prepared statement id and metadata to the client after prepare.
 
+  @param stmt      the statement
+  @param columns   number of result set columns
+  @param saved     metadata saved by an earlier prepare of the statement,
+                   sent instead of the placeholders and columns metadata
+
   @todo
     Fix this nasty upcast from List<Item_param> to List<Item>
 
@@ -347,7 +373,8 @@ find_prepared_statement(THD *thd, ulong id)
 */
 
 #ifndef EMBEDDED_LIBRARY
-static bool send_prep_stmt(Prepared_statement *stmt, uint columns)
+static bool send_prep_stmt(Prepared_statement *stmt, uint columns,
+                           const String *saved= NULL)
 {
   NET *net= &stmt->thd->net;
   uchar buff[12];
@@ -358,6 +385,9 @@ static bool send_prep_stmt(Prepared_statement *stmt, uint columns)
   DBUG_PRINT("enter",("stmt->id: %lu  columns: %d  param_count: %d",
                       stmt->id, columns, stmt->param_count));
 
+  /* Kept for Prepared_statement::reuse() */
+  stmt->saved_column_count= columns;
+
   buff[0]= 0;                                   /* OK packet indicator */
   int4store(buff+1, stmt->id);
   int2store(buff+5, columns);
@@ -371,7 +401,9 @@ static bool send_prep_stmt(Prepared_statement *stmt, uint columns)
     XXX: fix this nasty upcast from List<Item_param> to List<Item>
   */
   error= my_net_write(net, buff, sizeof(buff));
-  if (stmt->param_count && ! error)
+  if (saved && ! error)
+    error= thd->protocol->send_saved_metadata(saved);
+  else if (stmt->param_count && ! error)
   {
     error= thd->protocol_text.send_result_set_metadata((List<Item> *)
                                           &stmt->lex->param_list,
@@ -870,7 +902,7 @@ inline bool is_param_long_data_type(Item_param *param)
 */
 
 static bool insert_params_with_log(Prepared_statement *stmt, uchar *null_array,
-                                   uchar *read_pos, uchar *data_end,
+                                   uchar **read_pos, uchar *data_end,
                                    String *query)
 {
   THD  *thd= stmt->thd;
@@ -888,9 +920,9 @@ static bool insert_params_with_log(Prepared_statement *stmt, uchar *null_array,
         param->set_null();
       else
       {
-        if (read_pos >= data_end)
+        if (*read_pos >= data_end)
           DBUG_RETURN(1);
-        param->set_param_func(param, &read_pos, (uint) (data_end - read_pos));
+        param->set_param_func(param, read_pos, (uint) (data_end - *read_pos));
         if (param->state == Item_param::NO_VALUE)
           DBUG_RETURN(1);
 
@@ -926,7 +958,7 @@ static bool insert_params_with_log(Prepared_statement *stmt, uchar *null_array,
 
 
 static bool insert_params(Prepared_statement *stmt, uchar *null_array,
-                          uchar *read_pos, uchar *data_end,
+                          uchar **read_pos, uchar *data_end,
                           String *expanded_query)
 {
   Item_param **begin= stmt->param_array;
@@ -943,9 +975,9 @@ static bool insert_params(Prepared_statement *stmt, uchar *null_array,
         param->set_null();
       else
       {
-        if (read_pos >= data_end)
+        if (*read_pos >= data_end)
           DBUG_RETURN(1);
-        param->set_param_func(param, &read_pos, (uint) (data_end - read_pos));
+        param->set_param_func(param, read_pos, (uint) (data_end - *read_pos));
         if (param->state == Item_param::NO_VALUE)
           DBUG_RETURN(1);
       }
@@ -2557,6 +2589,57 @@ static bool init_param_array(Prepared_statement *stmt)
     to the client, otherwise an error message is set in THD.
 */
 
+/*
+  Incremented after every statement that may change table definitions
+  or privileges. Closed statements prepared before are not reused, as
+  the metadata saved with them may be out of date.
+*/
+static int32 volatile closed_stmt_version= 0;
+
+
+void prepared_stmt_cache_invalidate()
+{
+  my_atomic_add32(&closed_stmt_version, 1);
+}
+
+
+#ifndef EMBEDDED_LIBRARY
+/**
+  Find a closed statement of this connection that was prepared from the
+  same text, with the same current database and session settings that
+  affect parsing and the metadata sent to the client.
+
+  @return the statement, removed from the closed statements, or NULL
+*/
+
+static Prepared_statement *
+find_closed_statement(THD *thd, const char *packet, uint packet_length)
+{
+  Prepared_statement *stmt;
+  ulong cache_size= thd->variables.prepared_stmt_cache_size;
+
+  /* The cache may have been made smaller since the last close */
+  thd->stmt_map.trim_closed(cache_size);
+  if (!cache_size ||
+      !(stmt= (Prepared_statement *) thd->stmt_map.take_closed(packet,
+                                                              packet_length)))
+    return NULL;
+
+  if (stmt->saved_version == my_atomic_load32(&closed_stmt_version) &&
+      stmt->saved_sql_mode == thd->variables.sql_mode &&
+      stmt->saved_client_cs == thd->variables.character_set_client &&
+      stmt->saved_connection_cl == thd->variables.collation_connection &&
+      stmt->saved_results_cs == thd->variables.character_set_results &&
+      stmt->db_length == thd->db_length &&
+      (!stmt->db_length || !memcmp(stmt->db, thd->db, thd->db_length)))
+    return stmt;
+
+  delete stmt;
+  return NULL;
+}
+#endif
+
+
 void mysqld_stmt_prepare(THD *thd, const char *packet, uint packet_length)
 {
   Protocol *save_protocol= thd->protocol;
@@ -2567,6 +2650,19 @@ void mysqld_stmt_prepare(THD *thd, const char *packet, uint packet_length)
   /* First of all clear possible warnings from the previous command */
   thd->reset_for_next_command();
 
+#ifndef EMBEDDED_LIBRARY
+  if ((stmt= find_closed_statement(thd, packet, packet_length)))
+  {
+    /* A new id, as the client may still use the old one by mistake */
+    stmt->id= ++thd->statement_id_counter;
+    if (thd->stmt_map.insert(thd, stmt))
+      goto end;
+    if (stmt->reuse())
+      thd->stmt_map.erase(stmt);
+    goto end;
+  }
+#endif
+
   if (! (stmt= new Prepared_statement(thd)))
     goto end;           /* out of memory: error is set in Sql_alloc */
 
@@ -2581,12 +2677,27 @@ void mysqld_stmt_prepare(THD *thd, const char *packet, uint packet_length)
 
   thd->protocol= &thd->protocol_binary;
 
+#ifndef EMBEDDED_LIBRARY
+  if (thd->variables.prepared_stmt_cache_size)
+  {
+    /* Save the metadata, so that the statement can be reused when closed */
+    thd->protocol_binary.metadata_copy= &stmt->saved_metadata;
+    thd->protocol_text.metadata_copy= &stmt->saved_metadata;
+    /* Read before the tables are, see prepared_stmt_cache_invalidate() */
+    stmt->saved_version= my_atomic_load32(&closed_stmt_version);
+  }
+#endif
+
   if (stmt->prepare(packet, packet_length))
   {
     /* Statement map deletes statement on erase */
     thd->stmt_map.erase(stmt);
   }
+  else if (thd->protocol_binary.metadata_copy)
+    stmt->save_metadata();
 
+  thd->protocol_binary.metadata_copy= 0;
+  thd->protocol_text.metadata_copy= 0;
   thd->protocol= save_protocol;
 
   sp_cache_enforce_limit(thd->sp_proc_cache, stored_program_cache_size);
@@ -2945,6 +3056,7 @@ void mysqld_stmt_execute(THD *thd, char *packet_arg, uint packet_length)
   uchar *packet= (uchar*)packet_arg; // GCC 4.0.1 workaround
   ulong stmt_id= uint4korr(packet);
   ulong flags= (ulong) packet[4];
+  ulong iterations= uint4korr(packet + 5);
   /* Query text for binary, general or slow log, if any of them is open */
   String expanded_query;
   uchar *packet_end= packet + packet_length;
@@ -2953,7 +3065,7 @@ void mysqld_stmt_execute(THD *thd, char *packet_arg, uint packet_length)
   bool open_cursor;
   DBUG_ENTER("mysqld_stmt_execute");
 
-  packet+= 9;                               /* stmt_id + 5 bytes of flags */
+  packet+= 9;                 /* stmt_id + flags + 4 bytes iteration count */
 
   /* First of all clear possible warnings from the previous command */
   thd->reset_for_next_command();
@@ -2975,7 +3087,10 @@ void mysqld_stmt_execute(THD *thd, char *packet_arg, uint packet_length)
   open_cursor= MY_TEST(flags & (ulong) CURSOR_TYPE_READ_ONLY);
 
   thd->protocol= &thd->protocol_binary;
-  stmt->execute_loop(&expanded_query, open_cursor, packet, packet_end);
+  if (iterations > 1)
+    stmt->execute_bulk_loop(&expanded_query, iterations, packet, packet_end);
+  else
+    stmt->execute_loop(&expanded_query, open_cursor, packet, packet_end);
   thd->protocol= save_protocol;
 
   sp_cache_enforce_limit(thd->sp_proc_cache, stored_program_cache_size);
@@ -3440,7 +3555,8 @@ Prepared_statement::Prepared_statement(THD *thd_arg)
   cursor(0),
   param_count(0),
   last_errno(0),
-  flags((uint) IS_IN_USE)
+  flags((uint) IS_IN_USE),
+  saved_column_count(0)
 {
   init_sql_alloc(&main_mem_root, thd_arg->variables.query_alloc_block_size,
                  thd_arg->variables.query_prealloc_size, MYF(MY_THREAD_SPECIFIC));
@@ -3770,8 +3886,9 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
                          '?' placeholders will be replaced with
                          their values in case of success.
                          The result is used for logging and replication
-  @param packet          pointer to execute packet.
-                         NULL in case of SQL PS
+  @param packet          pointer to the parameters in the execute packet,
+                         moved past them on success.
+                         Points to NULL in case of SQL PS
   @param packet_end      end of the packet. NULL in case of SQL PS
 
   @todo Use a paremeter source class family instead of 'if's, and
@@ -3784,9 +3901,9 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
 
 bool
 Prepared_statement::set_parameters(String *expanded_query,
-                                   uchar *packet, uchar *packet_end)
+                                   uchar **packet, uchar *packet_end)
 {
-  bool is_sql_ps= packet == NULL;
+  bool is_sql_ps= *packet == NULL;
   bool res= FALSE;
 
   if (is_sql_ps)
@@ -3798,8 +3915,8 @@ Prepared_statement::set_parameters(String *expanded_query,
   else if (param_count)
   {
 #ifndef EMBEDDED_LIBRARY
-    uchar *null_array= packet;
-    res= (setup_conversion_functions(this, &packet, packet_end) ||
+    uchar *null_array= *packet;
+    res= (setup_conversion_functions(this, packet, packet_end) ||
           set_params(this, null_array, packet, packet_end, expanded_query));
 #else
     /*
@@ -3849,13 +3966,6 @@ Prepared_statement::execute_loop(String *expanded_query,
                                  uchar *packet,
                                  uchar *packet_end)
 {
-  const int MAX_REPREPARE_ATTEMPTS= 3;
-  Reprepare_observer reprepare_observer;
-  bool error;
-  int reprepare_attempt= 0;
-#ifndef DBUG_OFF
-  Item *free_list_state= thd->free_list;
-#endif
   thd->select_number= select_number_after_prepare;
   /* Check if we got an error when sending long data */
   if (state == Query_arena::STMT_ERROR)
@@ -3864,7 +3974,7 @@ Prepared_statement::execute_loop(String *expanded_query,
     return TRUE;
   }
 
-  if (set_parameters(expanded_query, packet, packet_end))
+  if (set_parameters(expanded_query, &packet, packet_end))
     return TRUE;
 
 #ifdef NOT_YET_FROM_MYSQL_5_6
@@ -3876,6 +3986,91 @@ Prepared_statement::execute_loop(String *expanded_query,
   }
 #endif
 
+  return execute_with_reprepare(expanded_query, open_cursor);
+}
+
+
+/**
+  Execute a prepared statement once for each of several parameter sets
+  sent in one COM_STMT_EXECUTE packet (bulk execution).
+
+  Every parameter set is laid out as the parameters of an ordinary
+  COM_STMT_EXECUTE: NULL bitmap, new-types flag, types (only when the
+  flag is set) and values. The statement is executed for the sets in
+  turn within the same command, so warnings accumulate, and one OK
+  packet with the total number of affected rows and the first generated
+  auto-increment value is sent. Execution stops at the first error;
+  changes made for the earlier sets are not undone.
+
+  Only statements that do not return a result set can be executed this
+  way, see CF_PS_ARRAY_BINDING_SAFE.
+
+  @return TRUE if an error, FALSE if success
+*/
+
+bool
+Prepared_statement::execute_bulk_loop(String *expanded_query,
+                                      ulong iterations,
+                                      uchar *packet,
+                                      uchar *packet_end)
+{
+  Diagnostics_area *da= thd->get_stmt_da();
+  ulonglong affected_rows= 0;
+  ulonglong last_insert_id= 0;
+
+  /* Check if we got an error when sending long data */
+  if (state == Query_arena::STMT_ERROR)
+  {
+    my_message(last_errno, last_error, MYF(0));
+    return TRUE;
+  }
+
+  if (!(sql_command_flags[lex->sql_command] & CF_PS_ARRAY_BINDING_SAFE))
+  {
+    my_message(ER_UNSUPPORTED_PS, ER_THD(thd, ER_UNSUPPORTED_PS), MYF(0));
+    return TRUE;
+  }
+
+  for (ulong i= 0; i < iterations; i++)
+  {
+    thd->select_number= select_number_after_prepare;
+    expanded_query->length(0);
+    if (set_parameters(expanded_query, &packet, packet_end) ||
+        execute_with_reprepare(expanded_query, FALSE))
+      return TRUE;
+    if (da->is_ok())
+    {
+      affected_rows+= da->affected_rows();
+      if (!last_insert_id)
+        last_insert_id= da->last_insert_id();
+    }
+    da->reset_diagnostics_area();
+  }
+  my_ok(thd, affected_rows, last_insert_id);
+  return FALSE;
+}
+
+
+/**
+  Execute a prepared statement with the parameters already set, and
+  re-prepare and retry it if its metadata changed. Resets the parameters
+  afterwards.
+
+  @return TRUE if an error, FALSE if success
+*/
+
+bool
+Prepared_statement::execute_with_reprepare(String *expanded_query,
+                                           bool open_cursor)
+{
+  const int MAX_REPREPARE_ATTEMPTS= 3;
+  Reprepare_observer reprepare_observer;
+  bool error;
+  int reprepare_attempt= 0;
+#ifndef DBUG_OFF
+  Item *free_list_state= thd->free_list;
+#endif
+
 reexecute:
   /*
     If the free_list is not empty, we'll wrongly free some externally
@@ -4022,6 +4217,8 @@ Prepared_statement::reprepare()
   {
     swap_prepared_statement(&copy);
     swap_parameter_array(param_array, copy.param_array, param_count);
+    /* The metadata saved at prepare may not describe it anymore */
+    flags&= ~ (uint) HAS_SAVED_METADATA;
 #ifndef DBUG_OFF
     is_reprepared= TRUE;
 #endif
@@ -4359,11 +4556,85 @@ void Prepared_statement::deallocate()
   /* It should now be safe to reset CHANGE MASTER parameters */
   lex_end_stage2(lex);
 
+  if (can_be_reused())
+  {
+    close_cursor();
+    reset_stmt_params(this);
+    thd->stmt_map.keep_closed(this, thd->variables.prepared_stmt_cache_size);
+    return;
+  }
+
   /* Statement map calls delete stmt on erase */
   thd->stmt_map.erase(this);
 }
 
 
+/**
+  Remember the session settings that the metadata saved during
+  COM_STMT_PREPARE depends on.
+
+  The saved metadata describes the statement as it was prepared. Should
+  the tables change before the statement is reused, the next execution
+  reprepares it like any other prepared statement, and errors that the
+  prepare would have reported are reported by that execution.
+*/
+
+void Prepared_statement::save_metadata()
+{
+  /* The header sent by reuse() can not carry the prepare warnings */
+  if (thd->get_stmt_da()->current_statement_warn_count())
+    return;
+  saved_sql_mode= thd->variables.sql_mode;
+  saved_client_cs= thd->variables.character_set_client;
+  saved_connection_cl= thd->variables.collation_connection;
+  saved_results_cs= thd->variables.character_set_results;
+  flags|= (uint) HAS_SAVED_METADATA;
+}
+
+
+/**
+  Whether the closed statement can be kept for a later prepare of the
+  same text. Only statements that are reprepared when the metadata of
+  their tables changes are kept.
+*/
+
+bool Prepared_statement::can_be_reused() const
+{
+  return (flags & (uint) HAS_SAVED_METADATA) &&
+         (state == Query_arena::STMT_PREPARED ||
+          state == Query_arena::STMT_EXECUTED) &&
+         (sql_command_flags[lex->sql_command] & CF_REEXECUTION_FRAGILE) &&
+         thd->variables.prepared_stmt_cache_size;
+}
+
+
+/**
+  Answer COM_STMT_PREPARE with a closed statement of the same text,
+  sending the metadata saved when it was prepared.
+
+  @retval FALSE  success, the response is sent
+  @retval TRUE   error
+*/
+
+#ifndef EMBEDDED_LIBRARY
+bool Prepared_statement::reuse()
+{
+  DBUG_ENTER("Prepared_statement::reuse");
+  DBUG_ASSERT(flags & (uint) HAS_SAVED_METADATA);
+
+  status_var_increment(thd->status_var.com_stmt_prepare);
+  status_var_increment(thd->status_var.ps_cache_hits);
+
+  if (send_prep_stmt(this, saved_column_count, &saved_metadata) ||
+      thd->protocol->flush())
+    DBUG_RETURN(TRUE);
+
+  general_log_write(thd, COM_STMT_PREPARE, query(), query_length());
+  DBUG_RETURN(FALSE);
+}
+#endif
+
+
 /***************************************************************************
 * Ed_result_set
 ***************************************************************************/
@@ -76,6 +76,7 @@ void mysqld_stmt_fetch(THD *thd, char *packet, uint packet_length);
 void mysqld_stmt_reset(THD *thd, char *packet);
 void mysql_stmt_get_longdata(THD *thd, char *pos, ulong packet_length);
 void reinit_stmt_before_use(THD *thd, LEX *lex);
+void prepared_stmt_cache_invalidate();
 
 /**
   Execute a fragment of server code in an isolated context, so that
@@ -502,12 +502,12 @@ void adjust_linfo_offsets(my_off_t purge_offset)
 {
   THD *tmp;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
 
   while ((tmp=it++))
   {
     LOG_INFO* linfo;
+    mysql_mutex_lock(&tmp->LOCK_thd_data);      // For current_linfo
     if ((linfo = tmp->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
@@ -522,8 +522,8 @@ void adjust_linfo_offsets(my_off_t purge_offset)
 	linfo->index_file_offset -= purge_offset;
       mysql_mutex_unlock(&linfo->lock);
     }
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
 }
 
 
@@ -533,23 +533,23 @@ bool log_in_use(const char* log_name)
   THD *tmp;
   bool result = 0;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
 
   while ((tmp=it++))
   {
     LOG_INFO* linfo;
+    mysql_mutex_lock(&tmp->LOCK_thd_data);      // For current_linfo
     if ((linfo = tmp->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
       result = !memcmp(log_name, linfo->log_file_name, log_name_len);
       mysql_mutex_unlock(&linfo->lock);
-      if (result)
-	break;
     }
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
+    if (result)
+      break;
   }
 
-  mysql_mutex_unlock(&LOCK_thread_count);
   return result;
 }
 
@@ -2181,9 +2181,9 @@ static int init_binlog_sender(binlog_send_info *info,
   linfo->pos= *pos;
 
   // note: publish that we use file, before we open it
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo= linfo;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
 
   if (check_start_offset(info, linfo->log_file_name, *pos))
     return 1;
@@ -2679,6 +2679,8 @@ static int send_events(binlog_send_info *info, IO_CACHE* log, LOG_INFO* linfo,
         ((info->errmsg= send_event_to_slave(info, event_type, log,
                                            ev_offset, &info->error_gtid))))
       return 1;
+    /* The dump thread never ends its command; publish per event */
+    info->thd->publish_status();
 
     if (unlikely(info->send_fake_gtid_list) &&
         info->gtid_skip_group == GTID_SKIP_NOT)
@@ -2922,9 +2924,9 @@ void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
     mysql_file_close(file, MYF(MY_WME));
   }
 
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo = 0;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
   thd->variables.max_allowed_packet= old_max_allowed_packet;
   delete info->fdev;
 
@@ -3385,8 +3387,7 @@ int reset_slave(THD *thd, Master_info* mi)
 
 void kill_zombie_dump_threads(uint32 slave_server_id)
 {
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   THD *tmp;
 
   while ((tmp=it++))
@@ -3398,7 +3399,7 @@ void kill_zombie_dump_threads(uint32 slave_server_id)
       break;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
   if (tmp)
   {
     /*
@@ -3946,9 +3947,9 @@ bool mysql_show_binlog_events(THD* thd)
       goto err;
     }
 
-    mysql_mutex_lock(&LOCK_thread_count);
+    mysql_mutex_lock(&thd->LOCK_thd_data);
     thd->current_linfo = &linfo;
-    mysql_mutex_unlock(&LOCK_thread_count);
+    mysql_mutex_unlock(&thd->LOCK_thd_data);
 
     if ((file=open_binlog(&log, linfo.log_file_name, &errmsg)) < 0)
       goto err;
@@ -4080,9 +4081,9 @@ bool mysql_show_binlog_events(THD* thd)
   else
     my_eof(thd);
 
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo = 0;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
   thd->variables.max_allowed_packet= old_max_allowed_packet;
   DBUG_RETURN(ret);
 }
@@ -53,6 +53,9 @@
 #include "log_slow.h"
 #include "sql_derived.h"
 #include "sql_statistics.h"
+#include "opt_scan_filter.h"
+#include "sql_parallel_scan.h"
+#include "sql_group_hash.h"
 
 #include "debug_sync.h"          // DEBUG_SYNC
 #include <m_ctype.h>
@@ -183,6 +186,8 @@ static enum_nested_loop_state
 end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int test_if_group_changed(List<Cached_item> &list);
 static int join_read_const_table(THD *thd, JOIN_TAB *tab, POSITION *pos);
@@ -3173,9 +3178,18 @@ void JOIN::exec_inner()
           "select SQL_CALC_FOUND_ROWS * from t1 order by b desc limit 1;"
         select_limit == HA_POS_ERROR (we need a full table scan)
         unit->select_limit_cnt == 1 (we only need one row in the result set)
+        With group by, it can be used when the temporary table already
+        has the finished groups and all of HAVING was added to the sort
+        condition above, for queries like:
+          "select a, count(*) from t1 group by a order by 2 desc limit 10;"
        */
+      const bool sort_finished_groups=
+        curr_tmp_table && !curr_join->group_list && !curr_join->group &&
+        !curr_join->tmp_having && !procedure &&
+        curr_join->rollup.state == ROLLUP::STATE_NONE;
       const ha_rows filesort_limit_arg=
-        (has_group_by || curr_join->table_count > 1)
+        ((has_group_by && !sort_finished_groups) ||
+         curr_join->table_count > 1)
         ? curr_join->select_limit : unit->select_limit_cnt;
       const ha_rows select_limit_arg=
         select_options & OPTION_FOUND_ROWS
@@ -4196,7 +4210,10 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
     /* Find an optimal join order of the non-constant tables. */
     if (join->const_tables != join->table_count)
     {
-      if (choose_plan(join, all_table_map & ~join->const_table_map))
+      bool use_plan_cache= join->thd->variables.prepared_stmt_plan_cache &&
+                           join->thd->stmt_arena->is_stmt_execute();
+      if (choose_plan(join, all_table_map & ~join->const_table_map,
+                      use_plan_cache))
         goto error;
     }
     else
@@ -6589,6 +6606,93 @@ static void choose_initial_table_order(JOIN *join)
 }
 
 
+/**
+  Put the non-constant tables of a join in the order that an earlier
+  execution of the same prepared statement chose, if it can be reused.
+
+  The order is reused only if the same tables are constant, no table
+  share has been reloaded since (this also covers new engine-independent
+  statistics), and no row estimate has changed by more than a factor of
+  two.
+
+  @return TRUE if join->best_ref now lists the tables in the cached order
+*/
+
+static bool use_cached_join_order(JOIN *join)
+{
+  Cached_join_order *cache= join->select_lex->join_order_cache;
+  JOIN_TAB **tabs= join->best_ref + join->const_tables;
+  uint count= join->table_count - join->const_tables;
+
+  if (!cache || cache->const_table_map != join->const_table_map ||
+      cache->count != count)
+    return FALSE;
+
+  for (uint i= 0; i < count; i++)
+  {
+    Cached_join_order::Table_entry *entry= cache->tables + i;
+    TABLE *table;
+    ha_rows records;
+    uint j;
+
+    for (j= i; j < count; j++)
+    {
+      if (tabs[j]->table->pos_in_table_list == entry->table)
+        break;
+    }
+    if (j == count)
+      return FALSE;
+    table= tabs[j]->table;
+    records= table->stat_records();
+    /* Internal temporary tables get a new share on every execution */
+    if ((table->s->tmp_table != INTERNAL_TMP_TABLE &&
+         table->s->get_table_ref_version() != entry->table_ref_version) ||
+        records / 2 > entry->records || entry->records / 2 > records)
+      return FALSE;
+    swap_variables(JOIN_TAB*, tabs[i], tabs[j]);
+  }
+  return TRUE;
+}
+
+
+/**
+  Remember the join order in join->best_positions for later executions
+  of the prepared statement, see use_cached_join_order().
+*/
+
+static void save_join_order(JOIN *join)
+{
+  SELECT_LEX *select_lex= join->select_lex;
+  Cached_join_order *cache= select_lex->join_order_cache;
+  MEM_ROOT *mem_root= join->thd->stmt_arena->mem_root;
+  POSITION *pos= join->best_positions + join->const_tables;
+  uint count= join->table_count - join->const_tables;
+
+  if (!cache || cache->size < count)
+  {
+    /* The statement's memory is freed with it, only grow here */
+    if (!(cache= new (mem_root) Cached_join_order) ||
+        !(cache->tables= (Cached_join_order::Table_entry*)
+          alloc_root(mem_root, sizeof(*cache->tables) * join->table_count)))
+    {
+      select_lex->join_order_cache= NULL;
+      return;
+    }
+    cache->size= join->table_count;
+    select_lex->join_order_cache= cache;
+  }
+  cache->const_table_map= join->const_table_map;
+  cache->count= count;
+  for (uint i= 0; i < count; i++)
+  {
+    TABLE *table= pos[i].table->table;
+    cache->tables[i].table= table->pos_in_table_list;
+    cache->tables[i].table_ref_version= table->s->get_table_ref_version();
+    cache->tables[i].records= table->stat_records();
+  }
+}
+
+
 /**
   Selects and invokes a search strategy for an optimal query plan.
 
@@ -6598,9 +6702,16 @@ static void choose_initial_table_order(JOIN *join)
   the array 'join->best_positions', and the cost of the plan in
   'join->best_read'.
 
-  @param join         pointer to the structure providing all context info for
-                      the query
-  @param join_tables  set of the tables in the query
+  With use_plan_cache the join order of the previous execution of the
+  prepared statement is taken if it is still valid, and only the access
+  methods are chosen again for it, as for a straight join. Otherwise the
+  order found is cached for the next execution.
+
+  @param join            pointer to the structure providing all context info
+                         for the query
+  @param join_tables     set of the tables in the query
+  @param use_plan_cache  reuse and cache the join order of a prepared
+                         statement
 
   @todo
     'MAX_TABLES+2' denotes the old implementation of find_best before
@@ -6613,7 +6724,7 @@ static void choose_initial_table_order(JOIN *join)
 */
 
 bool
-choose_plan(JOIN *join, table_map join_tables)
+choose_plan(JOIN *join, table_map join_tables, bool use_plan_cache)
 {
   uint search_depth= join->thd->variables.optimizer_search_depth;
   uint prune_level=  join->thd->variables.optimizer_prune_level;
@@ -6626,6 +6737,16 @@ choose_plan(JOIN *join, table_map join_tables)
   reset_nj_counters(join, join->join_list);
   qsort2_cmp jtab_sort_func;
 
+  use_plan_cache= use_plan_cache && !straight_join && !join->emb_sjm_nest;
+  if (use_plan_cache && use_cached_join_order(join))
+  {
+    DBUG_PRINT("info", ("Reusing the cached join order"));
+    status_var_increment(join->thd->status_var.ps_plan_cache_hits);
+    join->cur_sj_inner_tables= 0;
+    optimize_straight_join(join, join_tables);
+    goto end;
+  }
+
   if (join->emb_sjm_nest)
   {
     /* We're optimizing semi-join materialization nest, so put the 
@@ -6690,7 +6811,10 @@ choose_plan(JOIN *join, table_map join_tables)
         DBUG_RETURN(TRUE);
     }
   }
+  if (use_plan_cache)
+    save_join_order(join);
 
+end:
   /* 
     Store the cost of this query into a user variable
     Don't update last_query_cost for statements that are not "flat joins" :
@@ -11427,6 +11551,11 @@ make_join_readinfo(JOIN *join, ulonglong options, uint no_jbuf_after)
     }
 
     tab->remove_redundant_bnl_scan_conds();
+    tab->scan_filter= NULL;
+    if ((tab->type == JT_ALL || tab->type == JT_NEXT) && tab->table &&
+        !tab->bush_children && tab->select_cond)
+      tab->scan_filter= Scan_filter::create(join->thd, tab->table,
+                                            tab->select_cond);
     DBUG_EXECUTE("where",
                  char buff[256];
                  String str(buff,sizeof(buff),system_charset_info);
@@ -16652,7 +16781,10 @@ create_tmp_table(THD *thd, TMP_TABLE_PARAM *param, List<Item> &fields,
       (string_total_length >= STRING_TOTAL_LENGTH_TO_PACK_ROWS &&
        (reclength / string_total_length <= RATIO_TO_PACK_ROWS ||
         string_total_length / string_count >= AVG_STRING_LENGTH_TO_PACK_ROWS)))
+  {
     use_packed_rows= 1;
+    share->db_create_options|= HA_OPTION_PACK_RECORD;
+  }
 
   share->reclength= reclength;
   {
@@ -16770,11 +16902,29 @@ create_tmp_table(THD *thd, TMP_TABLE_PARAM *param, List<Item> &fields,
   if (thd->variables.tmp_table_size == ~ (ulonglong) 0)		// No limit
     share->max_rows= ~(ha_rows) 0;
   else
+  {
+    ulong row_length= share->reclength;
+    if (share->db_type() == heap_hton &&
+        (share->db_create_options & HA_OPTION_PACK_RECORD))
+    {
+      /*
+        HEAP stores the VARCHARs by their actual length and checks the
+        size of the table itself, so only the fixed part of the row limits
+        the number of rows here.
+      */
+      for (Field **ptr= table->field; *ptr; ptr++)
+      {
+        if ((*ptr)->real_type() == MYSQL_TYPE_VARCHAR)
+          row_length-= (*ptr)->field_length;
+      }
+      set_if_bigger(row_length, sizeof(uchar*));
+    }
     share->max_rows= (ha_rows) (((share->db_type() == heap_hton) ?
                                  MY_MIN(thd->variables.tmp_table_size,
                                      thd->variables.max_heap_table_size) :
                                  thd->variables.tmp_table_size) /
-			         share->reclength);
+			         row_length);
+  }
   set_if_bigger(share->max_rows,1);		// For dummy start options
   /*
     Push the LIMIT clause to the temporary table creation, so that we
@@ -17893,6 +18043,15 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   }
   /* Set up select_end */
   Next_select_func end_select= setup_end_select_func(join);
+  if (end_select == end_update && Group_hash::is_applicable(join, table) &&
+      (join->group_hash ||
+       (join->group_hash= new (join->thd->mem_root) Group_hash)) &&
+      !join->group_hash->init(join, table))
+  {
+    DBUG_PRINT("info",("Using end_hash_update"));
+    join->group_hash->spill_select= end_update;
+    end_select= end_hash_update;
+  }
   if (join->table_count)
   {
     join->join_tab[join->top_join_tab_count - 1].next_select= end_select;
@@ -17954,7 +18113,8 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
 
     if (join->outer_ref_cond && !join->outer_ref_cond->val_int())
       error= NESTED_LOOP_NO_MORE_ROWS;
-    else
+    else if (end_select != end_send_group ||
+             !Parallel_scan::run(join, join_tab, &error))
       error= sub_select(join,join_tab,0);
     if ((error == NESTED_LOOP_OK || error == NESTED_LOOP_NO_MORE_ROWS) &&
         join->thd->killed != ABORT_QUERY)
@@ -17968,6 +18128,18 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   if (error == NESTED_LOOP_NO_MORE_ROWS || join->thd->killed == ABORT_QUERY)
     error= NESTED_LOOP_OK;
 
+  if (join->group_hash)
+  {
+    /*
+      LIMIT ROWS EXAMINED skips the end of records call, which writes the
+      groups in memory: write them here, as end_update() would have.
+    */
+    if (join->thd->killed == ABORT_QUERY && !join->thd->is_error() &&
+        join->group_hash->flush())
+      error= NESTED_LOOP_ERROR;
+    join->group_hash->free();
+  }
+
   if (table)
   {
     int tmp, new_errno= 0;
@@ -18399,7 +18571,13 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
 
   if (select_cond)
   {
-    select_cond_result= MY_TEST(select_cond->val_int());
+    Scan_filter *filter= join_tab->scan_filter;
+    if (filter && filter->cond == select_cond)
+      select_cond_result= filter->check() &&
+                          (filter->covers_cond ||
+                           MY_TEST(select_cond->val_int()));
+    else
+      select_cond_result= MY_TEST(select_cond->val_int());
 
     /* check for errors evaluating the condition */
     if (join->thd->is_error())
@@ -19698,6 +19876,30 @@ end_write(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/** Make a key of group index in TMP_TABLE_PARAM::group_buff. */
+
+static void make_group_key(TABLE *table)
+{
+  for (ORDER *group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    if (group->fast_field_copier_setup != group->field)
+    {
+      DBUG_PRINT("info", ("new setup 0x%lx -> 0x%lx",
+                          (ulong)group->fast_field_copier_setup,
+                          (ulong)group->field));
+      group->fast_field_copier_setup= group->field;
+      group->fast_field_copier_func=
+        item->setup_fast_field_copier(group->field);
+    }
+    item->save_org_in_field(group->field, group->fast_field_copier_func);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+}
+
+
 /*
   @brief
     Perform a GROUP BY operation over rows coming in arbitrary order. 
@@ -19714,7 +19916,6 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 	   bool end_of_records)
 {
   TABLE *table=join->tmp_table;
-  ORDER   *group;
   int	  error;
   DBUG_ENTER("end_update");
 
@@ -19723,24 +19924,7 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 
   join->found_records++;
   copy_fields(&join->tmp_table_param);		// Groups are copied twice.
-  /* Make a key of group index */
-  for (group=table->group ; group ; group=group->next)
-  {
-    Item *item= *group->item;
-    if (group->fast_field_copier_setup != group->field)
-    {
-      DBUG_PRINT("info", ("new setup 0x%lx -> 0x%lx",
-                          (ulong)group->fast_field_copier_setup,
-                          (ulong)group->field));
-      group->fast_field_copier_setup= group->field;
-      group->fast_field_copier_func=
-        item->setup_fast_field_copier(group->field);
-    }
-    item->save_org_in_field(group->field, group->fast_field_copier_func);
-    /* Store in the used key if the field was 0 */
-    if (item->maybe_null)
-      group->buff[-1]= (char) group->field->is_null();
-  }
+  make_group_key(table);
   if (!table->file->ha_index_read_map(table->record[1],
                                       join->tmp_table_param.group_buff,
                                       HA_WHOLE_KEY,
@@ -19837,6 +20021,100 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Like end_update, but the groups are collected in join->group_hash and
+  written to the temporary table at the end of records.
+  The rows of the groups that did not fit in memory go to end_update()
+  (or end_unique_update() after the table was converted).
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
+{
+  TABLE *table=join->tmp_table;
+  Group_hash *hash= join->group_hash;
+  JOIN_TAB *last_tab;
+  enum_nested_loop_state rc;
+  uchar *rec, *key= join->tmp_table_param.group_buff;
+  uint32 hash_value;
+  int res;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+  {
+    if (hash->flush())
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    DBUG_RETURN(NESTED_LOOP_OK);
+  }
+
+  copy_fields(&join->tmp_table_param);		// Groups are copied twice.
+  make_group_key(table);
+  hash_value= hash->hash_key(key);
+  if (!hash->is_spilled(hash_value))
+  {
+    /*
+      Count the lookup and the update or insert of the group like the
+      handler calls of end_update() are counted, for LIMIT ROWS EXAMINED.
+    */
+    join->thd->check_limit_rows_examined();
+    if ((rec= hash->find(key, hash_value)))
+    {						/* Update old record */
+      memcpy(table->record[0], rec, table->s->reclength);
+      update_tmptable_sum_func(join->sum_funcs,table);
+      memcpy(rec, table->record[0], table->s->reclength);
+      join->thd->check_limit_rows_examined();
+      goto end;
+    }
+    if ((res= hash->add(key, hash_value, &rec)) < 0)
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    if (hash->converted)
+    {
+      /* Change method to update rows, like end_update() does */
+      hash->converted= FALSE;
+      if ((res= table->file->ha_index_init(0, 0)))
+      {
+        table->file->print_error(res, MYF(0));
+        DBUG_RETURN(NESTED_LOOP_ERROR);
+      }
+      hash->spill_select= end_unique_update;
+    }
+    if (!res)
+    {
+      init_tmptable_sum_functions(join->sum_funcs);
+      if (copy_funcs(join->tmp_table_param.items_to_copy, join->thd))
+        DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+      memcpy(rec, table->record[0], table->s->reclength);
+      join->thd->check_limit_rows_examined();
+      join->send_records++;
+      goto end;
+    }
+  }
+
+  /* The group is in the temporary table */
+  rc= (*hash->spill_select)(join, join_tab, FALSE);
+  if (join->table_count)
+  {
+    last_tab= join->join_tab + join->top_join_tab_count - 1;
+    if (last_tab->next_select != end_hash_update)
+    {
+      /* end_update() has switched to end_unique_update() */
+      hash->spill_select= last_tab->next_select;
+      last_tab->next_select= end_hash_update;
+    }
+  }
+  DBUG_RETURN(rc);
+
+end:
+  join->found_records++;
+  if (join->thd->check_killed())
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 /*
   @brief
     Perform a GROUP BY operation over a stream of rows ordered by their group.
@@ -25476,7 +25754,7 @@ JOIN::reoptimize(Item *added_where, table_map join_tables,
     return REOPT_ERROR;
 
   /* Re-run the join optimizer to compute a new query plan. */
-  if (choose_plan(this, join_tables))
+  if (choose_plan(this, join_tables, FALSE))
     return REOPT_ERROR;
 
   return REOPT_NEW_PLAN;
@@ -197,6 +197,7 @@ int rr_sequential_and_unpack(READ_RECORD *info);
 class JOIN_CACHE;
 class SJ_TMP_TABLE;
 class JOIN_TAB_RANGE;
+class Scan_filter;
 
 typedef struct st_join_table {
   st_join_table() {}                          /* Remove gcc warning */
@@ -206,6 +207,8 @@ typedef struct st_join_table {
 				    not supported by any index                 */
   SQL_SELECT	*select;
   COND		*select_cond;
+  /* Simple conjuncts of select_cond checked on the record, or NULL */
+  Scan_filter   *scan_filter;
   COND          *on_precond;    /**< part of on condition to check before
 				     accessing the first inner table           */  
   QUICK_SELECT_I *quick;
@@ -876,6 +879,27 @@ typedef struct st_rollup
 } ROLLUP;
 
 
+/**
+  Join order chosen for a SELECT of a prepared statement, kept in the
+  statement's memory so that later executions can skip the search for it
+  (see prepared_stmt_plan_cache).
+*/
+
+class Cached_join_order: public Sql_alloc
+{
+public:
+  struct Table_entry
+  {
+    TABLE_LIST *table;
+    ulong table_ref_version;            /* TABLE_SHARE the order was found for */
+    ha_rows records;                    /* Row estimate the order was found with */
+  };
+  table_map const_table_map;            /* Tables that were constant */
+  uint count, size;                     /* Entries used and allocated */
+  Table_entry *tables;                  /* Non-constant tables in join order */
+};
+
+
 class JOIN_TAB_RANGE: public Sql_alloc
 {
 public:
@@ -884,6 +908,7 @@ class JOIN_TAB_RANGE: public Sql_alloc
 };
 
 class Pushdown_query;
+class Group_hash;
 
 class JOIN :public Sql_alloc
 {
@@ -1087,6 +1112,8 @@ class JOIN :public Sql_alloc
   POSITION *best_positions;
 
   Pushdown_query *pushdown_query;
+  /* Groups collected in memory by end_hash_update() */
+  Group_hash *group_hash;
   JOIN_TAB *original_join_tab;
   uint	   original_table_count;
 
@@ -1389,6 +1416,7 @@ class JOIN :public Sql_alloc
     no_rows_in_result_called= 0;
     positions= best_positions= 0;
     pushdown_query= 0;
+    group_hash= 0;
     original_join_tab= 0;
     do_select_call_count= 0;
 
@@ -1871,7 +1899,7 @@ inline Item * and_items(THD *thd, Item* cond, Item *item)
 {
   return (cond ? (new (thd->mem_root) Item_cond_and(thd, cond, item)) : item);
 }
-bool choose_plan(JOIN *join, table_map join_tables);
+bool choose_plan(JOIN *join, table_map join_tables, bool use_plan_cache);
 void optimize_wo_join_buffering(JOIN *join, uint first_tab, uint last_tab, 
                                 table_map last_remaining_tables, 
                                 bool first_alt, uint no_jbuf_before,
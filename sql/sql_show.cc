@@ -2371,7 +2371,7 @@ static int show_create_view(THD *thd, TABLE_LIST *table, String *buff)
   returns for each thread: thread id, user, host, db, command, info
 ****************************************************************************/
 
-class thread_info :public ilink {
+class thread_info {
 public:
   static void *operator new(size_t size, MEM_ROOT *mem_root) throw ()
   { return alloc_root(mem_root, size); }
@@ -2388,6 +2388,15 @@ class thread_info :public ilink {
   double progress;
 };
 
+
+/* Sort SHOW PROCESSLIST by thread id, oldest connection first */
+
+static int thread_info_cmp(thread_info* const *a, thread_info* const *b)
+{
+  return ((*a)->thread_id < (*b)->thread_id ? -1 :
+          (*a)->thread_id > (*b)->thread_id ? 1 : 0);
+}
+
 static const char *thread_state_info(THD *tmp)
 {
 #ifndef EMBEDDED_LIBRARY
@@ -2416,7 +2425,7 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 {
   Item *field;
   List<Item> field_list;
-  I_List<thread_info> thread_infos;
+  Dynamic_array<thread_info*> thread_infos;
   ulong max_query_length= (verbose ? thd->variables.max_allowed_packet :
 			   PROCESS_LIST_WIDTH);
   Protocol *protocol= thd->protocol;
@@ -2468,8 +2477,7 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
   if (thd->killed)
     DBUG_VOID_RETURN;
 
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   THD *tmp;
   while ((tmp=it++))
   {
@@ -2543,15 +2551,15 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
       thread_infos.append(thd_info);
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  thread_infos.sort(thread_info_cmp);
 
-  thread_info *thd_info;
   ulonglong now= microsecond_interval_timer();
   char buff[20];                                // For progress
   String store_buffer(buff, sizeof(buff), system_charset_info);
 
-  while ((thd_info=thread_infos.get()))
+  for (size_t i= 0; i < thread_infos.elements(); i++)
   {
+    thread_info *thd_info= thread_infos.at(i);
     protocol->prepare_for_resend();
     protocol->store((ulonglong) thd_info->thread_id);
     protocol->store(thd_info->user, system_charset_info);
@@ -2846,11 +2854,9 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, COND* cond)
   user= thd->security_ctx->master_access & PROCESS_ACL ?
         NullS : thd->security_ctx->priv_user;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
   if (!thd->killed)
   {
-    I_List_iterator<THD> it(threads);
+    THD_list_iterator it(server_threads);
     THD* tmp;
 
     while ((tmp= it++))
@@ -2973,14 +2979,10 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, COND* cond)
       table->field[16]->store(tmp->os_thread_id);
 
       if (schema_table_store_record(thd, table))
-      {
-        mysql_mutex_unlock(&LOCK_thread_count);
         DBUG_RETURN(1);
-      }
     }
   }
 
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_RETURN(0);
 }
 
@@ -3392,37 +3394,30 @@ static bool show_status_array(THD *thd, const char *wild,
 
 /*
   collect status for all running threads
-  Return number of threads used
+
+  Other threads are included as of the end of their last statement, see
+  THD::publish_status(); the current thread is included up to now.
 */
 
-uint calc_sum_of_all_status(STATUS_VAR *to)
+void calc_sum_of_all_status(STATUS_VAR *to)
 {
-  uint count= 0;
+  THD *thd= current_thd;
   DBUG_ENTER("calc_sum_of_all_status");
 
-  /* Ensure that thread id not killed during loop */
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-
-  I_List_iterator<THD> it(threads);
-  THD *tmp;
-
   /* Get global values as base */
   *to= global_status_var;
-  to->local_memory_used= 0;
 
-  /* Add to this status from existing threads */
-  while ((tmp= it++))
+  /* Add the status published by running threads */
+  add_published_status(to);
+
+  /* Add what the current thread has not published yet */
+  if (thd && !thd->status_in_global)
   {
-    count++;
-    if (!tmp->status_in_global)
-    {
-      add_to_status(to, &tmp->status_var);
-      to->local_memory_used+= tmp->status_var.local_memory_used;
-    }
+    add_diff_to_status(to, &thd->status_var, &thd->published_status_var);
+    to->local_memory_used+= (thd->status_var.local_memory_used -
+                             thd->published_status_var.local_memory_used);
   }
-  
-  mysql_mutex_unlock(&LOCK_thread_count);
-  DBUG_RETURN(count);
+  DBUG_VOID_RETURN;
 }
 
 
@@ -33,6 +33,9 @@ struct TABLE;
 #define MERGEBUFF		7
 #define MERGEBUFF2		15
 
+/* Don't start a sort thread for less keys than this */
+#define MIN_KEYS_PER_SORT_THREAD	16384
+
 /*
    The structure SORT_ADDON_FIELD describes a fixed layout
    for field values appended to sorted values in records to be sorted
@@ -75,6 +78,7 @@ class Sort_param {
   uint res_length;            // Length of records in final sorted file/buffer.
   uint max_keys_per_buffer;   // Max keys / buffer.
   uint min_dupl_count;
+  uint sort_threads;          // Max threads for sorting, 1 if no parallelism.
   ha_rows max_rows;           // Select limit, or HA_POS_ERROR if unlimited.
   ha_rows examined_rows;      // Number of examined rows.
   TABLE *sort_form;           // For quicker make_sortkey.
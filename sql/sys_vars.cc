@@ -2273,6 +2273,23 @@ static Sys_var_ulong Sys_net_retry_count(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_net_retry_count));
 
+static bool fix_net_compression_level(sys_var *self, THD *thd,
+                                      enum_var_type type)
+{
+  if (type != OPT_GLOBAL)
+    thd->net.compress_level= (uchar) thd->variables.net_compression_level;
+  return false;
+}
+static Sys_var_ulong Sys_net_compression_level(
+       "net_compression_level",
+       "zlib compression level (1-9) of the packets sent to clients that "
+       "use the compressed protocol. Lower levels cost less CPU for a "
+       "somewhat lower compression ratio",
+       SESSION_VAR(net_compression_level), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 9), DEFAULT(6), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_net_compression_level));
+
 static Sys_var_mybool Sys_old_mode(
        "old", "Use compatible behavior from previous MariaDB version. See also --old-mode",
        SESSION_VAR(old_mode), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
@@ -2392,6 +2409,7 @@ export const char *optimizer_switch_names[]=
   "extended_keys",
   "exists_to_in",
   "orderby_uses_equalities",
+  "hash_group_by",
   "default", 
   NullS
 };
@@ -2441,6 +2459,24 @@ static Sys_var_ulong Sys_preload_buff_size(
        SESSION_VAR(preload_buff_size), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1024, 1024*1024*1024), DEFAULT(32768), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_prepared_stmt_cache_size(
+       "prepared_stmt_cache_size",
+       "How many closed prepared statements a connection keeps, already "
+       "parsed, so that preparing the same statement text again does not "
+       "have to parse it. Kept statements count against "
+       "max_prepared_stmt_count. 0 disables the cache",
+       SESSION_VAR(prepared_stmt_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_mybool Sys_prepared_stmt_plan_cache(
+       "prepared_stmt_plan_cache",
+       "Let a prepared statement reuse the join order chosen by its previous "
+       "execution, instead of searching for one every time, as long as the "
+       "same tables are constant and the tables and their statistics have "
+       "not changed much",
+       SESSION_VAR(prepared_stmt_plan_cache), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 static Sys_var_uint Sys_protocol_version(
        "protocol_version",
        "The version of the client/server protocol used by the MySQL server",
@@ -2759,6 +2795,14 @@ static Sys_var_ulonglong Sys_query_cache_size(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, NULL,
        ON_UPDATE(fix_query_cache_size));
 
+static Sys_var_uint Sys_query_cache_instances(
+       "query_cache_instances",
+       "Number of query cache instances. The query cache memory is split "
+       "evenly between them, each instance has its own lock and queries "
+       "are assigned to instances by the hash of the query text",
+       READ_ONLY GLOBAL_VAR(query_cache_instances), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, QUERY_CACHE_MAX_INSTANCES), DEFAULT(1), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_query_cache_limit(
        "query_cache_limit",
        "Don't cache results that are bigger than this",
@@ -2996,6 +3040,21 @@ static Sys_var_ulonglong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, SIZE_T_MAX), DEFAULT(MAX_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_sort_threads(
+       "sort_threads",
+       "Maximum number of threads a sort may use to sort and merge its "
+       "buffers. 1 disables parallel sorting",
+       SESSION_VAR(sort_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, MAX_SORT_THREADS), DEFAULT(1), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_parallel_scan_threads(
+       "parallel_scan_threads",
+       "Maximum number of threads that may scan a table for a single-table "
+       "query with only COUNT, SUM, AVG, MIN and MAX of integer columns. "
+       "1 disables parallel scans",
+       SESSION_VAR(parallel_scan_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, MAX_PARALLEL_SCAN_THREADS), DEFAULT(1), BLOCK_SIZE(1));
+
 export ulonglong expand_sql_mode(ulonglong sql_mode)
 {
   if (sql_mode & MODE_ANSI)
@@ -3216,6 +3275,14 @@ static Sys_var_ulong Sys_table_cache_size(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_table_open_cache));
 
+static Sys_var_uint Sys_table_cache_instances(
+       "table_open_cache_instances",
+       "Number of table cache instances. Each instance has its own mutex "
+       "and list of unused tables, threads are assigned to instances by "
+       "connection id",
+       READ_ONLY GLOBAL_VAR(tc_instances), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(8), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_thread_cache_size(
        "thread_cache_size",
        "How many threads we should keep in a cache for reuse",
@@ -3291,6 +3358,14 @@ static Sys_var_uint Sys_threadpool_oversubscribe(
   GLOBAL_VAR(threadpool_oversubscribe), CMD_LINE(REQUIRED_ARG),
   VALID_RANGE(1, 1000), DEFAULT(3), BLOCK_SIZE(1)
 );
+static Sys_var_uint Sys_threadpool_prio_kickup_timer(
+  "thread_pool_prio_kickup_timer",
+  "Time in milliseconds a connection can wait in the low priority queue "
+  "of a thread group, before it is moved to the high priority queue. "
+  "Connections in the middle of a transaction use the high priority queue.",
+  GLOBAL_VAR(threadpool_prio_kickup_timer), CMD_LINE(REQUIRED_ARG),
+  VALID_RANGE(0, UINT_MAX), DEFAULT(1000), BLOCK_SIZE(1)
+);
 static Sys_var_uint Sys_threadpool_size(
  "thread_pool_size",
  "Number of thread groups in the pool. "
@@ -5148,6 +5223,16 @@ static Sys_var_ulong Sys_join_cache_level(
        SESSION_VAR(join_cache_level), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 8), DEFAULT(2), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_join_cache_spill_partitions(
+       "join_cache_spill_partitions",
+       "Number of partitions a hashed join buffer splits the joined records "
+       "into on disk when they don't fit into the buffer, so that the joined "
+       "table is scanned only once. 0 disables spilling. Each partition "
+       "uses up to two temporary files",
+       SESSION_VAR(join_cache_spill_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, MAX_JOIN_CACHE_SPILL_PARTITIONS), DEFAULT(0),
+       BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_mrr_buffer_size(
        "mrr_buffer_size",
        "Size of buffer to use when using MRR with range access",
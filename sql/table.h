@@ -492,6 +492,7 @@ TABLE_CATEGORY get_table_category(const LEX_STRING *db,
 
 struct TABLE_share;
 struct All_share_tables;
+struct Global_free_tables;
 
 typedef struct st_table_field_type
 {
@@ -1060,12 +1061,15 @@ struct TABLE
   */
   TABLE *share_all_next, **share_all_prev;
   friend struct All_share_tables;
+  /**
+     Links for the list of unused TABLE objects of a table cache instance.
+  */
+  TABLE *global_free_next, **global_free_prev;
+  friend struct Global_free_tables;
 
 public:
 
   THD	*in_use;                        /* Which thread uses this */
-  /* Time when table was released to table cache. Valid for unused tables. */
-  ulonglong tc_time;
   Field **field;			/* Pointer to fields */
 
   uchar *record[2];			/* Pointer to records */
@@ -1479,6 +1483,25 @@ struct All_share_tables
 };
 
 
+/**
+   Helper class which specifies which members of TABLE are used for
+   participation in the LRU list of unused TABLE objects of a table
+   cache instance.
+*/
+
+struct Global_free_tables
+{
+  static inline TABLE **next_ptr(TABLE *l)
+  {
+    return &l->global_free_next;
+  }
+  static inline TABLE ***prev_ptr(TABLE *l)
+  {
+    return &l->global_free_prev;
+  }
+};
+
+
 enum enum_schema_table_state
 { 
   NOT_PROCESSED= 0,
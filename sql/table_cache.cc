@@ -46,6 +46,16 @@
   - TABLE_SHARE::free_tables shall not contain objects with TABLE::in_use != 0
   - TABLE_SHARE::free_tables shall not receive new objects if
     TABLE_SHARE::tdc.flushed is true
+
+  Table cache is split into tc_instances instances. Each instance has its
+  own mutex, its own list of unused TABLE objects in LRU order and its own
+  list of unused TABLE objects per share. A thread always acquires and
+  releases TABLE objects through the instance picked by its thread id, so
+  that threads opening the same table do not serialize on
+  TABLE_SHARE::tdc.LOCK_table_share.
+
+  Lock order: TABLE_SHARE::tdc.LOCK_table_share before
+  Table_cache_instance::LOCK_table_cache.
 */
 
 #include "my_global.h"
@@ -57,6 +67,7 @@
 /** Configuration. */
 ulong tdc_size; /**< Table definition cache threshold for LRU eviction. */
 ulong tc_size; /**< Table cache threshold for LRU eviction. */
+uint tc_instances; /**< Number of table cache instances. */
 
 /** Data collections. */
 static LF_HASH tdc_hash; /**< Collection of TABLE_SHARE objects. */
@@ -73,6 +84,27 @@ static bool tdc_inited;
 static int32 tc_count; /**< Number of TABLE objects in table cache. */
 
 
+/**
+  Table cache instance.
+*/
+
+struct Table_cache_instance
+{
+  /**
+    Protects free_tables of this instance and TDC_element::free_tables
+    of this instance of all shares.
+  */
+  mysql_mutex_t LOCK_table_cache;
+  /** Unused TABLE objects of this instance, least recently used first. */
+  I_P_List <TABLE, Global_free_tables, I_P_List_null_counter,
+            I_P_List_fast_push_back<TABLE> > free_tables;
+  /** Avoid false sharing between instances. */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+};
+
+static Table_cache_instance *tc;
+
+
 /**
   Protects unused shares list.
 
@@ -84,11 +116,13 @@ static int32 tc_count; /**< Number of TABLE objects in table cache. */
 static mysql_mutex_t LOCK_unused_shares;
 
 #ifdef HAVE_PSI_INTERFACE
-PSI_mutex_key key_LOCK_unused_shares, key_TABLE_SHARE_LOCK_table_share;
+PSI_mutex_key key_LOCK_unused_shares, key_TABLE_SHARE_LOCK_table_share,
+              key_LOCK_table_cache;
 static PSI_mutex_info all_tc_mutexes[]=
 {
   { &key_LOCK_unused_shares, "LOCK_unused_shares", PSI_FLAG_GLOBAL },
-  { &key_TABLE_SHARE_LOCK_table_share, "TABLE_SHARE::tdc.LOCK_table_share", 0 }
+  { &key_TABLE_SHARE_LOCK_table_share, "TABLE_SHARE::tdc.LOCK_table_share", 0 },
+  { &key_LOCK_table_cache, "Table_cache_instance::LOCK_table_cache", 0 }
 };
 
 PSI_cond_key key_TABLE_SHARE_COND_release;
@@ -119,6 +153,16 @@ static int fix_thd_pins(THD *thd)
 }
 
 
+/**
+  Get table cache instance used by given thread.
+*/
+
+static inline uint tc_instance(THD *thd)
+{
+  return (uint) (thd->thread_id % tc_instances);
+}
+
+
 /*
   Auxiliary routines for manipulating with per-share all/unused lists
   and tc_count counter.
@@ -153,12 +197,43 @@ static void tc_remove_table(TABLE *table)
 }
 
 
+/**
+  Remove all unused TABLE objects of a share from table cache.
+
+  @pre Caller should have TABLE_SHARE::tdc.LOCK_table_share mutex and
+       must have waited for MDL deadlock detector.
+
+  Removed objects are added to purge_tables, caller is expected to free
+  them after unlocking the share.
+*/
+
+static void tc_remove_unused_tables(TDC_element *element,
+                                    TDC_element::TABLE_list *purge_tables)
+{
+  mysql_mutex_assert_owner(&element->LOCK_table_share);
+  DBUG_ASSERT(!element->all_tables_refs);
+
+  for (uint i= 0; i < tc_instances; i++)
+  {
+    TABLE *table;
+    mysql_mutex_lock(&tc[i].LOCK_table_cache);
+    while ((table= element->free_tables[i].list.pop_front()))
+    {
+      tc[i].free_tables.remove(table);
+      tc_remove_table(table);
+      purge_tables->push_front(table);
+    }
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  }
+}
+
+
 /**
   Free all unused TABLE objects.
 
   While locked:
-  - remove unused objects from TABLE_SHARE::tdc.free_tables and
-    TABLE_SHARE::tdc.all_tables
+  - remove unused objects from TABLE_SHARE::tdc.free_tables of all
+    instances and TABLE_SHARE::tdc.all_tables
   - decrement tc_count
 
   While unlocked:
@@ -177,17 +252,11 @@ struct tc_purge_arg
 
 static my_bool tc_purge_callback(TDC_element *element, tc_purge_arg *arg)
 {
-  TABLE *table;
-
   mysql_mutex_lock(&element->LOCK_table_share);
   element->wait_for_mdl_deadlock_detector();
   if (arg->mark_flushed)
     element->flushed= true;
-  while ((table= element->free_tables.pop_front()))
-  {
-    tc_remove_table(table);
-    arg->purge_tables.push_front(table);
-  }
+  tc_remove_unused_tables(element, &arg->purge_tables);
   mysql_mutex_unlock(&element->LOCK_table_share);
   return FALSE;
 }
@@ -205,6 +274,48 @@ void tc_purge(bool mark_flushed)
 }
 
 
+/**
+  Evict least recently used unused TABLE object from table cache.
+
+  Instance of current thread is tried first, then other instances in turn.
+  This way a thread may evict objects cached by idle instances.
+
+  LOCK_table_cache is acquired before TABLE_SHARE::tdc.LOCK_table_share
+  here, which is the reverse of lock order. Thus share mutex is only
+  tried: if it is busy (or MDL deadlock detector is traversing the share)
+  just go ahead with the next instance, number of objects in table cache
+  will normalize eventually.
+*/
+
+static void tc_evict_lru_table(uint start)
+{
+  for (uint n= 0; n < tc_instances; n++)
+  {
+    uint i= (start + n) % tc_instances;
+    TDC_element *element;
+    TABLE *table;
+
+    mysql_mutex_lock(&tc[i].LOCK_table_cache);
+    if ((table= tc[i].free_tables.front()) &&
+        !mysql_mutex_trylock(&(element= table->s->tdc)->LOCK_table_share))
+    {
+      if (!element->all_tables_refs)
+      {
+        tc[i].free_tables.remove(table);
+        element->free_tables[i].list.remove(table);
+        tc_remove_table(table);
+        mysql_mutex_unlock(&element->LOCK_table_share);
+        mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+        intern_close_table(table);
+        return;
+      }
+      mysql_mutex_unlock(&element->LOCK_table_share);
+    }
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  }
+}
+
+
 /**
   Add new TABLE object to table cache.
 
@@ -215,39 +326,13 @@ void tc_purge(bool mark_flushed)
   While locked:
   - add object to TABLE_SHARE::tdc.all_tables
   - increment tc_count
-  - evict LRU object from table cache if we reached threshold
 
   While unlocked:
-  - free evicted object
+  - evict LRU object from table cache if we reached threshold
 */
 
-struct tc_add_table_arg
-{
-  char key[MAX_DBKEY_LENGTH];
-  uint key_length;
-  ulonglong purge_time;
-};
-
-
-my_bool tc_add_table_callback(TDC_element *element, tc_add_table_arg *arg)
-{
-  TABLE *table;
-
-  mysql_mutex_lock(&element->LOCK_table_share);
-  if ((table= element->free_tables_back()) && table->tc_time < arg->purge_time)
-  {
-    memcpy(arg->key, element->m_key, element->m_key_length);
-    arg->key_length= element->m_key_length;
-    arg->purge_time= table->tc_time;
-  }
-  mysql_mutex_unlock(&element->LOCK_table_share);
-  return FALSE;
-}
-
-
 void tc_add_table(THD *thd, TABLE *table)
 {
-  bool need_purge;
   DBUG_ASSERT(table->in_use == thd);
   mysql_mutex_lock(&table->s->tdc->LOCK_table_share);
   table->s->tdc->wait_for_mdl_deadlock_detector();
@@ -255,46 +340,42 @@ void tc_add_table(THD *thd, TABLE *table)
   mysql_mutex_unlock(&table->s->tdc->LOCK_table_share);
 
   /* If we have too many TABLE instances around, try to get rid of them */
-  need_purge= my_atomic_add32_explicit(&tc_count, 1, MY_MEMORY_ORDER_RELAXED) >=
-              (int32) tc_size;
+  if (my_atomic_add32_explicit(&tc_count, 1, MY_MEMORY_ORDER_RELAXED) >=
+      (int32) tc_size)
+    tc_evict_lru_table(tc_instance(thd));
+}
 
-  if (need_purge)
-  {
-    tc_add_table_arg argument;
-    argument.purge_time= ULONGLONG_MAX;
-    tdc_iterate(thd, (my_hash_walk_action) tc_add_table_callback, &argument);
 
-    if (argument.purge_time != ULONGLONG_MAX)
-    {
-      TDC_element *element= (TDC_element*) lf_hash_search(&tdc_hash,
-                                                          thd->tdc_hash_pins,
-                                                          argument.key,
-                                                          argument.key_length);
-      if (element)
-      {
-        TABLE *entry;
-        mysql_mutex_lock(&element->LOCK_table_share);
-        lf_hash_search_unpin(thd->tdc_hash_pins);
-        element->wait_for_mdl_deadlock_detector();
-
-        /*
-          It may happen that oldest table was acquired meanwhile. In this case
-          just go ahead, number of objects in table cache will normalize
-          eventually.
-        */
-        if ((entry= element->free_tables_back()) &&
-            entry->tc_time == argument.purge_time)
-        {
-          element->free_tables.remove(entry);
-          tc_remove_table(entry);
-          mysql_mutex_unlock(&element->LOCK_table_share);
-          intern_close_table(entry);
-        }
-        else
-          mysql_mutex_unlock(&element->LOCK_table_share);
-      }
-    }
+/**
+  Acquire TABLE object from table cache.
+
+  @pre share must be protected against removal.
+
+  Acquired object cannot be evicted or acquired again.
+
+  Only unused objects of the instance of current thread are considered.
+
+  @return TABLE object, or NULL if no unused objects.
+*/
+
+static TABLE *tc_acquire_table(THD *thd, TDC_element *element)
+{
+  uint i= tc_instance(thd);
+  TABLE *table;
+
+  mysql_mutex_lock(&tc[i].LOCK_table_cache);
+  if ((table= element->free_tables[i].list.pop_front()))
+  {
+    tc[i].free_tables.remove(table);
+    DBUG_ASSERT(!table->in_use);
+    table->in_use= thd;
+    /* The ex-unused table must be fully functional. */
+    DBUG_ASSERT(table->db_stat && table->file);
+    /* The children must be detached from the table. */
+    DBUG_ASSERT(!table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
   }
+  mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  return table;
 }
 
 
@@ -305,19 +386,25 @@ void tc_add_table(THD *thd, TABLE *table)
 
   Released object may be evicted or acquired again.
 
-  While locked:
-  - if object is marked for purge, decrement tc_count
-  - add object to TABLE_SHARE::tdc.free_tables
-  - evict LRU object from table cache if we reached threshold
+  While locked by LOCK_table_cache of the instance of current thread:
+  - add object to TABLE_SHARE::tdc.free_tables of this instance
+  - add object to the tail of LRU list of this instance
+  - mark object not in use by any thread
+
+  While locked by TABLE_SHARE::tdc.LOCK_table_share (purge only):
+  - decrement tc_count
+  - remove object from TABLE_SHARE::tdc.all_tables
 
   While unlocked:
-  - mark object not in use by any thread
-  - free evicted/purged object
+  - free purged object
 
   @note Another thread may mark share for purge any moment (even
   after version check). It means to-be-purged object may go to
   unused lists. This other thread is expected to call tc_purge(),
-  which is synchronized with us on TABLE_SHARE::tdc.LOCK_table_share.
+  which marks share flushed and then removes unused objects of every
+  instance under LOCK_table_cache. Thus checking tdc.flushed under
+  LOCK_table_cache is enough: either we see the flag, or our object
+  is purged by the other thread.
 
   @return
     @retval true  object purged
@@ -326,20 +413,21 @@ void tc_add_table(THD *thd, TABLE *table)
 
 bool tc_release_table(TABLE *table)
 {
+  TDC_element *element= table->s->tdc;
+  uint i;
   DBUG_ASSERT(table->in_use);
   DBUG_ASSERT(table->file);
 
   if (table->needs_reopen() || tc_records() > tc_size)
-  {
-    mysql_mutex_lock(&table->s->tdc->LOCK_table_share);
     goto purge;
-  }
 
-  table->tc_time= my_interval_timer();
-
-  mysql_mutex_lock(&table->s->tdc->LOCK_table_share);
-  if (table->s->tdc->flushed)
+  i= tc_instance(table->in_use);
+  mysql_mutex_lock(&tc[i].LOCK_table_cache);
+  if (element->flushed)
+  {
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
     goto purge;
+  }
   /*
     in_use doesn't really need mutex protection, but must be reset after
     checking tdc.flushed and before this table appears in free_tables.
@@ -348,14 +436,16 @@ bool tc_release_table(TABLE *table)
   */
   table->in_use= 0;
   /* Add table to the list of unused TABLE objects for this share. */
-  table->s->tdc->free_tables.push_front(table);
-  mysql_mutex_unlock(&table->s->tdc->LOCK_table_share);
+  element->free_tables[i].list.push_front(table);
+  tc[i].free_tables.push_back(table);
+  mysql_mutex_unlock(&tc[i].LOCK_table_cache);
   return false;
 
 purge:
-  table->s->tdc->wait_for_mdl_deadlock_detector();
+  mysql_mutex_lock(&element->LOCK_table_share);
+  element->wait_for_mdl_deadlock_detector();
   tc_remove_table(table);
-  mysql_mutex_unlock(&table->s->tdc->LOCK_table_share);
+  mysql_mutex_unlock(&element->LOCK_table_share);
   table->in_use= 0;
   intern_close_table(table);
   return true;
@@ -417,23 +507,35 @@ static void tdc_delete_share_from_hash(TDC_element *element)
   Initialize table definition cache.
 */
 
-void tdc_init(void)
+bool tdc_init(void)
 {
   DBUG_ENTER("tdc_init");
 #ifdef HAVE_PSI_INTERFACE
   init_tc_psi_keys();
 #endif
+  if (!(tc= (Table_cache_instance*) my_malloc(sizeof(Table_cache_instance) *
+                                              tc_instances,
+                                              MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(true);
+  for (uint i= 0; i < tc_instances; i++)
+  {
+    mysql_mutex_init(key_LOCK_table_cache, &tc[i].LOCK_table_cache,
+                     MY_MUTEX_INIT_FAST);
+    tc[i].free_tables.empty();
+  }
   tdc_inited= true;
   mysql_mutex_init(key_LOCK_unused_shares, &LOCK_unused_shares,
                    MY_MUTEX_INIT_FAST);
   tdc_version= 1L;  /* Increments on each reload */
-  lf_hash_init(&tdc_hash, sizeof(TDC_element), LF_HASH_UNIQUE, 0, 0,
+  lf_hash_init(&tdc_hash, sizeof(TDC_element) +
+               sizeof(Share_free_tables) * (tc_instances - 1),
+               LF_HASH_UNIQUE, 0, 0,
                (my_hash_get_key) TDC_element::key,
                &my_charset_bin);
   tdc_hash.alloc.constructor= TDC_element::lf_alloc_constructor;
   tdc_hash.alloc.destructor= TDC_element::lf_alloc_destructor;
   tdc_hash.initializer= (lf_hash_initializer) TDC_element::lf_hash_initializer;
-  DBUG_VOID_RETURN;
+  DBUG_RETURN(false);
 }
 
 
@@ -475,6 +577,9 @@ void tdc_deinit(void)
     tdc_inited= false;
     lf_hash_destroy(&tdc_hash);
     mysql_mutex_destroy(&LOCK_unused_shares);
+    for (uint i= 0; i < tc_instances; i++)
+      mysql_mutex_destroy(&tc[i].LOCK_table_cache);
+    my_free(tc);
   }
   DBUG_VOID_RETURN;
 }
@@ -665,7 +770,7 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, const char *db, const char *table_name,
 
   if (out_table && (flags & GTS_TABLE))
   {
-    if ((*out_table= element->acquire_table(thd)))
+    if ((*out_table= tc_acquire_table(thd, element)))
     {
       lf_hash_search_unpin(thd->tdc_hash_pins);
       DBUG_ASSERT(!(flags & GTS_NOLOCK));
@@ -841,7 +946,7 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
                       const char *db, const char *table_name,
                       bool kill_delayed_threads)
 {
-  I_P_List <TABLE, TABLE_share> purge_tables;
+  TDC_element::TABLE_list purge_tables;
   TABLE *table;
   TDC_element *element;
   uint my_refs= 1;
@@ -892,11 +997,7 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
   if (remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE)
     element->flushed= true;
 
-  while ((table= element->free_tables.pop_front()))
-  {
-    tc_remove_table(table);
-    purge_tables.push_front(table);
-  }
+  tc_remove_unused_tables(element, &purge_tables);
   if (kill_delayed_threads)
     kill_delayed_threads_for_table(element);
 
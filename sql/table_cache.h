@@ -21,6 +21,26 @@ extern PSI_mutex_key key_TABLE_SHARE_LOCK_table_share;
 extern PSI_cond_key key_TABLE_SHARE_COND_release;
 #endif
 
+#ifndef CPU_LEVEL1_DCACHE_LINESIZE
+#define CPU_LEVEL1_DCACHE_LINESIZE 64
+#endif
+
+extern uint tc_instances;
+
+/**
+  Unused TABLE objects of a share which belong to one table cache instance.
+  Protected by Table_cache_instance::LOCK_table_cache of that instance.
+*/
+
+struct Share_free_tables
+{
+  typedef I_P_List <TABLE, TABLE_share> List;
+  List list;
+  /** Avoid false sharing between table cache instances. */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+};
+
+
 class TDC_element
 {
 public:
@@ -33,7 +53,7 @@ class TDC_element
   typedef I_P_List <TABLE, TABLE_share> TABLE_list;
   typedef I_P_List <TABLE, All_share_tables> All_share_tables_list;
   /**
-    Protects ref_count, m_flush_tickets, all_tables, free_tables, flushed,
+    Protects ref_count, m_flush_tickets, all_tables, flushed,
     all_tables_refs.
   */
   mysql_mutex_t LOCK_table_share;
@@ -46,11 +66,16 @@ class TDC_element
   */
   Wait_for_flush_list m_flush_tickets;
   /*
-    Doubly-linked (back-linked) lists of used and unused TABLE objects
+    Doubly-linked (back-linked) list of used and unused TABLE objects
     for this share.
   */
   All_share_tables_list all_tables;
-  TABLE_list free_tables;
+  /**
+    Unused TABLE objects for this share, one list per table cache instance.
+    Must be the last member: elements are allocated with room for
+    tc_instances lists.
+  */
+  Share_free_tables free_tables[1];
 
   TDC_element() {}
 
@@ -66,57 +91,16 @@ class TDC_element
     DBUG_ASSERT(ref_count == 0);
     DBUG_ASSERT(m_flush_tickets.is_empty());
     DBUG_ASSERT(all_tables.is_empty());
-    DBUG_ASSERT(free_tables.is_empty());
+#ifndef DBUG_OFF
+    for (uint i= 0; i < tc_instances; i++)
+      DBUG_ASSERT(free_tables[i].list.is_empty());
+#endif
     DBUG_ASSERT(all_tables_refs == 0);
     DBUG_ASSERT(next == 0);
     DBUG_ASSERT(prev == 0);
   }
 
 
-  /**
-    Acquire TABLE object from table cache.
-
-    @pre share must be protected against removal.
-
-    Acquired object cannot be evicted or acquired again.
-
-    @return TABLE object, or NULL if no unused objects.
-  */
-
-  TABLE *acquire_table(THD *thd)
-  {
-    TABLE *table;
-
-    mysql_mutex_lock(&LOCK_table_share);
-    table= free_tables.pop_front();
-    if (table)
-    {
-      DBUG_ASSERT(!table->in_use);
-      table->in_use= thd;
-      /* The ex-unused table must be fully functional. */
-      DBUG_ASSERT(table->db_stat && table->file);
-      /* The children must be detached from the table. */
-      DBUG_ASSERT(!table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
-    }
-    mysql_mutex_unlock(&LOCK_table_share);
-    return table;
-  }
-
-
-  /**
-    Get last element of free_tables.
-  */
-
-  TABLE *free_tables_back()
-  {
-    TABLE_list::Iterator it(free_tables);
-    TABLE *entry, *last= 0;
-     while ((entry= it++))
-       last= entry;
-    return last;
-  }
-
-
   /**
     Wait for MDL deadlock detector to complete traversing tdc.all_tables.
 
@@ -143,7 +127,8 @@ class TDC_element
     mysql_cond_init(key_TABLE_SHARE_COND_release, &element->COND_release, 0);
     element->m_flush_tickets.empty();
     element->all_tables.empty();
-    element->free_tables.empty();
+    for (uint i= 0; i < tc_instances; i++)
+      element->free_tables[i].list.empty();
     element->all_tables_refs= 0;
     element->share= 0;
     element->ref_count= 0;
@@ -197,7 +182,7 @@ enum enum_tdc_remove_table_type
 extern ulong tdc_size;
 extern ulong tc_size;
 
-extern void tdc_init(void);
+extern bool tdc_init(void);
 extern void tdc_start_shutdown(void);
 extern void tdc_deinit(void);
 extern ulong tdc_records(void);
@@ -23,6 +23,7 @@ extern uint threadpool_max_size;
 extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall checks*/
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
+extern uint threadpool_prio_kickup_timer;  /* Time before low prio item gets prio boost */
 
 
 
@@ -54,6 +55,10 @@ struct TP_STATISTICS
 {
   /* Current number of worker thread. */
   volatile int32 num_worker_threads;
+  /* Connections handled by a thread of another group. */
+  volatile int64 stolen_events;
+  /* Connections moved to another group. */
+  volatile int64 moved_connections;
 };
 
 extern TP_STATISTICS tp_stats;
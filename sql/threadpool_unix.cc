@@ -32,6 +32,10 @@
 #ifdef __linux__
 #include <sys/epoll.h>
 typedef struct epoll_event native_event;
+#if SIZEOF_VOIDP == 8
+/* Sockets stay in the poll set between commands, see start_io() */
+#define IO_POLL_PERSISTENT
+#endif
 #elif defined(HAVE_KQUEUE)
 #include <sys/event.h>
 typedef struct kevent native_event;
@@ -58,10 +62,12 @@ static bool threadpool_started= false;
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_group_mutex;
 static PSI_mutex_key key_timer_mutex;
+static PSI_mutex_key key_connection_slots_mutex;
 static PSI_mutex_info mutex_list[]=
 {
   { &key_group_mutex, "group_mutex", 0},
-  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL}
+  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL},
+  { &key_connection_slots_mutex, "connection_slots_mutex", PSI_FLAG_GLOBAL}
 };
 
 static PSI_cond_key key_worker_cond;
@@ -95,6 +101,8 @@ struct worker_thread_t
 {
   ulonglong  event_count; /* number of request handled by this thread */
   thread_group_t* thread_group;   
+  /* Group of the connection taken by steal_event(), while handling it */
+  thread_group_t* stolen_from;
   worker_thread_t *next_in_list;
   worker_thread_t **prev_in_list;
   
@@ -116,6 +124,11 @@ struct connection_t
   connection_t *next_in_queue;
   connection_t **prev_in_queue;
   ulonglong abs_wait_timeout;
+  ulonglong enqueue_time;
+#ifdef IO_POLL_PERSISTENT
+  uint32 slot;                /* Index in connection_slots */
+  volatile int64 io_state;    /* Generation and state, see start_io() */
+#endif
   bool logged_in;
   bool bound_to_poll_descriptor;
   bool waiting;
@@ -133,6 +146,8 @@ struct thread_group_t
 {
   mysql_mutex_t mutex;
   connection_queue_t queue;
+  /* Connections in the middle of a transaction, see queue_push() */
+  connection_queue_t high_prio_queue;
   worker_list_t waiting_threads; 
   worker_thread_t *listener;
   pthread_attr_t *pthread_attr;
@@ -140,6 +155,11 @@ struct thread_group_t
   int  thread_count;
   int  active_thread_count;
   int  connection_count;
+  /* Connections to move to move_target, set by rebalance_groups() */
+  int  connections_to_move;
+  thread_group_t *move_target;
+  /* Expected connection count, used by rebalance_groups() only */
+  int  planned_connection_count;
   /* Stats for the deadlock detection timer routine.*/
   int io_event_count;
   int queue_event_count;
@@ -180,10 +200,12 @@ static int  wake_or_create_thread(thread_group_t *thread_group);
 static int  create_worker(thread_group_t *thread_group);
 static void *worker_main(void *param);
 static void check_stall(thread_group_t *thread_group);
+static void rebalance_groups();
 static void connection_abort(connection_t *connection);
 static void set_wait_timeout(connection_t *connection);
 static void set_next_timeout_check(ulonglong abstime);
 static void print_pool_blocked_message(bool);
+static bool too_many_threads(thread_group_t *thread_group);
 
 /**
  Asynchronous network IO.
@@ -197,6 +219,9 @@ static void print_pool_blocked_message(bool);
  then socket is removed from the "poll-set" until the  command is finished,
  and we need to re-arm/re-register socket)
  
+ On 64 bit Linux, the socket is not removed from the poll set, see
+ IO_POLL_PERSISTENT.
+
  No implementation for poll/select/AIO is currently provided.
  
  The API closely resembles all of the above mentioned platform APIs 
@@ -248,7 +273,11 @@ int io_poll_associate_fd(int pollfd, int fd, void *data)
   struct epoll_event ev;
   ev.data.u64= 0; /* Keep valgrind happy */
   ev.data.ptr= data;
+#ifdef IO_POLL_PERSISTENT
+  ev.events=  EPOLLIN|EPOLLET|EPOLLERR|EPOLLRDHUP;
+#else
   ev.events=  EPOLLIN|EPOLLET|EPOLLERR|EPOLLRDHUP|EPOLLONESHOT;
+#endif
   return epoll_ctl(pollfd, EPOLL_CTL_ADD,  fd, &ev);
 }
 
@@ -411,17 +440,225 @@ static void* native_event_get_userdata(native_event *event)
 #endif
 
 
-/* Dequeue element from a workqueue */
+#ifdef IO_POLL_PERSISTENT
+/*
+  Sockets are added to the poll set once, edge-triggered without
+  EPOLLONESHOT, and stay there until the connection is closed. This saves
+  the epoll_ctl() to re-arm the socket after every command.
+
+  Events can then come for a connection that is being handled by a
+  worker, and for a connection that was closed after a poller got the
+  event. To recognize the latter, connections are allocated in slots
+  that are only freed when the thread pool ends, and the event data is
+  the slot number and a generation of the slot, that is increased when
+  the connection is closed.
+
+  connection_t::io_state holds the generation and one of
+  CONNECTION_IDLE     - waiting for an event, not queued nor handled
+  CONNECTION_BUSY     - queued or handled by a worker
+  CONNECTION_PENDING  - busy, and an event came meanwhile
+
+  A poller changes the state from IDLE to BUSY to take a connection, or
+  from BUSY to PENDING, see event_connection(). The worker changes BUSY
+  back to IDLE after the command, or handles the event that came, see
+  connection_wait_for_event().
+*/
+
+#define CONNECTION_IDLE    0
+#define CONNECTION_BUSY    1
+#define CONNECTION_PENDING 2
+
+#define CONNECTION_SLOTS_IN_CHUNK 1024
+#define CONNECTION_SLOT_CHUNKS    1024
+
+static connection_t *connection_slots[CONNECTION_SLOT_CHUNKS];
+static uint32 connection_slot_count;
+static connection_t *free_connections;
+static mysql_mutex_t LOCK_connection_slots;
+
+
+static inline int64 connection_io_state(uint32 generation, int state)
+{
+  return (int64) (((ulonglong) generation << 2) | state);
+}
+
+
+static inline uint32 connection_generation(connection_t *connection)
+{
+  return (uint32) ((ulonglong) my_atomic_load64(&connection->io_state) >> 2);
+}
+
+
+/* Event data for the current generation of the connection */
+
+static inline void *connection_event_data(connection_t *connection)
+{
+  return (void *) (size_t) (((ulonglong) connection_generation(connection)
+                             << 32) | connection->slot);
+}
+
+
+/*
+  Ignore the events got for the current generation of the connection,
+  because it is closed or moved to another poll set.
+*/
+
+static void connection_next_generation(connection_t *connection)
+{
+  my_atomic_store64(&connection->io_state,
+                    connection_io_state(connection_generation(connection) + 1,
+                                        CONNECTION_BUSY));
+}
+
+
+static connection_t *connection_slot_alloc()
+{
+  connection_t *connection= NULL;
+
+  mysql_mutex_lock(&LOCK_connection_slots);
+  if ((connection= free_connections))
+    free_connections= connection->next_in_queue;
+  else if (connection_slot_count <
+           CONNECTION_SLOTS_IN_CHUNK * CONNECTION_SLOT_CHUNKS)
+  {
+    uint chunk= connection_slot_count / CONNECTION_SLOTS_IN_CHUNK;
+    if (!connection_slots[chunk])
+      connection_slots[chunk]= (connection_t *)
+        my_malloc(sizeof(connection_t) * CONNECTION_SLOTS_IN_CHUNK,
+                  MYF(MY_ZEROFILL));
+    if (connection_slots[chunk])
+    {
+      connection= connection_slots[chunk] +
+                  connection_slot_count % CONNECTION_SLOTS_IN_CHUNK;
+      connection->slot= connection_slot_count++;
+    }
+  }
+  mysql_mutex_unlock(&LOCK_connection_slots);
+  if (connection)
+    my_atomic_store64(&connection->io_state,
+                      connection_io_state(connection_generation(connection),
+                                          CONNECTION_BUSY));
+  return connection;
+}
+
+
+static void connection_slot_free(connection_t *connection)
+{
+  connection_next_generation(connection);
+  mysql_mutex_lock(&LOCK_connection_slots);
+  connection->next_in_queue= free_connections;
+  free_connections= connection;
+  mysql_mutex_unlock(&LOCK_connection_slots);
+}
+
+
+static void connection_slots_free()
+{
+  for (uint i= 0; i < CONNECTION_SLOT_CHUNKS; i++)
+  {
+    my_free(connection_slots[i]);
+    connection_slots[i]= NULL;
+  }
+  connection_slot_count= 0;
+  free_connections= NULL;
+  mysql_mutex_destroy(&LOCK_connection_slots);
+}
+#endif
+
+
+/**
+  Get the connection of a network event
+
+  @return connection to handle, or NULL if the event is to be ignored
+*/
+
+static connection_t *event_connection(native_event *event)
+{
+#ifdef IO_POLL_PERSISTENT
+  ulonglong data= (ulonglong) (size_t) native_event_get_userdata(event);
+  uint32 slot= (uint32) data;
+  uint32 generation= (uint32) (data >> 32);
+  connection_t *connection= connection_slots[slot / CONNECTION_SLOTS_IN_CHUNK]
+                            + slot % CONNECTION_SLOTS_IN_CHUNK;
+  int64 busy= connection_io_state(generation, CONNECTION_BUSY);
+
+  for (;;)
+  {
+    int64 state= connection_io_state(generation, CONNECTION_IDLE);
+    if (my_atomic_cas64(&connection->io_state, &state, busy))
+      return connection;
+    /* Closed, or there is an event for the worker already */
+    if (state != busy)
+      return NULL;
+    /* Let the worker that handles the connection know of the event */
+    if (my_atomic_cas64(&connection->io_state, &state,
+                        connection_io_state(generation, CONNECTION_PENDING)))
+      return NULL;
+  }
+#else
+  return (connection_t *) native_event_get_userdata(event);
+#endif
+}
+
+
+/* Check if both workqueues of the group are empty */
+
+static inline bool queue_is_empty(thread_group_t *thread_group)
+{
+  return thread_group->queue.is_empty() &&
+         thread_group->high_prio_queue.is_empty();
+}
+
+
+/*
+  Add element to a workqueue.
+
+  Connections in the middle of a transaction, or holding table locks, go
+  to the high priority queue, so that they can finish and release their
+  locks instead of waiting behind new queries. Caller must hold the
+  group mutex.
+*/
+
+static void queue_push(thread_group_t *thread_group, connection_t *connection)
+{
+  THD *thd= connection->thd;
+
+  connection->enqueue_time= pool_timer.current_microtime;
+  if (connection->logged_in &&
+      (thd->transaction.is_active() || thd->locked_tables_mode))
+    thread_group->high_prio_queue.push_back(connection);
+  else
+    thread_group->queue.push_back(connection);
+}
+
+
+/*
+  Dequeue element from a workqueue.
+
+  The high priority queue is served first. Connections that have waited
+  in the low priority queue for longer than thread_pool_prio_kickup_timer
+  are moved to the end of the high priority queue, so that they are not
+  starved by the transactions.
+*/
 
 static connection_t *queue_get(thread_group_t *thread_group)
 {
   DBUG_ENTER("queue_get");
   thread_group->queue_event_count++;
-  connection_t *c= thread_group->queue.front();
-  if (c)
+  connection_t *c;
+  ulonglong now= pool_timer.current_microtime;
+
+  while ((c= thread_group->queue.front()) &&
+         c->enqueue_time + 1000ULL * threadpool_prio_kickup_timer <= now)
   {
     thread_group->queue.remove(c);
+    thread_group->high_prio_queue.push_back(c);
   }
+
+  if ((c= thread_group->high_prio_queue.front()))
+    thread_group->high_prio_queue.remove(c);
+  else if ((c= thread_group->queue.front()))
+    thread_group->queue.remove(c);
   DBUG_RETURN(c);  
 }
 
@@ -436,8 +673,7 @@ static void timeout_check(pool_timer_t *timer)
 {
   DBUG_ENTER("timeout_check");
   
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
 
   /* Reset next timeout check, it will be recalculated in the loop below */
   my_atomic_fas64((volatile int64*)&timer->next_timeout_check, ULONGLONG_MAX);
@@ -471,7 +707,6 @@ static void timeout_check(pool_timer_t *timer)
       set_next_timeout_check(connection->abs_wait_timeout);
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_VOID_RETURN;
 }
 
@@ -508,7 +743,7 @@ static void* timer_thread(void *param)
     struct timespec ts;
     int err;
 
-    set_timespec_nsec(ts,timer->tick_interval*1000000);
+    set_timespec_nsec(ts, 1000000ULL * timer->tick_interval);
     mysql_mutex_lock(&timer->mutex);
     err= mysql_cond_timedwait(&timer->cond, &timer->mutex, &ts);
     if (timer->shutdown)
@@ -526,6 +761,9 @@ static void* timer_thread(void *param)
         if(all_groups[i].connection_count)
            check_stall(&all_groups[i]);
       }
+
+      /* Spread long living connections evenly over the groups */
+      rebalance_groups();
       
       /* Check if any client exceeded wait_timeout */
       if (timer->next_timeout_check <= timer->current_microtime)
@@ -591,7 +829,7 @@ void check_stall(thread_group_t *thread_group)
     do wait and indicate that via thd_wait_begin/end callbacks, thread creation
     will be faster.
   */
-  if (!thread_group->queue.is_empty() && !thread_group->queue_event_count)
+  if (!queue_is_empty(thread_group) && !thread_group->queue_event_count)
   {
     thread_group->stalled= true;
     wake_or_create_thread(thread_group);
@@ -604,6 +842,73 @@ void check_stall(thread_group_t *thread_group)
 }
 
 
+/*
+  Spread the connections evenly over the groups.
+
+  Connections are assigned to a group by their thread id when they are
+  created, so with long living connections (e.g. from a connection pool)
+  some groups can end up with many more connections than the others.
+
+  For every group with more connections than the average, the timer
+  picks the group with the fewest connections and the number of
+  connections to move there. The connections are moved by start_io(),
+  when they have finished a request and wait for the next one.
+*/
+
+static void rebalance_groups()
+{
+  uint count= group_count;
+  int total= 0;
+  int average;
+  uint i;
+
+  if (!count)
+    return;
+
+  for (i= 0; i < count; i++)
+  {
+    all_groups[i].planned_connection_count= all_groups[i].connection_count;
+    total+= all_groups[i].connection_count;
+  }
+  /* Rounded up, groups with up to the average are not touched */
+  average= (total + count - 1) / count;
+
+  for (i= 0; i < count; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    thread_group_t *target= NULL;
+    int to_move= 0;
+    int excess= group->planned_connection_count - average;
+
+    if (excess > 0)
+    {
+      for (uint j= 0; j < count; j++)
+      {
+        if (!target || all_groups[j].planned_connection_count <
+                       target->planned_connection_count)
+          target= &all_groups[j];
+      }
+      to_move= MY_MIN(excess, average - target->planned_connection_count);
+      if (to_move > 0)
+      {
+        group->planned_connection_count-= to_move;
+        target->planned_connection_count+= to_move;
+      }
+      else
+        to_move= 0;
+    }
+
+    if (to_move != group->connections_to_move)
+    {
+      mysql_mutex_lock(&group->mutex);
+      group->connections_to_move= to_move;
+      group->move_target= target;
+      mysql_mutex_unlock(&group->mutex);
+    }
+  }
+}
+
+
 static void start_timer(pool_timer_t* timer)
 {
   pthread_t thread_id;
@@ -627,6 +932,45 @@ static void stop_timer(pool_timer_t *timer)
 }
 
 
+/**
+  Wake an idle thread of a neighbouring group, to take work from the
+  queue of this group with steal_event().
+
+  @param thread_group - current thread group, locked by the caller
+*/
+
+static void wake_idle_neighbour(thread_group_t *thread_group)
+{
+  DBUG_ENTER("wake_idle_neighbour");
+  uint count= group_count;
+  uint idx= (uint) (thread_group - all_groups);
+
+  if (idx >= count)
+    DBUG_VOID_RETURN;
+
+  for (uint i= 1; i < count; i++)
+  {
+    uint distance= (i + 1) / 2;
+    thread_group_t *group= &all_groups[(i & 1) ? (idx + distance) % count :
+                                       (idx + count - distance) % count];
+    bool woken= false;
+
+    /* Unlocked check to skip the groups without idle threads */
+    if (group->waiting_threads.is_empty() || !queue_is_empty(group))
+      continue;
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+    if (!group->shutdown && queue_is_empty(group) &&
+        !too_many_threads(group))
+      woken= !wake_thread(group);
+    mysql_mutex_unlock(&group->mutex);
+    if (woken)
+      break;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
 /**
   Poll for socket events and distribute them to worker threads
   In many case current thread will handle single event itself.
@@ -709,28 +1053,36 @@ static connection_t * listener(worker_thread_t *current_thread,
      more workers.
     */
     
-    bool listener_picks_event= thread_group->queue.is_empty();
+    bool listener_picks_event= queue_is_empty(thread_group);
     
     /* 
       If listener_picks_event is set, listener thread will handle first event, 
       and put the rest into the queue. If listener_pick_event is not set, all 
       events go to the queue.
     */
-    for(int i=(listener_picks_event)?1:0; i < cnt ; i++)
+    for(int i=0; i < cnt ; i++)
     {
-      connection_t *c= (connection_t *)native_event_get_userdata(&ev[i]);
-      thread_group->queue.push_back(c);
+      connection_t *c= event_connection(&ev[i]);
+      if (!c)
+        continue;
+      if (listener_picks_event && !retval)
+        retval= c;
+      else
+        queue_push(thread_group, c);
     }
     
-    if (listener_picks_event)
+    if (retval)
     {
       /* Handle the first event. */
-      retval= (connection_t *)native_event_get_userdata(&ev[0]);
       mysql_mutex_unlock(&thread_group->mutex);
       break;
     }
 
-    if(thread_group->active_thread_count==0)
+    if (queue_is_empty(thread_group))
+    {
+      /* All events were ignored, see event_connection() */
+    }
+    else if(thread_group->active_thread_count==0)
     {
       /* We added some work items to queue, now wake a worker. */
       if(wake_thread(thread_group))
@@ -755,6 +1107,14 @@ static connection_t * listener(worker_thread_t *current_thread,
         }
       }
     }
+    else
+    {
+      /*
+        The workers of the group are busy, let an idle group help
+        with the queue.
+      */
+      wake_idle_neighbour(thread_group);
+    }
     mysql_mutex_unlock(&thread_group->mutex);
   }
 
@@ -912,6 +1272,7 @@ int thread_group_init(thread_group_t *thread_group, pthread_attr_t* thread_attr)
   thread_group->shutdown_pipe[0]= -1;
   thread_group->shutdown_pipe[1]= -1;
   thread_group->queue.empty();
+  thread_group->high_prio_queue.empty();
   DBUG_RETURN(0);
 }
 
@@ -933,7 +1294,12 @@ void thread_group_destroy(thread_group_t *thread_group)
     }
   }
   if (my_atomic_add32(&shutdown_group_count, -1) == 1)
+  {
     my_free(all_groups);
+#ifdef IO_POLL_PERSISTENT
+    connection_slots_free();
+#endif
+  }
 }
 
 /**
@@ -1017,7 +1383,7 @@ static void queue_put(thread_group_t *thread_group, connection_t *connection)
   DBUG_ENTER("queue_put");
 
   mysql_mutex_lock(&thread_group->mutex);
-  thread_group->queue.push_back(connection);
+  queue_push(thread_group, connection);
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
@@ -1040,6 +1406,101 @@ static bool too_many_threads(thread_group_t *thread_group)
 }
 
 
+/**
+  Take a queued connection from another group.
+
+  Used by a thread that has nothing to do in its own group, so that
+  connections do not wait in the queue of an overloaded group while
+  other groups are idle. Neighbouring groups are tried first, so that
+  the idle groups help different groups rather than all contending for
+  the mutex of the same one.
+
+  Until finish_stolen_event() is called, the thread counts as an active
+  thread of the other group instead of its own, so that wait_begin() and
+  wait_end() of the connection keep the counts of the groups right.
+
+  @param current_thread - current worker thread
+  @param thread_group - current thread group, locked by the caller
+
+  @return
+  connection taken from another group, or NULL
+*/
+
+static connection_t *steal_event(worker_thread_t *current_thread,
+                                 thread_group_t *thread_group)
+{
+  DBUG_ENTER("steal_event");
+  uint count= group_count;
+  uint idx= (uint) (thread_group - all_groups);
+
+  if (idx >= count)
+    DBUG_RETURN(NULL);
+
+  /* Distance +1, -1, +2, -2, ... from the current group */
+  for (uint i= 1; i < count; i++)
+  {
+    uint distance= (i + 1) / 2;
+    thread_group_t *group= &all_groups[(i & 1) ? (idx + distance) % count :
+                                       (idx + count - distance) % count];
+    connection_t *connection= NULL;
+
+    /* Unlocked check to skip the groups that have nothing to take */
+    if (queue_is_empty(group))
+      continue;
+    /* The current group is locked, don't wait for another one */
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+    if (!group->shutdown)
+      connection= queue_get(group);
+    if (connection)
+    {
+      DBUG_ASSERT(connection->thread_group == group);
+      group->thread_count++;
+      group->active_thread_count++;
+      thread_group->active_thread_count--;
+      current_thread->stolen_from= group;
+    }
+    mysql_mutex_unlock(&group->mutex);
+    if (connection)
+    {
+      my_atomic_add64(&tp_stats.stolen_events, 1);
+      DBUG_RETURN(connection);
+    }
+  }
+  DBUG_RETURN(NULL);
+}
+
+
+/**
+  Return to the own group after handling a connection from steal_event()
+*/
+
+static void finish_stolen_event(worker_thread_t *current_thread)
+{
+  DBUG_ENTER("finish_stolen_event");
+  thread_group_t *group= current_thread->stolen_from;
+  bool last_thread;
+
+  current_thread->stolen_from= NULL;
+  mysql_mutex_lock(&group->mutex);
+  group->thread_count--;
+  group->active_thread_count--;
+  /* Let a thread of the group continue, if this one was in its way */
+  if (!queue_is_empty(group) && !too_many_threads(group))
+    wake_thread(group);
+  last_thread= (group->thread_count == 0 && group->shutdown);
+  mysql_mutex_unlock(&group->mutex);
+  if (last_thread)
+    thread_group_destroy(group);
+
+  group= current_thread->thread_group;
+  mysql_mutex_lock(&group->mutex);
+  group->active_thread_count++;
+  mysql_mutex_unlock(&group->mutex);
+  DBUG_VOID_RETURN;
+}
+
+
 /**
   Retrieve a connection with pending event.
   
@@ -1108,9 +1569,13 @@ connection_t *get_event(worker_thread_t *current_thread,
       if (io_poll_wait(thread_group->pollfd,&nev,1, 0) == 1)
       {
         thread_group->io_event_count++;
-        connection = (connection_t *)native_event_get_userdata(&nev);
-        break;
+        if ((connection= event_connection(&nev)))
+          break;
       }
+
+      /* Help another group, if it has queued work */
+      if ((connection= steal_event(current_thread, thread_group)))
+        break;
     }
 
     /* And now, finally sleep */ 
@@ -1172,7 +1637,7 @@ void wait_begin(thread_group_t *thread_group)
   DBUG_ASSERT(thread_group->connection_count > 0);
  
   if ((thread_group->active_thread_count == 0) && 
-     (thread_group->queue.is_empty() || !thread_group->listener))
+     (queue_is_empty(thread_group) || !thread_group->listener))
   {
     /* 
       Group might stall while this thread waits, thus wake 
@@ -1207,7 +1672,11 @@ connection_t *alloc_connection(THD *thd)
 {
   DBUG_ENTER("alloc_connection");
   
+#ifdef IO_POLL_PERSISTENT
+  connection_t* connection = connection_slot_alloc();
+#else
   connection_t* connection = (connection_t *)my_malloc(sizeof(connection_t),0);
+#endif
   if (connection)
   {
     connection->thd = thd;
@@ -1229,7 +1698,7 @@ void tp_add_connection(THD *thd)
 {
   DBUG_ENTER("tp_add_connection");
   
-  threads.append(thd);
+  server_threads.insert(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
   connection_t *connection= alloc_connection(thd);
   if (connection)
@@ -1276,7 +1745,11 @@ static void connection_abort(connection_t *connection)
   group->connection_count--;
   mysql_mutex_unlock(&group->mutex);
   
+#ifdef IO_POLL_PERSISTENT
+  connection_slot_free(connection);
+#else
   my_free(connection);
+#endif
   DBUG_VOID_RETURN;
 }
 
@@ -1359,9 +1832,9 @@ static void set_wait_timeout(connection_t *c)
 
 
 /**
-  Handle a (rare) special case,where connection needs to 
-  migrate to a different group because group_count has changed
-  after thread_pool_size setting. 
+  Move a connection to a different group, because group_count has
+  changed after thread_pool_size setting, or to even out the number of
+  connections in the groups.
 */
 
 static int change_group(connection_t *c, 
@@ -1379,6 +1852,10 @@ static int change_group(connection_t *c,
   {
     io_poll_disassociate_fd(old_group->pollfd,fd);
     c->bound_to_poll_descriptor= false;
+#ifdef IO_POLL_PERSISTENT
+    /* Events already read from the old poll set are stale now */
+    connection_next_generation(c);
+#endif
   }
   c->thread_group->connection_count--;
   mysql_mutex_unlock(&old_group->mutex);
@@ -1395,32 +1872,102 @@ static int change_group(connection_t *c,
 }
 
 
+#ifdef IO_POLL_PERSISTENT
+/*
+  Let the pollers hand the connection to a worker on the next event,
+  after a command was handled.
+
+  The socket is checked first. The data of the next command may have
+  come in the same read as the command just handled, and then there is
+  no new edge to report it. If there is data, the connection is queued
+  again here.
+
+  If an event came after the check, the state is CONNECTION_PENDING,
+  and the socket is checked again.
+
+  The connection must not be used after this, if the state was changed
+  to CONNECTION_IDLE.
+*/
+
+static int connection_wait_for_event(connection_t *connection)
+{
+  uint32 generation= connection_generation(connection);
+  int64 busy= connection_io_state(generation, CONNECTION_BUSY);
+
+  for (;;)
+  {
+    int64 state= busy;
+    if (vio_io_wait(connection->thd->net.vio, VIO_IO_EVENT_READ, 0))
+    {
+      /* There is data or an error to handle */
+      queue_put(connection->thread_group, connection);
+      return 0;
+    }
+
+    if (my_atomic_cas64(&connection->io_state, &state,
+                        connection_io_state(generation, CONNECTION_IDLE)))
+      return 0;
+
+    DBUG_ASSERT(state == connection_io_state(generation, CONNECTION_PENDING));
+    my_atomic_store64(&connection->io_state, busy);
+  }
+}
+#endif
+
+
 static int start_io(connection_t *connection)
 { 
   int fd = mysql_socket_getfd(connection->thd->net.vio->mysql_socket);
+  thread_group_t *group= connection->thread_group;
+  thread_group_t *new_group= NULL;
 
   /*
     Usually, connection will stay in the same group for the entire
     connection's life. However, we do allow group_count to
     change at runtime, which means in rare cases when it changes is 
-    connection should need to migrate  to another group, this ensures
-    to ensure equal load between groups.
+    connection should need to migrate to another group, if its group
+    is no longer in use.
 
-    So we recalculate in which group the connection should be, based
-    on thread_id and current group count, and migrate if necessary.
+    The connection is also moved, if rebalance_groups() found that its
+    group has more connections than the others. It is done here, as
+    the connection is idle now.
   */ 
-  thread_group_t *group = 
-    &all_groups[connection->thd->thread_id%group_count];
+  if ((uint) (group - all_groups) >= group_count)
+    new_group= &all_groups[connection->thd->thread_id%group_count];
+  else if (group->connections_to_move > 0)
+  {
+    mysql_mutex_lock(&group->mutex);
+    if (group->connections_to_move > 0 &&
+        (uint) (group->move_target - all_groups) < group_count)
+    {
+      group->connections_to_move--;
+      new_group= group->move_target;
+    }
+    mysql_mutex_unlock(&group->mutex);
+  }
 
-  if (group != connection->thread_group)
+  if (new_group && new_group != group)
   {
-    if (change_group(connection, connection->thread_group, group))
+    if (change_group(connection, group, new_group))
       return -1;
+    my_atomic_add64(&tp_stats.moved_connections, 1);
+    group= new_group;
   }
     
   /* 
     Bind to poll descriptor if not yet done. 
   */ 
+#ifdef IO_POLL_PERSISTENT
+  if (!connection->bound_to_poll_descriptor)
+  {
+    connection->bound_to_poll_descriptor= true;
+    if (io_poll_associate_fd(group->pollfd, fd,
+                             connection_event_data(connection)))
+      return -1;
+  }
+
+  return connection_wait_for_event(connection);
+#else
   if (!connection->bound_to_poll_descriptor)
   {
     connection->bound_to_poll_descriptor= true;
@@ -1428,6 +1975,7 @@ static int start_io(connection_t *connection)
   }
   
   return io_poll_start_read(group->pollfd, fd, connection);
+#endif
 }
 
 
@@ -1481,6 +2029,7 @@ static void *worker_main(void *param)
   /* Init per-thread structure */
   mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
   this_thread.thread_group= thread_group;
+  this_thread.stolen_from= NULL;
   this_thread.event_count=0;
 
   /* Run event loop */
@@ -1494,6 +2043,8 @@ static void *worker_main(void *param)
       break;
     this_thread.event_count++;
     handle_event(connection);
+    if (this_thread.stolen_from)
+      finish_stolen_event(&this_thread);
   }
 
   /* Thread shutdown: cleanup per-worker-thread structure. */
@@ -1532,6 +2083,9 @@ bool tp_init()
   {
     thread_group_init(&all_groups[i], get_connection_attrib());  
   }
+#ifdef IO_POLL_PERSISTENT
+  mysql_mutex_init(key_connection_slots_mutex, &LOCK_connection_slots, NULL);
+#endif
   tp_set_threadpool_size(threadpool_size);
   if(group_count == 0)
   {
@@ -660,7 +660,7 @@ static void CALLBACK shm_read_callback(PTP_CALLBACK_INSTANCE instance,
 */
 void tp_add_connection(THD *thd)
 {
-  threads.append(thd);
+  server_threads.insert(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
 
   connection_t *con = (connection_t *)malloc(sizeof(connection_t));
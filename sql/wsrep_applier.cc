@@ -367,6 +367,7 @@ wsrep_cb_status_t wsrep_commit_cb(void*         const     ctx,
     rcode = wsrep_commit(thd);
   else
     rcode = wsrep_rollback(thd);
+  thd->publish_status();
 
   wsrep_set_apply_format(thd, NULL);
   thd->mdl_context.release_transactional_locks();
@@ -1769,7 +1769,7 @@ pthread_handler_t start_wsrep_THD(void *arg)
   thd->real_id=pthread_self(); // Keep purify happy
   thread_count++;
   thread_created++;
-  threads.append(thd);
+  server_threads.insert(thd);
 
   my_net_init(&thd->net,(st_vio*) 0, thd, MYF(0));
 
@@ -1815,6 +1815,7 @@ pthread_handler_t start_wsrep_THD(void *arg)
     close_connection(thd, ER_OUT_OF_RESOURCES);
     statistic_increment(aborted_connects,&LOCK_status);
     MYSQL_CALLBACK(thread_scheduler, end_thread, (thd, 0));
+    server_threads.erase(thd);
     delete thd;
     goto error;
   }
@@ -1862,6 +1863,7 @@ pthread_handler_t start_wsrep_THD(void *arg)
   my_thread_end();
   if (thread_handling > SCHEDULER_ONE_THREAD_PER_CONNECTION)
   {
+    server_threads.erase(thd);
     mysql_mutex_lock(&LOCK_thread_count);
     delete thd;
     thread_count--;
@@ -1930,7 +1932,7 @@ static bool have_client_connections()
 {
   THD *tmp;
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -1966,9 +1968,8 @@ static void wsrep_close_thread(THD *thd)
 static my_bool have_committing_connections()
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     if (!is_client_connection(tmp))
@@ -1979,7 +1980,6 @@ static my_bool have_committing_connections()
       return TRUE;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   return FALSE;
 }
 
@@ -2015,7 +2015,7 @@ void wsrep_close_client_connections(my_bool wait_to_end)
   kill_cached_threads= true; // prevent future threads caching
   mysql_cond_broadcast(&COND_thread_cache); // tell cached threads to die
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -2047,7 +2047,7 @@ void wsrep_close_client_connections(my_bool wait_to_end)
     Force remaining threads to die by closing the connection to the client
   */
 
-  I_List_iterator<THD> it2(threads);
+  THD_list_iterator it2(server_threads);
   while ((tmp=it2++))
   {
 #ifndef __bsdi__				// Bug in BSDI kernel
@@ -2088,9 +2088,8 @@ void wsrep_close_applier(THD *thd)
 void wsrep_close_threads(THD *thd)
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -2102,8 +2101,6 @@ void wsrep_close_threads(THD *thd)
       wsrep_close_thread (tmp);
     }
   }
-
-  mysql_mutex_unlock(&LOCK_thread_count);
 }
 
 void wsrep_wait_appliers_close(THD *thd)
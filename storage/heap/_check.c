@@ -18,8 +18,8 @@
 
 #include "heapdef.h"
 
-static int check_one_key(HP_KEYDEF *keydef, uint keynr, ulong records,
-			 ulong blength, my_bool print_status);
+static int check_one_key(HP_INFO *info, HP_KEYDEF *keydef, uint keynr,
+			 ulong records, ulong blength, my_bool print_status);
 static int check_one_rb_key(HP_INFO *info, uint keynr, ulong records,
 			    my_bool print_status);
 
@@ -54,7 +54,7 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
     if (share->keydef[key].algorithm == HA_KEY_ALG_BTREE)
       error|= check_one_rb_key(info, key, share->records, print_status);
     else
-      error|= check_one_key(share->keydef + key, key, share->records,
+      error|= check_one_key(info, share->keydef + key, key, share->records,
 			    share->blength, print_status);
   }
   /*
@@ -79,7 +79,7 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
     }
     hp_find_record(info,pos);
 
-    if (!info->current_ptr[share->reclength])
+    if (!info->current_ptr[share->visible])
       deleted++;
     else
       records++;
@@ -97,8 +97,8 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
 }
 
 
-static int check_one_key(HP_KEYDEF *keydef, uint keynr, ulong records,
-			 ulong blength, my_bool print_status)
+static int check_one_key(HP_INFO *info, HP_KEYDEF *keydef, uint keynr,
+			 ulong records, ulong blength, my_bool print_status)
 {
   int error;
   ulong i,found,max_links,seek,links;
@@ -111,7 +111,8 @@ static int check_one_key(HP_KEYDEF *keydef, uint keynr, ulong records,
   for (i=found=max_links=seek=0 ; i < records ; i++)
   {
     hash_info=hp_find_hash(&keydef->block,i);
-    if (hash_info->hash_of_key != hp_rec_hashnr(keydef, hash_info->ptr_to_rec))
+    if (hash_info->hash_of_key !=
+        hp_rec_hashnr(keydef, hp_stored_record(info, hash_info->ptr_to_rec)))
     {
       DBUG_PRINT("error",
                  ("Found row with wrong hash_of_key at position %lu", i));
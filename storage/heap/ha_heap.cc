@@ -606,22 +606,63 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
   uint auto_key= 0, auto_key_type= 0;
+  uint columns= 0, var_length= 0;
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
+  HP_COLUMNDEF *columndef;
   TABLE_SHARE *share= table_arg->s;
+  THD *thd= current_thd;
   bool found_real_auto_increment= 0;
+  Field **field;
 
   bzero(hp_create_info, sizeof(*hp_create_info));
 
   for (key= parts= 0; key < keys; key++)
     parts+= table_arg->key_info[key].user_defined_key_parts;
 
+  /*
+    Store the VARCHARs of internal temporary tables by their actual length,
+    if there is enough to gain (see create_tmp_table())
+  */
+  if (internal_table && (share->db_create_options & HA_OPTION_PACK_RECORD))
+  {
+    for (field= table_arg->field; *field; field++)
+    {
+      if ((*field)->real_type() == MYSQL_TYPE_VARCHAR)
+      {
+        columns++;
+        var_length+= (*field)->field_length;
+      }
+    }
+    if (var_length < HP_CHUNK_LENGTH)
+      columns= 0;
+  }
+
   if (!(keydef= (HP_KEYDEF*) my_malloc(keys * sizeof(HP_KEYDEF) +
-				       parts * sizeof(HA_KEYSEG),
+				       parts * sizeof(HA_KEYSEG) +
+                                       columns * sizeof(HP_COLUMNDEF),
 				       MYF(MY_WME | MY_THREAD_SPECIFIC))))
     return my_errno;
   seg= reinterpret_cast<HA_KEYSEG*>(keydef + keys);
+  columndef= reinterpret_cast<HP_COLUMNDEF*>(seg + parts);
+  if (columns)
+  {
+    HP_COLUMNDEF *column= columndef, *pos;
+    for (field= table_arg->field; *field; field++)
+    {
+      if ((*field)->real_type() != MYSQL_TYPE_VARCHAR)
+        continue;
+      /* Keep the columns sorted by offset */
+      uint offset= (uint) ((*field)->ptr - table_arg->record[0]);
+      for (pos= column; pos > columndef && pos[-1].offset > offset; pos--)
+        pos[0]= pos[-1];
+      pos->offset= offset;
+      pos->length= (*field)->field_length;
+      pos->length_bytes= ((Field_varstring*) *field)->length_bytes;
+      column++;
+    }
+  }
   for (key= 0; key < keys; key++)
   {
     KEY *pos= table_arg->key_info+key;
@@ -705,7 +746,11 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
+  if (columns)
+    mem_per_row+= MY_ALIGN(columndef[0].offset + sizeof(char*) + 1,
+                           sizeof(char*)) + HP_CHUNK_LENGTH;
+  else
+    mem_per_row+= MY_ALIGN(share->reclength + 1, sizeof(char*));
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
@@ -713,7 +758,11 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   }
   hp_create_info->auto_key= auto_key;
   hp_create_info->auto_key_type= auto_key_type;
-  hp_create_info->max_table_size=current_thd->variables.max_heap_table_size;
+  hp_create_info->max_table_size= thd->variables.max_heap_table_size;
+  /* The row count from create_tmp_table() doesn't limit packed tables */
+  if (internal_table && (share->db_create_options & HA_OPTION_PACK_RECORD))
+    set_if_smaller(hp_create_info->max_table_size,
+                   thd->variables.tmp_table_size);
   hp_create_info->with_auto_increment= found_real_auto_increment;
   hp_create_info->internal_table= internal_table;
 
@@ -726,6 +775,8 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->keys= share->keys;
   hp_create_info->reclength= share->reclength;
   hp_create_info->keydef= keydef;
+  hp_create_info->columndef= columndef;
+  hp_create_info->columns= columns;
   return 0;
 }
 
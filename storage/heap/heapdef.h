@@ -32,6 +32,14 @@ C_MODE_START
 #define HP_MIN_RECORDS_IN_BLOCK 16
 #define HP_MAX_RECORDS_IN_BLOCK 8192
 
+/*
+  The part of a packed record after fixed_length is stored in a chain of
+  chunks of this size. Every chunk starts with the link to the next one.
+*/
+
+#define HP_CHUNK_LENGTH 64
+#define HP_CHUNK_DATA_LENGTH (HP_CHUNK_LENGTH - sizeof(uchar*))
+
 	/* Some extern variables */
 
 extern LIST *heap_open_list,*heap_share_list;
@@ -44,6 +52,11 @@ if (!(info->update & HA_STATE_AKTIV))\
 	/* Find pos for record and update it in info->current_ptr */
 #define hp_find_record(info,pos) (info)->current_ptr= hp_find_block(&(info)->s->block,pos)
 
+	/* Copy a stored record to the record buffer */
+#define hp_extract_record(share,record,pos) \
+  ((share)->columns ? hp_unpack_record((share),(record),(pos)) : \
+   (void) memcpy((record),(pos),(size_t) (share)->reclength))
+
 typedef struct st_hp_hash_info
 {
   struct st_hp_hash_info *next_key;
@@ -102,6 +115,12 @@ extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
 extern uint hp_rb_pack_key(HP_KEYDEF *keydef, uchar *key, const uchar *old,
                            key_part_map keypart_map);
+extern int hp_pack_record(HP_SHARE *share, const uchar *record, uchar **chunk,
+                          my_bool check_limit);
+extern void hp_unpack_record(HP_SHARE *share, uchar *record,
+                             const uchar *pos);
+extern void hp_free_chunks(HP_SHARE *share, uchar *chunk);
+extern const uchar *hp_stored_record(HP_INFO *info, const uchar *pos);
 
 extern mysql_mutex_t THR_LOCK_heap;
 
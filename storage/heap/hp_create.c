@@ -33,6 +33,7 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
   uint keys= create_info->keys;
   ulong min_records= create_info->min_records;
   ulong max_records= create_info->max_records;
+  uint columns= create_info->columns;
   DBUG_ENTER("heap_create");
 
   if (!create_info->internal_table)
@@ -146,7 +147,8 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+				       columns*sizeof(HP_COLUMNDEF),
 				       MYF(MY_ZEROFILL |
                                            (create_info->internal_table ?
                                             MY_THREAD_SPECIFIC : 0)))))
@@ -154,7 +156,20 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->keydef= (HP_KEYDEF*) (share + 1);
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
-    init_block(&share->block, reclength + 1, min_records, max_records);
+    share->columndef= (HP_COLUMNDEF*) (keyseg + key_segs);
+    if (columns)
+    {
+      /* The record is stored up to the first VARCHAR, then a chunk link */
+      memcpy(share->columndef, create_info->columndef,
+             (size_t) (sizeof(HP_COLUMNDEF) * columns));
+      share->fixed_length= share->columndef[0].offset;
+      share->visible= share->fixed_length + sizeof(uchar*);
+      init_block(&share->chunk_block, HP_CHUNK_LENGTH, min_records,
+                 max_records);
+    }
+    else
+      share->fixed_length= share->visible= reclength;
+    init_block(&share->block, share->visible + 1, min_records, max_records);
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
@@ -198,6 +213,7 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->reclength= reclength;
     share->blength= 1;
     share->keys= keys;
+    share->columns= columns;
     share->max_key_length= max_length;
     share->changed= 0;
     share->auto_key= create_info->auto_key;
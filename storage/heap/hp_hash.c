@@ -102,6 +102,7 @@ uchar *hp_search(HP_INFO *info, HP_KEYDEF *keyinfo, const uchar *key,
   reg1 HASH_INFO *pos,*prev_ptr;
   int flag;
   uint old_nextflag;
+  ulong hashnr;
   HP_SHARE *share=info->s;
   DBUG_ENTER("hp_search");
   old_nextflag=nextflag;
@@ -110,11 +111,13 @@ uchar *hp_search(HP_INFO *info, HP_KEYDEF *keyinfo, const uchar *key,
 
   if (share->records)
   {
-    pos=hp_find_hash(&keyinfo->block, hp_mask(hp_hashnr(keyinfo, key),
-					      share->blength, share->records));
+    hashnr= hp_hashnr(keyinfo, key);
+    pos=hp_find_hash(&keyinfo->block, hp_mask(hashnr, share->blength,
+                                              share->records));
     do
     {
-      if (!hp_key_cmp(keyinfo, pos->ptr_to_rec, key))
+      if ((!share->columns || pos->hash_of_key == hashnr) &&
+          !hp_key_cmp(keyinfo, hp_stored_record(info, pos->ptr_to_rec), key))
       {
 	switch (nextflag) {
 	case 0:					/* Search after key */
@@ -181,7 +184,7 @@ uchar *hp_search_next(HP_INFO *info, HP_KEYDEF *keyinfo, const uchar *key,
 
   while ((pos= pos->next_key))
   {
-    if (! hp_key_cmp(keyinfo, pos->ptr_to_rec, key))
+    if (! hp_key_cmp(keyinfo, hp_stored_record(info, pos->ptr_to_rec), key))
     {
       info->current_hash_ptr=pos;
       DBUG_RETURN (info->current_ptr= pos->ptr_to_rec);
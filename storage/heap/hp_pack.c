@@ -0,0 +1,232 @@
+/* Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Packed records
+
+  The VARCHARs of a packed table are stored by their actual length
+  instead of their max length. The record is stored as:
+
+  - The first fixed_length bytes of the record, as is
+  - A pointer to the first chunk of the rest of the record
+  - The not deleted flag
+
+  The rest of the record is stored in a chain of chunks of
+  HP_CHUNK_LENGTH bytes, without the unused part of the VARCHARs.
+  The chunks are allocated in share->chunk_block and the free ones are
+  linked from share->chunk_del_link.
+*/
+
+#include "heapdef.h"
+
+typedef struct st_hp_chunk_pos
+{
+  uchar *chunk;
+  uint used;
+} HP_CHUNK_POS;
+
+
+static inline uint var_length(HP_COLUMNDEF *column, const uchar *record)
+{
+  const uchar *pos= record + column->offset;
+  return column->length_bytes == 1 ? (uint) *pos : uint2korr(pos);
+}
+
+
+static void copy_to_chunks(HP_CHUNK_POS *pos, const uchar *from, uint length)
+{
+  while (length)
+  {
+    uint part;
+    if (pos->used == HP_CHUNK_DATA_LENGTH)
+    {
+      pos->chunk= *((uchar**) pos->chunk);
+      pos->used= 0;
+    }
+    part= MY_MIN(length, (uint) HP_CHUNK_DATA_LENGTH - pos->used);
+    memcpy(pos->chunk + sizeof(uchar*) + pos->used, from, part);
+    pos->used+= part;
+    from+= part;
+    length-= part;
+  }
+}
+
+
+static void copy_from_chunks(HP_CHUNK_POS *pos, uchar *to, uint length)
+{
+  while (length)
+  {
+    uint part;
+    if (pos->used == HP_CHUNK_DATA_LENGTH)
+    {
+      pos->chunk= *((uchar**) pos->chunk);
+      pos->used= 0;
+    }
+    part= MY_MIN(length, (uint) HP_CHUNK_DATA_LENGTH - pos->used);
+    memcpy(to, pos->chunk + sizeof(uchar*) + pos->used, part);
+    pos->used+= part;
+    to+= part;
+    length-= part;
+  }
+}
+
+
+	/* Find a free chunk */
+
+static uchar *next_free_chunk(HP_SHARE *share, my_bool check_limit)
+{
+  uchar *pos;
+  ulong block_pos;
+  size_t length;
+
+  if ((pos= share->chunk_del_link))
+  {
+    share->chunk_del_link= *((uchar**) pos);
+    return pos;
+  }
+  if (!(block_pos= share->chunks % share->chunk_block.records_in_block))
+  {
+    if (check_limit &&
+        share->data_length + share->index_length >= share->max_table_size)
+    {
+      my_errno= HA_ERR_RECORD_FILE_FULL;
+      return NULL;
+    }
+    if (hp_get_new_block(share, &share->chunk_block, &length))
+      return NULL;
+    share->data_length+= length;
+  }
+  share->chunks++;
+  return ((uchar*) share->chunk_block.level_info[0].last_blocks +
+          block_pos * share->chunk_block.recbuffer);
+}
+
+
+/*
+  Store the packed part of a record in new chunks
+
+  SYNOPSIS
+    hp_pack_record()
+    share		Heap table
+    record		Record to store
+    chunk	OUT	The first chunk
+    check_limit		Fail if the table has reached max_table_size.
+			Not done on update, as then the table can't be
+			converted to another engine.
+
+  RETURN
+    0      Ok
+    other  Error code
+*/
+
+int hp_pack_record(HP_SHARE *share, const uchar *record, uchar **chunk,
+                   my_bool check_limit)
+{
+  HP_COLUMNDEF *column, *end= share->columndef + share->columns;
+  HP_CHUNK_POS pos;
+  uchar **link= chunk;
+  uint length= share->reclength - share->fixed_length;
+  uint offset= share->fixed_length;
+  ulong chunks;
+  DBUG_ENTER("hp_pack_record");
+
+  for (column= share->columndef; column < end; column++)
+    length-= column->length - var_length(column, record);
+
+  for (chunks= (length + HP_CHUNK_DATA_LENGTH - 1) / HP_CHUNK_DATA_LENGTH;
+       chunks; chunks--)
+  {
+    if (!(*link= next_free_chunk(share, check_limit)))
+    {
+      hp_free_chunks(share, *chunk);
+      DBUG_RETURN(my_errno);
+    }
+    link= (uchar**) *link;
+  }
+  *link= 0;
+
+  pos.chunk= *chunk;
+  pos.used= 0;
+  for (column= share->columndef; column < end; column++)
+  {
+    uint data_end= column->offset + column->length_bytes +
+                   var_length(column, record);
+    copy_to_chunks(&pos, record + offset, data_end - offset);
+    offset= column->offset + column->length_bytes + column->length;
+  }
+  copy_to_chunks(&pos, record + offset, share->reclength - offset);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Read a stored record of a packed table
+
+  NOTES
+    The unused part of the VARCHARs is filled with zeros.
+*/
+
+void hp_unpack_record(HP_SHARE *share, uchar *record, const uchar *pos)
+{
+  HP_COLUMNDEF *column, *end= share->columndef + share->columns;
+  HP_CHUNK_POS chunk_pos;
+  uint offset= share->fixed_length;
+
+  memcpy(record, pos, (size_t) share->fixed_length);
+  memcpy(&chunk_pos.chunk, pos + share->fixed_length, sizeof(uchar*));
+  chunk_pos.used= 0;
+  for (column= share->columndef; column < end; column++)
+  {
+    uint data_offset= column->offset + column->length_bytes;
+    uint length;
+    copy_from_chunks(&chunk_pos, record + offset, data_offset - offset);
+    length= var_length(column, record);
+    copy_from_chunks(&chunk_pos, record + data_offset, length);
+    bzero(record + data_offset + length, column->length - length);
+    offset= data_offset + column->length;
+  }
+  copy_from_chunks(&chunk_pos, record + offset, share->reclength - offset);
+}
+
+
+	/* Put a chain of chunks into the free list */
+
+void hp_free_chunks(HP_SHARE *share, uchar *chunk)
+{
+  uchar *last;
+  if (!chunk)
+    return;
+  for (last= chunk; *((uchar**) last); last= *((uchar**) last))
+  {}
+  *((uchar**) last)= share->chunk_del_link;
+  share->chunk_del_link= chunk;
+}
+
+
+/*
+  Get a stored record in the format of the record buffer
+
+  NOTES
+    For packed tables the record is unpacked to info->unpack_buf, which
+    is valid until the next call.
+*/
+
+const uchar *hp_stored_record(HP_INFO *info, const uchar *pos)
+{
+  if (!info->s->columns)
+    return pos;
+  hp_unpack_record(info->s, info->unpack_buf, pos);
+  return info->unpack_buf;
+}
@@ -68,7 +68,7 @@ int heap_rkey(HP_INFO *info, uchar *record, int inx, const uchar *key,
     if ((keyinfo->flag & (HA_NOSAME | HA_NULL_PART_KEY)) != HA_NOSAME)
       memcpy(info->lastkey, key, (size_t) keyinfo->length);
   }
-  memcpy(record, pos, (size_t) share->reclength);
+  hp_extract_record(share, record, pos);
   info->update= HA_STATE_AKTIV;
   DBUG_RETURN(0);
 }
@@ -21,7 +21,7 @@
 int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 {
   HP_KEYDEF *keydef, *end, *p_lastinx;
-  uchar *pos;
+  uchar *pos, *chunk= 0, *old_chunk;
   my_bool auto_key_changed= 0, key_changed= 0;
   HP_SHARE *share= info->s;
   DBUG_ENTER("heap_update");
@@ -31,6 +31,8 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  if (share->columns && hp_pack_record(share, heap_new, &chunk, 0))
+    DBUG_RETURN(my_errno);
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -47,7 +49,13 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  if (share->columns)
+  {
+    memcpy(&old_chunk, pos + share->fixed_length, sizeof(old_chunk));
+    hp_free_chunks(share, old_chunk);
+    memcpy(pos + share->fixed_length, &chunk, sizeof(chunk));
+  }
+  memcpy(pos,heap_new,(size_t) share->fixed_length);
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -67,11 +75,7 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     {
       /* we don't need to delete non-inserted key from rb-tree */
       if ((*keydef->write_key)(info, keydef, old, pos))
-      {
-        if (++(share->records) == share->blength)
-	  share->blength+= share->blength;
-        DBUG_RETURN(my_errno);
-      }
+        goto end;
       keydef--;
     }
     while (keydef >= share->keydef)
@@ -85,7 +89,9 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
       keydef--;
     }
   }
+ end:
   if (++(share->records) == share->blength)
     share->blength+= share->blength;
+  hp_free_chunks(share, chunk);
   DBUG_RETURN(my_errno);
 } /* heap_update */
@@ -33,7 +33,7 @@ static HASH_INFO *hp_find_free_hash(HP_SHARE *info, HP_BLOCK *block,
 int heap_write(HP_INFO *info, const uchar *record)
 {
   HP_KEYDEF *keydef, *end;
-  uchar *pos;
+  uchar *pos, *chunk= 0;
   HP_SHARE *share=info->s;
   DBUG_ENTER("heap_write");
 #ifndef DBUG_OFF
@@ -44,6 +44,8 @@ int heap_write(HP_INFO *info, const uchar *record)
 #endif
   if (!(pos=next_free_record_pos(share)))
     DBUG_RETURN(my_errno);
+  if (share->columns && hp_pack_record(share, record, &chunk, 1))
+    goto err_free_pos;
   share->changed=1;
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
@@ -53,8 +55,10 @@ int heap_write(HP_INFO *info, const uchar *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
-  pos[share->reclength]=1;		/* Mark record as not deleted */
+  memcpy(pos,record,(size_t) share->fixed_length);
+  if (share->columns)
+    memcpy(pos + share->fixed_length, &chunk, sizeof(chunk));
+  pos[share->visible]=1;		/* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
   info->s->key_version++;
@@ -88,11 +92,13 @@ int heap_write(HP_INFO *info, const uchar *record)
       break;
     keydef--;
   } 
+  hp_free_chunks(share, chunk);
 
+err_free_pos:
   share->deleted++;
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
-  pos[share->reclength]=0;			/* Record deleted */
+  pos[share->visible]=0;			/* Record deleted */
 
   DBUG_RETURN(my_errno);
 } /* heap_write */
@@ -386,7 +392,8 @@ int hp_write_key(HP_INFO *info, HP_KEYDEF *keyinfo,
       do
       {
 	if (pos->hash_of_key == hash_of_key &&
-            ! hp_rec_key_cmp(keyinfo, record, pos->ptr_to_rec, 1))
+            ! hp_rec_key_cmp(keyinfo, record,
+                             hp_stored_record(info, pos->ptr_to_rec), 1))
 	{
 	  DBUG_RETURN(my_errno=HA_ERR_FOUND_DUPP_KEY);
 	}
@@ -19440,6 +19440,465 @@ static void test_big_packet()
 }
 
 
+/*
+  Two commands that the server reads from the socket at once must both
+  be answered. With the thread pool, there is only one poll event for
+  them.
+*/
+
+#ifndef EMBEDDED_LIBRARY
+static void test_two_commands_in_one_write()
+{
+  MYSQL *mysql_local;
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  uchar packet[32];
+  const char *queries[]= { "SET @a= 1", "SET @b= 2" };
+  uint timeout= 60;
+  int i, rc;
+
+  myheader("test_two_commands_in_one_write");
+
+  if (!(mysql_local= mysql_client_init(NULL)))
+  {
+    fprintf(stderr, "\n mysql_client_init() failed");
+    exit(1);
+  }
+  /* Fail instead of waiting forever, if the second command is lost */
+  mysql_options(mysql_local, MYSQL_OPT_READ_TIMEOUT, &timeout);
+  if (!(mysql_real_connect(mysql_local, opt_host, opt_user,
+                           opt_password, current_db, opt_port,
+                           opt_unix_socket, 0)))
+  {
+    fprintf(stderr, "\n connection failed(%s)", mysql_error(mysql_local));
+    exit(1);
+  }
+
+  /* Put both commands into the net buffer, and send them with one write */
+  for (i= 0; i < 2; i++)
+  {
+    size_t length= strlen(queries[i]);
+    packet[0]= COM_QUERY;
+    memcpy(packet + 1, queries[i], length);
+    mysql_local->net.pkt_nr= 0;
+    DIE_IF(my_net_write(&mysql_local->net, packet, length + 1));
+  }
+  DIE_IF(net_flush(&mysql_local->net));
+
+  for (i= 0; i < 2; i++)
+  {
+    mysql_local->net.pkt_nr= 1;
+    rc= mysql_read_query_result(mysql_local);
+    if (rc)
+      fprintf(stderr, "\n %s", mysql_error(mysql_local));
+    DIE_UNLESS(rc == 0);
+  }
+
+  rc= mysql_query(mysql_local, "SELECT @a + @b");
+  DIE_UNLESS(rc == 0);
+  res= mysql_store_result(mysql_local);
+  DIE_UNLESS(res);
+  row= mysql_fetch_row(res);
+  DIE_UNLESS(row && strcmp(row[0], "3") == 0);
+  mysql_free_result(res);
+
+  mysql_close(mysql_local);
+}
+#endif
+
+
+/*
+  Check mysql_stmt_send_execute() and mysql_stmt_read_execute_result()
+*/
+
+#ifndef EMBEDDED_LIBRARY
+static void test_pipelined_execute()
+{
+  MYSQL_STMT *stmt[4], *unprepared;
+  MYSQL_BIND param, result;
+  char query[]= "SELECT b FROM t1 WHERE a = ?";
+  char insert[]= "INSERT INTO t1 VALUES (?, 'new')";
+  char buff[20];
+  ulong length;
+  int ids[3]= { 2, 100, 3 };
+  int id, i, rc;
+
+  myheader("test_pipelined_execute");
+
+  rc= mysql_query(mysql, "DROP TABLE IF EXISTS t1");
+  myquery(rc);
+  rc= mysql_query(mysql, "CREATE TABLE t1 (a INT PRIMARY KEY, b CHAR(10))");
+  myquery(rc);
+  rc= mysql_query(mysql, "INSERT INTO t1 VALUES (1,'one'), (2,'two'), "
+                  "(3,'three')");
+  myquery(rc);
+
+  memset(&param, 0, sizeof(param));
+  param.buffer_type= MYSQL_TYPE_LONG;
+  param.buffer= (void *) &id;
+  memset(&result, 0, sizeof(result));
+  result.buffer_type= MYSQL_TYPE_STRING;
+  result.buffer= buff;
+  result.buffer_length= sizeof(buff);
+  result.length= &length;
+
+  for (i= 0; i < 4; i++)
+  {
+    stmt[i]= mysql_simple_prepare(mysql, i < 3 ? query : insert);
+    check_stmt(stmt[i]);
+    rc= mysql_stmt_bind_param(stmt[i], &param);
+    check_execute(stmt[i], rc);
+  }
+
+  /* Three lookups and a failing insert in one round trip */
+  for (i= 0; i < 4; i++)
+  {
+    id= i < 3 ? ids[i] : 1;
+    rc= mysql_stmt_send_execute(stmt[i]);
+    check_execute(stmt[i], rc);
+  }
+  rc= mysql_stmt_send_execute(stmt[0]);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt[0]) == CR_COMMANDS_OUT_OF_SYNC);
+  rc= mysql_query(mysql, "SELECT 1");
+  DIE_UNLESS(rc && mysql_errno(mysql) == CR_COMMANDS_OUT_OF_SYNC);
+  rc= mysql_stmt_read_execute_result(stmt[1]);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt[1]) == CR_COMMANDS_OUT_OF_SYNC);
+
+  for (i= 0; i < 3; i++)
+  {
+    rc= mysql_stmt_read_execute_result(stmt[i]);
+    check_execute(stmt[i], rc);
+    rc= mysql_stmt_bind_result(stmt[i], &result);
+    check_execute(stmt[i], rc);
+    rc= mysql_stmt_fetch(stmt[i]);
+    if (ids[i] == 100)
+      DIE_UNLESS(rc == MYSQL_NO_DATA);
+    else
+    {
+      check_execute(stmt[i], rc);
+      DIE_UNLESS(strcmp(buff, ids[i] == 2 ? "two" : "three") == 0);
+      rc= mysql_stmt_fetch(stmt[i]);
+      DIE_UNLESS(rc == MYSQL_NO_DATA);
+    }
+  }
+  rc= mysql_stmt_read_execute_result(stmt[3]);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt[3]) == ER_DUP_ENTRY);
+
+  /* The connection is usable again */
+  id= 4;
+  rc= mysql_stmt_execute(stmt[3]);
+  check_execute(stmt[3], rc);
+  DIE_UNLESS(mysql_stmt_affected_rows(stmt[3]) == 1);
+
+  /* Closing or resetting a statement discards its unread result */
+  for (i= 0; i < 2; i++)
+  {
+    id= ids[i];
+    rc= mysql_stmt_send_execute(stmt[i]);
+    check_execute(stmt[i], rc);
+  }
+  /* Not before the results sent earlier are read */
+  rc= mysql_stmt_close(stmt[1]);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt[1]) == CR_COMMANDS_OUT_OF_SYNC);
+  rc= mysql_stmt_read_execute_result(stmt[0]);
+  check_execute(stmt[0], rc);
+  rc= mysql_stmt_store_result(stmt[0]);
+  check_execute(stmt[0], rc);
+  rc= mysql_stmt_close(stmt[1]);
+  DIE_UNLESS(rc == 0);
+  rc= mysql_stmt_send_execute(stmt[0]);
+  check_execute(stmt[0], rc);
+  rc= mysql_stmt_reset(stmt[0]);
+  check_execute(stmt[0], rc);
+  rc= mysql_query(mysql, "SELECT 1");
+  myquery(rc);
+  mysql_free_result(mysql_store_result(mysql));
+  stmt[1]= mysql_simple_prepare(mysql, query);
+  check_stmt(stmt[1]);
+
+  /* A statement that was not prepared can't be sent */
+  unprepared= mysql_stmt_init(mysql);
+  check_stmt(unprepared);
+  rc= mysql_stmt_send_execute(unprepared);
+  DIE_UNLESS(rc && mysql_stmt_errno(unprepared) == CR_COMMANDS_OUT_OF_SYNC);
+  mysql_stmt_close(unprepared);
+
+  for (i= 0; i < 4; i++)
+    mysql_stmt_close(stmt[i]);
+  rc= mysql_query(mysql, "DROP TABLE t1");
+  myquery(rc);
+}
+
+
+/* Check the result of a query returning one row with one column */
+
+static void check_bulk_result(const char *query, const char *expected)
+{
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  int rc;
+
+  rc= mysql_query(mysql, query);
+  myquery(rc);
+  res= mysql_store_result(mysql);
+  mytest(res);
+  row= mysql_fetch_row(res);
+  DIE_UNLESS(row && row[0] && strcmp(row[0], expected) == 0);
+  mysql_free_result(res);
+}
+
+
+/*
+  Array binding: several parameter sets sent and executed with
+  one COM_STMT_EXECUTE.
+*/
+
+static void test_bulk_execute()
+{
+  MYSQL_STMT *stmt;
+  MYSQL_BIND my_bind[3];
+  int ids[4]= { 1, 2, 3, 4 };
+  char *names[4]= { (char*) "one", (char*) "two", NULL, (char*) "four" };
+  ulong lengths[4]= { 3, 3, 0, 4 };
+  my_bool nulls[4]= { 0, 0, 1, 0 };
+  MYSQL_TIME times[4];
+  uint array_size, i;
+  int rc;
+
+  myheader("test_bulk_execute");
+
+  rc= mysql_query(mysql, "DROP TABLE IF EXISTS t1");
+  myquery(rc);
+  rc= mysql_query(mysql, "CREATE TABLE t1 (a INT PRIMARY KEY, b VARCHAR(10), "
+                  "c DATETIME)");
+  myquery(rc);
+
+  memset(times, 0, sizeof(times));
+  for (i= 0; i < 4; i++)
+  {
+    times[i].year= 2016;
+    times[i].month= 1;
+    times[i].day= i + 1;
+    times[i].time_type= MYSQL_TIMESTAMP_DATETIME;
+  }
+
+  memset(my_bind, 0, sizeof(my_bind));
+  my_bind[0].buffer_type= MYSQL_TYPE_LONG;
+  my_bind[0].buffer= (void *) ids;
+  my_bind[1].buffer_type= MYSQL_TYPE_STRING;
+  my_bind[1].buffer= (void *) names;
+  my_bind[1].length= lengths;
+  my_bind[1].is_null= nulls;
+  my_bind[2].buffer_type= MYSQL_TYPE_DATETIME;
+  my_bind[2].buffer= (void *) times;
+
+  stmt= mysql_simple_prepare(mysql, "INSERT INTO t1 VALUES (?, ?, ?)");
+  check_stmt(stmt);
+  rc= mysql_stmt_attr_get(stmt, STMT_ATTR_ARRAY_SIZE, &array_size);
+  DIE_UNLESS(rc == 0 && array_size == 1);
+  array_size= 4;
+  rc= mysql_stmt_attr_set(stmt, STMT_ATTR_ARRAY_SIZE, &array_size);
+  DIE_UNLESS(rc == 0);
+  rc= mysql_stmt_bind_param(stmt, my_bind);
+  check_execute(stmt, rc);
+  rc= mysql_stmt_execute(stmt);
+  check_execute(stmt, rc);
+  DIE_UNLESS(mysql_stmt_affected_rows(stmt) == 4);
+
+  check_bulk_result("SELECT GROUP_CONCAT(a, ':', IFNULL(b, 'NULL'), ':', "
+                    "DAY(c) ORDER BY a) FROM t1",
+                    "1:one:1,2:two:2,3:NULL:3,4:four:4");
+
+  /* Types are sent with the first execution only */
+  for (i= 0; i < 4; i++)
+    ids[i]+= 4;
+  rc= mysql_stmt_execute(stmt);
+  check_execute(stmt, rc);
+  DIE_UNLESS(mysql_stmt_affected_rows(stmt) == 4);
+  check_bulk_result("SELECT SUM(a) FROM t1", "36");
+
+  /* Execution stops at the first error, earlier sets are kept */
+  ids[0]= 9;
+  ids[1]= 10;
+  ids[2]= 1;
+  ids[3]= 11;
+  rc= mysql_stmt_execute(stmt);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt) == ER_DUP_ENTRY);
+  check_bulk_result("SELECT COUNT(*) FROM t1", "10");
+  mysql_stmt_close(stmt);
+
+  /* Lengths and NULL flags are optional */
+  stmt= mysql_simple_prepare(mysql, "UPDATE t1 SET b= ? WHERE a > ?");
+  check_stmt(stmt);
+  array_size= 2;
+  rc= mysql_stmt_attr_set(stmt, STMT_ATTR_ARRAY_SIZE, &array_size);
+  DIE_UNLESS(rc == 0);
+  ids[0]= 8;
+  ids[1]= 9;
+  names[0]= (char*) "abc";
+  names[1]= (char*) "xyz";
+  memset(my_bind, 0, sizeof(my_bind));
+  my_bind[0].buffer_type= MYSQL_TYPE_STRING;
+  my_bind[0].buffer= (void *) names;
+  my_bind[0].buffer_length= 3;
+  my_bind[1].buffer_type= MYSQL_TYPE_LONG;
+  my_bind[1].buffer= (void *) ids;
+  rc= mysql_stmt_bind_param(stmt, my_bind);
+  check_execute(stmt, rc);
+  rc= mysql_stmt_execute(stmt);
+  check_execute(stmt, rc);
+  DIE_UNLESS(mysql_stmt_affected_rows(stmt) == 3);
+  check_bulk_result("SELECT GROUP_CONCAT(b ORDER BY a) FROM t1 WHERE a > 8",
+                    "abc,xyz");
+  mysql_stmt_close(stmt);
+
+  /* Statements returning a result set can't be executed in bulk */
+  stmt= mysql_simple_prepare(mysql, "SELECT b FROM t1 WHERE a = ?");
+  check_stmt(stmt);
+  rc= mysql_stmt_attr_set(stmt, STMT_ATTR_ARRAY_SIZE, &array_size);
+  DIE_UNLESS(rc == 0);
+  rc= mysql_stmt_bind_param(stmt, my_bind + 1);
+  check_execute(stmt, rc);
+  rc= mysql_stmt_execute(stmt);
+  DIE_UNLESS(rc && mysql_stmt_errno(stmt) == ER_UNSUPPORTED_PS);
+  mysql_stmt_close(stmt);
+
+  rc= mysql_query(mysql, "DROP TABLE t1");
+  myquery(rc);
+}
+
+
+/*
+  prepared_stmt_cache_size: a closed statement answers a later prepare
+  of the same text.
+*/
+
+static void prepare_and_close(const char *query, uint field_count,
+                              const char *last_field, int row_count)
+{
+  MYSQL_STMT *stmt;
+  MYSQL_RES *metadata;
+  int rc;
+
+  stmt= mysql_simple_prepare(mysql, query);
+  check_stmt(stmt);
+  DIE_UNLESS(mysql_stmt_field_count(stmt) == field_count);
+  metadata= mysql_stmt_result_metadata(stmt);
+  mytest(metadata);
+  DIE_UNLESS(strcmp(mysql_fetch_field_direct(metadata, field_count - 1)->name,
+                    last_field) == 0);
+  mysql_free_result(metadata);
+  rc= mysql_stmt_execute(stmt);
+  check_execute(stmt, rc);
+  rc= my_process_stmt_result(stmt);
+  DIE_UNLESS(rc == row_count);
+  mysql_stmt_close(stmt);
+}
+
+
+static void test_ps_cache()
+{
+  MYSQL_STMT *stmt;
+  MYSQL_BIND my_bind[1];
+  const char *query= "SELECT * FROM t1 WHERE a > 1";
+  const char *status= "SELECT VARIABLE_VALUE FROM "
+                      "INFORMATION_SCHEMA.SESSION_STATUS WHERE "
+                      "VARIABLE_NAME = 'PREPARED_STMT_CACHE_HITS'";
+  const char *count= "SELECT VARIABLE_VALUE FROM "
+                     "INFORMATION_SCHEMA.GLOBAL_STATUS WHERE "
+                     "VARIABLE_NAME = 'PREPARED_STMT_COUNT'";
+  ulong stmt_id;
+  int a, rc;
+
+  myheader("test_ps_cache");
+
+  rc= mysql_query(mysql, "DROP TABLE IF EXISTS t1");
+  myquery(rc);
+  rc= mysql_query(mysql, "CREATE TABLE t1 (a INT, b VARCHAR(10))");
+  myquery(rc);
+  rc= mysql_query(mysql, "INSERT INTO t1 VALUES (1, 'a'), (2, 'b'), (3, 'c')");
+  myquery(rc);
+  rc= mysql_query(mysql, "SET prepared_stmt_cache_size= 2");
+  myquery(rc);
+  rc= mysql_query(mysql, "FLUSH STATUS");
+  myquery(rc);
+
+  prepare_and_close(query, 2, "b", 2);
+  prepare_and_close(query, 2, "b", 2);
+  prepare_and_close(query, 2, "b", 2);
+  check_bulk_result(status, "2");
+
+  /* Parameters, and a new id for the reused statement */
+  memset(my_bind, 0, sizeof(my_bind));
+  my_bind[0].buffer_type= MYSQL_TYPE_LONG;
+  my_bind[0].buffer= (void *) &a;
+  stmt= mysql_simple_prepare(mysql, "UPDATE t1 SET b= 'x' WHERE a = ?");
+  check_stmt(stmt);
+  stmt_id= stmt->stmt_id;
+  mysql_stmt_close(stmt);
+  stmt= mysql_simple_prepare(mysql, "UPDATE t1 SET b= 'x' WHERE a = ?");
+  check_stmt(stmt);
+  DIE_UNLESS(stmt->stmt_id != stmt_id);
+  DIE_UNLESS(mysql_stmt_param_count(stmt) == 1);
+  rc= mysql_stmt_bind_param(stmt, my_bind);
+  check_execute(stmt, rc);
+  a= 3;
+  rc= mysql_stmt_execute(stmt);
+  check_execute(stmt, rc);
+  DIE_UNLESS(mysql_stmt_affected_rows(stmt) == 1);
+  mysql_stmt_close(stmt);
+  check_bulk_result(status, "3");
+  check_bulk_result("SELECT GROUP_CONCAT(b ORDER BY a) FROM t1", "a,b,x");
+
+  /* Statements closed before a table changes are not reused */
+  rc= mysql_query(mysql, "ALTER TABLE t1 ADD COLUMN c INT DEFAULT 5");
+  myquery(rc);
+  prepare_and_close(query, 3, "c", 2);
+  prepare_and_close(query, 3, "c", 2);
+  check_bulk_result(status, "4");
+
+  /* Nor under other session settings */
+  rc= mysql_query(mysql, "SET sql_mode= 'ANSI_QUOTES'");
+  myquery(rc);
+  prepare_and_close(query, 3, "c", 2);
+  rc= mysql_query(mysql, "SET sql_mode= DEFAULT");
+  myquery(rc);
+  prepare_and_close(query, 3, "c", 2);
+  check_bulk_result(status, "4");
+
+  /* The oldest statement goes when the cache is full */
+  prepare_and_close("SELECT a FROM t1", 1, "a", 3);
+  prepare_and_close("SELECT b FROM t1", 1, "b", 3);
+  prepare_and_close(query, 3, "c", 2);
+  check_bulk_result(status, "4");
+
+  rc= mysql_query(mysql, "SET prepared_stmt_cache_size= 0");
+  myquery(rc);
+  prepare_and_close("SELECT b FROM t1", 1, "b", 3);
+  check_bulk_result(status, "4");
+
+  /* Kept statements count against max_prepared_stmt_count */
+  rc= mysql_query(mysql, "SET prepared_stmt_cache_size= 2");
+  myquery(rc);
+  prepare_and_close("SELECT a FROM t1", 1, "a", 3);
+  check_bulk_result(count, "1");
+  rc= mysql_query(mysql, "SET GLOBAL max_prepared_stmt_count= 1");
+  myquery(rc);
+  /* The kept statement is dropped to make room */
+  prepare_and_close("SELECT b FROM t1", 1, "b", 3);
+  check_bulk_result(count, "1");
+  check_bulk_result(status, "4");
+  rc= mysql_query(mysql, "SET GLOBAL max_prepared_stmt_count= DEFAULT");
+  myquery(rc);
+
+  rc= mysql_query(mysql, "SET prepared_stmt_cache_size= DEFAULT");
+  myquery(rc);
+  rc= mysql_query(mysql, "DROP TABLE t1");
+  myquery(rc);
+}
+#endif
+
+
 static struct my_tests_st my_tests[]= {
   { "disable_query_logs", disable_query_logs },
   { "test_view_sp_list_fields", test_view_sp_list_fields },
@@ -19713,6 +20172,12 @@ static struct my_tests_st my_tests[]= {
   { "test_ps_sp_out_params", test_ps_sp_out_params },
   { "test_compressed_protocol", test_compressed_protocol },
   { "test_big_packet", test_big_packet },
+#ifndef EMBEDDED_LIBRARY
+  { "test_two_commands_in_one_write", test_two_commands_in_one_write },
+  { "test_pipelined_execute", test_pipelined_execute },
+  { "test_bulk_execute", test_bulk_execute },
+  { "test_ps_cache", test_ps_cache },
+#endif
   { 0, 0 }
 };
 
@@ -0,0 +1,83 @@
+/* Copyright (c) 2016, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <tap.h>
+#include <string.h>
+
+static const size_t sizes[]= { 1, 3, 8, 12, 40 };
+static const uint counts[]= { 1000, 5000, 70000 };
+/*
+  Few different bytes give many equal prefixes, two are too few to be
+  worth distributing
+*/
+static const uint alphabets[]= { 2, 4, 256 };
+
+static void test_msd_sort(size_t size, uint count, uint alphabet)
+{
+  uchar *data= (uchar*) malloc(size * count);
+  uchar **ptrs= (uchar**) malloc(sizeof(uchar*) * count);
+  char *seen= (char*) calloc(count, 1);
+  uint i, unsorted= 0, lost= 0;
+  size_t j;
+  my_bool declined;
+
+  for (i= 0; i < count; i++)
+  {
+    ptrs[i]= data + i * size;
+    for (j= 0; j < size; j++)
+      ptrs[i][j]= (uchar) (rand() % alphabet);
+  }
+  declined= radixsort_msd_for_str_ptr(ptrs, count, size, MYF(0));
+  ok(declined == (alphabet == 2),
+     "radixsort_msd_for_str_ptr size: %u  count: %u  alphabet: %u",
+     (uint) size, count, alphabet);
+  if (declined)
+    my_qsort2(ptrs, count, sizeof(uchar*), get_ptr_compare(size), &size);
+
+  for (i= 0; i < count; i++)
+  {
+    uint idx= (uint) ((ptrs[i] - data) / size);
+    if (seen[idx]++)
+      lost++;
+    if (i && memcmp(ptrs[i - 1], ptrs[i], size) > 0)
+      unsorted++;
+  }
+  ok(unsorted == 0, "keys are sorted");
+  ok(lost == 0, "all keys are kept");
+
+  free(seen);
+  free(ptrs);
+  free(data);
+}
+
+
+int main(int argc __attribute__((unused)), char *argv[])
+{
+  uint i, j, k;
+  MY_INIT(argv[0]);
+
+  plan(array_elements(sizes) * array_elements(counts) *
+       array_elements(alphabets) * 3);
+
+  for (i= 0; i < array_elements(sizes); i++)
+    for (j= 0; j < array_elements(counts); j++)
+      for (k= 0; k < array_elements(alphabets); k++)
+        test_msd_sort(sizes[i], counts[j], alphabets[k]);
+
+  my_end(0);
+  return exit_status();
+}